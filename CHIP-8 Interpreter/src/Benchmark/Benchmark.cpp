@@ -0,0 +1,428 @@
+#include "Benchmark/Benchmark.h"
+#include "Headless/Headless.h"
+#include "Interpreter/CHIP-8_Batch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+
+//Layout of the generated programs: the stream of instructions fills the first 256 words of the program area and ends in a jump back to its start, long enough
+//for the idle loop detection to leave it alone. A subroutine that only returns sits after it, and the data the instructions read and write after that.
+static const uint16_t STREAM_ADDRESS = 0x200;
+static const unsigned int STREAM_WORDS = 256;
+static const uint16_t SUBROUTINE_ADDRESS = 0x400;
+static const uint16_t DATA_ADDRESS = 0x500;
+static const unsigned int DATA_SIZE = 0x40;
+
+static const struct
+{
+	CHIP_8_ENGINE Engine;
+	const char* Name;
+} Engines[] = { { CHIP_8_ENGINE__SWITCH, "switch" }, { CHIP_8_ENGINE__THREADED, "threaded" }, { CHIP_8_ENGINE__JIT, "jit" } };
+
+//One instruction, or a pair of words that only make sense together, repeated over the stream. Setup runs once per pass, after I is pointed at the data.
+//0nnn, Fx0A and 00FD are left out because they stop the machine; 00E0 and Dxyn have their own groups.
+struct DISPATCH_CASE
+{
+	CHIP_8_OPERATION Operation;
+	CHIP_8_QUIRKS Quirks;
+	uint16_t Setup;
+	uint16_t Body[2];
+};
+
+static const uint16_t NO_SETUP = 0x0000;
+
+//A 1nnn or Bnnn with address zero in a body is a jump to the instruction after it, so that jumps can be chained.
+static const DISPATCH_CASE DispatchCases[] =
+{
+	{ CHIP_8_OPERATION__00Cn__SCD_nibble, CHIP_8_QUIRKS__SUPER_CHIP, NO_SETUP, { 0x00C1 } },
+	{ CHIP_8_OPERATION__00Dn__SCU_nibble, CHIP_8_QUIRKS__XO_CHIP, NO_SETUP, { 0x00D1 } },
+	{ CHIP_8_OPERATION__00EE__RET, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { static_cast<uint16_t>(0x2000 | SUBROUTINE_ADDRESS) } },
+	{ CHIP_8_OPERATION__00FB__SCR, CHIP_8_QUIRKS__SUPER_CHIP, NO_SETUP, { 0x00FB } },
+	{ CHIP_8_OPERATION__00FC__SCL, CHIP_8_QUIRKS__SUPER_CHIP, NO_SETUP, { 0x00FC } },
+	{ CHIP_8_OPERATION__00FE__LOW, CHIP_8_QUIRKS__SUPER_CHIP, NO_SETUP, { 0x00FE } },
+	{ CHIP_8_OPERATION__00FF__HIGH, CHIP_8_QUIRKS__SUPER_CHIP, NO_SETUP, { 0x00FF } },
+	{ CHIP_8_OPERATION__1nnn__JP_addr, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0x1000 } },
+	{ CHIP_8_OPERATION__3xnn__SE_Vx_byte, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0x3001 } },
+	{ CHIP_8_OPERATION__4xnn__SNE_Vx_byte, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0x4000 } },
+	{ CHIP_8_OPERATION__5xy0__SE_Vx_Vy, CHIP_8_QUIRKS__DEFAULT, 0x6101, { 0x5010 } },
+	{ CHIP_8_OPERATION__5xy2__LD_I_Vx_Vy, CHIP_8_QUIRKS__XO_CHIP, NO_SETUP, { 0x5032 } },
+	{ CHIP_8_OPERATION__5xy3__LD_Vx_Vy_I, CHIP_8_QUIRKS__XO_CHIP, NO_SETUP, { 0x5033 } },
+	{ CHIP_8_OPERATION__6xnn__LD_Vx_byte, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0x6012 } },
+	{ CHIP_8_OPERATION__7xnn__ADD_Vx_byte, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0x7001 } },
+	{ CHIP_8_OPERATION__8xy0__LD_Vx_Vy, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0x8010 } },
+	{ CHIP_8_OPERATION__8xy1__OR_Vx_Vy, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0x8011 } },
+	{ CHIP_8_OPERATION__8xy2__AND_Vx_Vy, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0x8012 } },
+	{ CHIP_8_OPERATION__8xy3__XOR_Vx_Vy, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0x8013 } },
+	{ CHIP_8_OPERATION__8xy4__ADD_Vx_Vy, CHIP_8_QUIRKS__DEFAULT, 0x6181, { 0x8014 } },
+	{ CHIP_8_OPERATION__8xy5__SUB_Vx_Vy, CHIP_8_QUIRKS__DEFAULT, 0x6103, { 0x8015 } },
+	{ CHIP_8_OPERATION__8xy6__SHR_Vx_Vy, CHIP_8_QUIRKS__DEFAULT, 0x61FF, { 0x8016 } },
+	{ CHIP_8_OPERATION__8xy7__SUBN_Vx_Vy, CHIP_8_QUIRKS__DEFAULT, 0x6103, { 0x8017 } },
+	{ CHIP_8_OPERATION__8xyE__SHL_Vx_Vy, CHIP_8_QUIRKS__DEFAULT, 0x61FF, { 0x801E } },
+	{ CHIP_8_OPERATION__9xy0__SNE_Vx_Vy, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0x9010 } },
+	{ CHIP_8_OPERATION__Annn__LD_I_addr, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { static_cast<uint16_t>(0xA000 | DATA_ADDRESS) } },
+	{ CHIP_8_OPERATION__Bnnn__JP_V0_addr, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0xB000 } },
+	{ CHIP_8_OPERATION__Cxnn__RND_Vx_byte, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0xC0FF } },
+	{ CHIP_8_OPERATION__Ex9E__SKP_Vx, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0xE09E } },
+	{ CHIP_8_OPERATION__ExA1__SKNP_Vx, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0xE0A1 } },
+	{ CHIP_8_OPERATION__F000__LD_I_long, CHIP_8_QUIRKS__XO_CHIP, NO_SETUP, { 0xF000, DATA_ADDRESS } },
+	{ CHIP_8_OPERATION__Fn01__PLANE_n, CHIP_8_QUIRKS__XO_CHIP, NO_SETUP, { 0xF301 } },
+	{ CHIP_8_OPERATION__F002__AUDIO, CHIP_8_QUIRKS__XO_CHIP, NO_SETUP, { 0xF002 } },
+	{ CHIP_8_OPERATION__Fx07__LD_Vx_DT, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0xF007 } },
+	{ CHIP_8_OPERATION__Fx15__LD_DT_Vx, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0xF015 } },
+	{ CHIP_8_OPERATION__Fx18__LD_ST_Vx, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0xF018 } },
+	{ CHIP_8_OPERATION__Fx1E__ADD_I_Vx, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0xF01E } },
+	{ CHIP_8_OPERATION__Fx29__LD_F_Vx, CHIP_8_QUIRKS__DEFAULT, NO_SETUP, { 0xF029 } },
+	{ CHIP_8_OPERATION__Fx30__LD_HF_Vx, CHIP_8_QUIRKS__SUPER_CHIP, NO_SETUP, { 0xF030 } },
+	{ CHIP_8_OPERATION__Fx33__LD_B_Vx, CHIP_8_QUIRKS__DEFAULT, 0x60FF, { 0xF033 } },
+	{ CHIP_8_OPERATION__Fx3A__PITCH_Vx, CHIP_8_QUIRKS__XO_CHIP, NO_SETUP, { 0xF03A } },
+	{ CHIP_8_OPERATION__Fx55__LD_I_Vx, CHIP_8_QUIRKS__SUPER_CHIP, NO_SETUP, { 0xF355 } },
+	{ CHIP_8_OPERATION__Fx65__LD_Vx_I, CHIP_8_QUIRKS__SUPER_CHIP, NO_SETUP, { 0xF365 } },
+	{ CHIP_8_OPERATION__Fx75__LD_R_Vx, CHIP_8_QUIRKS__SUPER_CHIP, NO_SETUP, { 0xF375 } },
+	{ CHIP_8_OPERATION__Fx85__LD_Vx_R, CHIP_8_QUIRKS__SUPER_CHIP, NO_SETUP, { 0xF385 } }
+};
+
+//Where a sprite is drawn: fully on screen, across the right edge, across the bottom edge and across the corner, in 64x32 coordinates; high resolution doubles them.
+static const struct
+{
+	const char* Name;
+	uint8_t X;
+	uint8_t Y;
+} DrawPositions[] = { { "inside", 8, 8 }, { "right edge", 60, 8 }, { "bottom edge", 8, 28 }, { "corner", 60, 28 } };
+
+static const unsigned int SpriteHeights[] = { 1, 4, 8, 15 };
+
+//Small programs written for the benchmark, standing in for real ones in the program and batch groups: a sprite moving over the screen, a block of memory copied
+//eight registers at a time, a counter shown in decimal with the font, and arithmetic on registers only, which the batch runs with its vector kernels throughout.
+//None of them idles, which the interpreter would fast-forward.
+static const struct
+{
+	const char* Name;
+	uint16_t Words[20];
+	unsigned int NumberOfWords;
+} BuiltInPrograms[] =
+{
+	{ "sprite loop", { 0x6000, 0x6100, 0xA214, 0xD015, 0x7001, 0x7102, 0x8014, 0x3000, 0x1204, 0x1200, 0xF090, 0x9090, 0xF000 }, 13 },
+	{ "memory copy", { 0x6800, 0xA300, 0xF81E, 0xF765, 0xA400, 0xF81E, 0xF755, 0x7808, 0x1202 }, 9 },
+	{ "score display", { 0x00E0, 0x8250, 0xA300, 0xF233, 0xF265, 0x6400, 0xF029, 0x6300, 0xD345, 0xF129, 0x6305, 0xD345, 0xF229, 0x630A, 0xD345, 0x7501, 0x1200 }, 17 },
+	{ "register arithmetic", { 0x6001, 0x6102, 0x8014, 0x8125, 0x8016, 0x7103, 0x8213, 0x7205, 0x1204 }, 9 }
+};
+
+static const unsigned int BatchLanes[] = { 64, 1024 };
+
+static void AppendWord(std::vector<char>& Program, uint16_t Word)
+{
+	Program.push_back(static_cast<char>(Word >> 8));
+	Program.push_back(static_cast<char>(Word & 0xFF));
+}
+
+static std::string EscapeJson(const std::string& Text)
+{
+	std::string Escaped;
+	for (char Character : Text)
+	{
+		if ((Character == '"') || (Character == '\\'))
+			Escaped += '\\';
+		if (static_cast<unsigned char>(Character) >= 0x20)
+			Escaped += Character;
+	}
+	return Escaped;
+}
+
+CHIP_8_BENCHMARK::CHIP_8_BENCHMARK(std::ostream& Output, double MinimumSeconds, const std::string& Filter, CHIP_8_MEMORY_MODEL Model) : mOutput{ &Output }, mMinimumSeconds{ MinimumSeconds }, mFilter{ Filter }, mMemoryModel{ Model }
+{
+	for (const auto& BuiltIn : BuiltInPrograms)
+	{
+		CHIP_8_BENCHMARK_PROGRAM Program{ BuiltIn.Name, {}, CHIP_8_QUIRKS__DEFAULT };
+		for (unsigned int i = 0; i < BuiltIn.NumberOfWords; ++i)
+		{
+			AppendWord(Program.Data, BuiltIn.Words[i]);
+		}
+		mPrograms.push_back(Program);
+	}
+}
+
+//Adds a program file to the program group, to be run under the given profile.
+void CHIP_8_BENCHMARK::AddProgram(const std::string& Filename, CHIP_8_QUIRKS Quirks)
+{
+	std::ifstream File(Filename, std::ios::binary);
+	if (!File)
+		throw(std::runtime_error("Could not open program \"" + Filename + "\"."));
+	CHIP_8_BENCHMARK_PROGRAM Program{ Filename, std::vector<char>(std::istreambuf_iterator<char>(File), std::istreambuf_iterator<char>()), Quirks };
+	mPrograms.push_back(Program);
+}
+
+//A measurement runs when the filter is empty or is part of "<group>/<case>".
+bool CHIP_8_BENCHMARK::IsSelected(const char* Group, const std::string& Case)
+{
+	return mFilter.empty() || ((std::string(Group) + "/" + Case).find(mFilter) != std::string::npos);
+}
+
+void CHIP_8_BENCHMARK::WriteResult(const char* Group, const std::string& Case, const char* Engine, CHIP_8_QUIRKS Quirks, const char* Status, const char* Unit, uint64_t Count, double Seconds)
+{
+	char Text[64];
+	*mOutput << "{ \"group\": \"" << Group << "\", \"case\": \"" << EscapeJson(Case) << "\", \"engine\": \"" << Engine << "\", \"quirks\": \"" << CHIP_8_HEADLESS::GetQuirksName(Quirks) << "\", \"memory\": \"" << CHIP_8_HEADLESS::GetMemoryModelName(mMemoryModel) << "\", \"status\": \"" << Status << "\"";
+	*mOutput << ", \"unit\": \"" << Unit << "\", \"count\": " << Count;
+	snprintf(Text, sizeof(Text), "%.6f", Seconds);
+	*mOutput << ", \"seconds\": " << Text;
+	snprintf(Text, sizeof(Text), "%.3f", Count ? (Seconds * 1e9 / Count) : 0.0);
+	*mOutput << ", \"ns_per_unit\": " << Text << " }\n";
+	mOutput->flush();
+}
+
+//Runs one untimed frame, then whole frames until the minimum time has passed, and returns the seconds taken with the instructions executed in them. Stops early when
+//the program stops making progress, which only the program group can run into.
+double CHIP_8_BENCHMARK::TimeFrames(CHIP_8& Interpreter, unsigned int InstructionsPerFrame, uint64_t& Instructions)
+{
+	Interpreter.RunFrame(InstructionsPerFrame);
+	uint64_t Start = Interpreter.GetExecutedInstructions();
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	double Seconds;
+	do
+	{
+		uint64_t Before = Interpreter.GetExecutedInstructions();
+		Interpreter.RunFrame(InstructionsPerFrame);
+		Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+		if (Interpreter.GetExecutedInstructions() == Before)
+			break;
+	} while (Seconds < mMinimumSeconds);
+	Instructions = Interpreter.GetExecutedInstructions() - Start;
+	return Seconds;
+}
+
+//Builds a stream from Setup and as many copies of Body as fit, and times it on every engine, or on the switch engine only when the engines would all run the same handler.
+void CHIP_8_BENCHMARK::RunStream(const char* Group, const std::string& Case, const std::vector<uint16_t>& Setup, const std::vector<uint16_t>& Body, CHIP_8_QUIRKS Quirks, bool AllEngines)
+{
+	if (!IsSelected(Group, Case))
+		return;
+
+	std::vector<char> Program;
+	AppendWord(Program, static_cast<uint16_t>(0xA000 | DATA_ADDRESS));
+	for (uint16_t Word : Setup)
+	{
+		AppendWord(Program, Word);
+	}
+	while ((Program.size() / 2) + Body.size() < STREAM_WORDS)
+	{
+		for (uint16_t Word : Body)
+		{
+			uint16_t Address = static_cast<uint16_t>(STREAM_ADDRESS + Program.size());
+			if ((Word == 0x1000) || (Word == 0xB000))
+				Word |= Address + 2;
+			AppendWord(Program, Word);
+		}
+	}
+	AppendWord(Program, static_cast<uint16_t>(0x1000 | STREAM_ADDRESS));
+	Program.resize(SUBROUTINE_ADDRESS - STREAM_ADDRESS, 0);
+	AppendWord(Program, 0x00EE);
+	Program.resize(DATA_ADDRESS - STREAM_ADDRESS, 0);
+	for (unsigned int i = 0; i < DATA_SIZE; ++i)
+	{
+		Program.push_back(static_cast<char>((i & 1) ? 0x55 : 0xAA));
+	}
+
+	for (const auto& Engine : Engines)
+	{
+		CHIP_8 Interpreter(Engine.Engine);
+		Interpreter.SetQuirks(Quirks);
+		Interpreter.SetMemoryModel(mMemoryModel);
+		if (Interpreter.LoadProgram(Program.data(), static_cast<unsigned int>(Program.size())) != CHIP_8_ERROR_CODE__STATUS_OK)
+			throw(std::runtime_error("Could not load the stream for \"" + Case + "\"."));
+		uint64_t Instructions;
+		double Seconds = TimeFrames(Interpreter, mFRAME_INSTRUCTIONS, Instructions);
+		if (Interpreter.GetStatus() != CHIP_8_ERROR_CODE__STATUS_OK)
+			throw(std::runtime_error("The stream for \"" + Case + "\" stopped with status " + CHIP_8_HEADLESS::GetStatusName(Interpreter.GetStatus()) + "."));
+		WriteResult(Group, Case, Engine.Name, Quirks, CHIP_8_HEADLESS::GetStatusName(Interpreter.GetStatus()), "instruction", Instructions, Seconds);
+		if (!AllEngines)
+			break;
+	}
+}
+
+//The cost of executing each operation, fetch and dispatch included, on each engine.
+void CHIP_8_BENCHMARK::RunDispatch()
+{
+	for (const DISPATCH_CASE& Case : DispatchCases)
+	{
+		std::vector<uint16_t> Setup;
+		if (Case.Setup != NO_SETUP)
+			Setup.push_back(Case.Setup);
+		std::vector<uint16_t> Body(1, Case.Body[0]);
+		if (Case.Body[1])
+			Body.push_back(Case.Body[1]);
+		std::string Name = CHIP_8::GetOperationName(Case.Operation);
+		if (Case.Operation == CHIP_8_OPERATION__00EE__RET)
+			Name = std::string(CHIP_8::GetOperationName(CHIP_8_OPERATION__2nnn__CALL_addr)) + " + " + Name;
+		RunStream("dispatch", Name, Setup, Body, Case.Quirks, true);
+	}
+}
+
+//The cost of Dxyn by sprite height and position, clipped by the default and SUPER-CHIP profiles and wrapped by XO-CHIP. Every engine calls the same handler,
+//so only the switch engine is timed.
+void CHIP_8_BENCHMARK::RunDrawing()
+{
+	static const CHIP_8_QUIRKS Profiles[] = { CHIP_8_QUIRKS__DEFAULT, CHIP_8_QUIRKS__XO_CHIP };
+	for (CHIP_8_QUIRKS Quirks : Profiles)
+	{
+		for (unsigned int Height : SpriteHeights)
+		{
+			for (const auto& Position : DrawPositions)
+			{
+				std::string Name = "Dxyn " + std::to_string(Height) + " rows " + Position.Name;
+				RunStream("drawing", Name, { static_cast<uint16_t>(0x6000 | Position.X), static_cast<uint16_t>(0x6100 | Position.Y) }, { static_cast<uint16_t>(0xD010 | Height) }, Quirks, false);
+			}
+		}
+	}
+	for (const auto& Position : DrawPositions)
+	{
+		std::string Name = std::string("Dxy0 16x16 high resolution ") + Position.Name;
+		RunStream("drawing", Name, { 0x00FF, static_cast<uint16_t>(0x6000 | (2 * Position.X)), static_cast<uint16_t>(0x6100 | (2 * Position.Y)) }, { 0xD010 }, CHIP_8_QUIRKS__SUPER_CHIP, false);
+	}
+	RunStream("drawing", "Dxy0 16x16 high resolution inside, 2 planes", { 0x00FF, 0xF301, 0x6010, 0x6110 }, { 0xD010 }, CHIP_8_QUIRKS__XO_CHIP, false);
+}
+
+//The cost of clearing the display at both resolutions, and of LoadProgram, which resets the machine first, for the smallest program and for the largest one each
+//profile's memory holds, with and without the decoded instructions a ROM store hands it.
+void CHIP_8_BENCHMARK::RunHousekeeping()
+{
+	RunStream("housekeeping", "00E0 CLS low resolution", {}, { 0x00E0 }, CHIP_8_QUIRKS__DEFAULT, false);
+	RunStream("housekeeping", "00E0 CLS high resolution", { 0x00FF }, { 0x00E0 }, CHIP_8_QUIRKS__SUPER_CHIP, false);
+	RunStream("housekeeping", "00E0 CLS high resolution, 2 planes", { 0x00FF, 0xF301 }, { 0x00E0 }, CHIP_8_QUIRKS__XO_CHIP, false);
+
+	static const CHIP_8_QUIRKS Profiles[] = { CHIP_8_QUIRKS__DEFAULT, CHIP_8_QUIRKS__XO_CHIP };
+	for (CHIP_8_QUIRKS Quirks : Profiles)
+	{
+		for (const auto& Engine : Engines)
+		{
+			CHIP_8 Interpreter(Engine.Engine);
+			Interpreter.SetQuirks(Quirks);
+			Interpreter.SetMemoryModel(mMemoryModel);
+			std::vector<uint8_t> Program(Interpreter.GetMemorySize() - STREAM_ADDRESS, 0);
+			const unsigned int Sizes[] = { 2, static_cast<unsigned int>(Program.size()) };
+			for (unsigned int Size : Sizes)
+			{
+				std::vector<CHIP_8_DECODED_INSTRUCTION> DecodedInstructions(CHIP_8::GetPredecodedLength(Size));
+				CHIP_8::PredecodeProgram(Program.data(), Size, DecodedInstructions.data());
+				for (bool Predecoded : { false, true })
+				{
+					std::string Name = "LoadProgram " + std::to_string(Size) + " bytes" + (Predecoded ? ", predecoded" : "");
+					if (!IsSelected("housekeeping", Name))
+						continue;
+					uint64_t Calls = 0;
+					std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+					double Seconds;
+					do
+					{
+						for (unsigned int i = 0; i < 64; ++i)
+						{
+							Interpreter.LoadProgram(Program.data(), Size, Predecoded ? DecodedInstructions.data() : nullptr);
+						}
+						Calls += 64;
+						Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+					} while (Seconds < mMinimumSeconds);
+					WriteResult("housekeeping", Name, Engine.Name, Quirks, CHIP_8_HEADLESS::GetStatusName(Interpreter.GetStatus()), "call", Calls, Seconds);
+				}
+			}
+		}
+	}
+}
+
+//Instructions per second over whole programs on each engine, in frames of mFRAME_INSTRUCTIONS instructions. Idle loops the interpreter fast-forwards count as
+//executed, as they do everywhere else. A program that stops, or waits for a key, is timed up to there and reported with its status.
+void CHIP_8_BENCHMARK::RunPrograms()
+{
+	for (CHIP_8_BENCHMARK_PROGRAM& Program : mPrograms)
+	{
+		if (!IsSelected("program", Program.Name))
+			continue;
+		for (const auto& Engine : Engines)
+		{
+			CHIP_8 Interpreter(Engine.Engine);
+			Interpreter.SetQuirks(Program.Quirks);
+			Interpreter.SetMemoryModel(mMemoryModel);
+			if (Interpreter.LoadProgram(Program.Data.data(), static_cast<unsigned int>(Program.Data.size())) != CHIP_8_ERROR_CODE__STATUS_OK)
+				throw(std::runtime_error("Could not load program \"" + Program.Name + "\": " + CHIP_8_HEADLESS::GetStatusName(Interpreter.GetStatus()) + "."));
+			uint64_t Instructions;
+			double Seconds = TimeFrames(Interpreter, mFRAME_INSTRUCTIONS, Instructions);
+			const char* Status = Interpreter.IsWaitingForKey() ? "WAITING_FOR_KEY" : CHIP_8_HEADLESS::GetStatusName(Interpreter.GetStatus());
+			WriteResult("program", Program.Name, Engine.Name, Program.Quirks, Status, "instruction", Instructions, Seconds);
+		}
+	}
+}
+
+//Runs every program on many machines at once: in a CHIP_8_BATCH, and on as many lone machines of the switch engine run one after another, which is what the batch
+//replaces. Both report the instructions of all their machines together. The machines are seeded apart, so programs using random numbers spread over groups of
+//lanes as they would when running many seeds.
+void CHIP_8_BENCHMARK::RunBatches()
+{
+	for (CHIP_8_BENCHMARK_PROGRAM& Program : mPrograms)
+	{
+		for (unsigned int Lanes : BatchLanes)
+		{
+			std::string Case = Program.Name + " x" + std::to_string(Lanes);
+			if (!IsSelected("batch", Case))
+				continue;
+
+			{
+				CHIP_8_BATCH Batch(Lanes);
+				Batch.SetQuirks(Program.Quirks);
+				for (unsigned int i = 0; i < Lanes; ++i)
+				{
+					Batch.GetLane(i).SetMemoryModel(mMemoryModel);
+				}
+				Batch.LoadProgram(Program.Data.data(), static_cast<unsigned int>(Program.Data.size()));
+				if (Batch.GetLane(0).GetStatus() != CHIP_8_ERROR_CODE__STATUS_OK)
+					throw(std::runtime_error("Could not load program \"" + Program.Name + "\": " + CHIP_8_HEADLESS::GetStatusName(Batch.GetLane(0).GetStatus()) + "."));
+				for (unsigned int i = 0; i < Lanes; ++i)
+				{
+					Batch.GetLane(i).SetSeed(i);
+				}
+
+				Batch.RunFrame(mBATCH_FRAME_INSTRUCTIONS);
+				uint64_t Start = Batch.GetExecutedInstructions();
+				std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+				double Seconds;
+				do
+				{
+					uint64_t Before = Batch.GetExecutedInstructions();
+					Batch.RunFrame(mBATCH_FRAME_INSTRUCTIONS);
+					Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+					if (Batch.GetExecutedInstructions() == Before)
+						break;
+				} while (Seconds < mMinimumSeconds);
+				const char* Status = Batch.GetLane(0).IsWaitingForKey() ? "WAITING_FOR_KEY" : CHIP_8_HEADLESS::GetStatusName(Batch.GetLane(0).GetStatus());
+				WriteResult("batch", Case, "batch", Program.Quirks, Status, "instruction", Batch.GetExecutedInstructions() - Start, Seconds);
+			}
+
+			std::unique_ptr<CHIP_8[]> Machines(new CHIP_8[Lanes]);
+			for (unsigned int i = 0; i < Lanes; ++i)
+			{
+				Machines[i].SetQuirks(Program.Quirks);
+				Machines[i].SetMemoryModel(mMemoryModel);
+				Machines[i].LoadProgram(Program.Data.data(), static_cast<unsigned int>(Program.Data.size()));
+				Machines[i].SetSeed(i);
+				Machines[i].RunFrame(mBATCH_FRAME_INSTRUCTIONS);
+			}
+			uint64_t Instructions = 0;
+			std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+			double Seconds;
+			do
+			{
+				uint64_t Before = Instructions;
+				for (unsigned int i = 0; i < Lanes; ++i)
+				{
+					uint64_t Executed = Machines[i].GetExecutedInstructions();
+					Machines[i].RunFrame(mBATCH_FRAME_INSTRUCTIONS);
+					Instructions += Machines[i].GetExecutedInstructions() - Executed;
+				}
+				Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+				if (Instructions == Before)
+					break;
+			} while (Seconds < mMinimumSeconds);
+			const char* Status = Machines[0].IsWaitingForKey() ? "WAITING_FOR_KEY" : CHIP_8_HEADLESS::GetStatusName(Machines[0].GetStatus());
+			WriteResult("batch", Case, "switch", Program.Quirks, Status, "instruction", Instructions, Seconds);
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Interpreter/CHIP-8.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//A program run as a whole by the program group: the built-in workloads and the files given on the command line.
+struct CHIP_8_BENCHMARK_PROGRAM
+{
+	std::string Name;
+	std::vector<char> Data;
+	CHIP_8_QUIRKS Quirks;
+};
+
+//Times the interpreter through its public interface and writes one JSON object per line for every measurement, so that the results of two builds can be compared
+//line by line. Every measurement repeats whole frames until a minimum time has passed; the first frame of every measurement is run untimed so that the decode cache
+//and the JIT are warm.
+class CHIP_8_BENCHMARK
+{
+	private:
+		std::ostream* mOutput;
+		double mMinimumSeconds;
+		std::string mFilter;
+		CHIP_8_MEMORY_MODEL mMemoryModel;
+		std::vector<CHIP_8_BENCHMARK_PROGRAM> mPrograms;
+
+		bool IsSelected(const char*, const std::string&);
+		void WriteResult(const char*, const std::string&, const char*, CHIP_8_QUIRKS, const char*, const char*, uint64_t, double);
+		double TimeFrames(CHIP_8&, unsigned int, uint64_t&);
+		void RunStream(const char*, const std::string&, const std::vector<uint16_t>&, const std::vector<uint16_t>&, CHIP_8_QUIRKS, bool);
+
+	public:
+		static const unsigned int mFRAME_INSTRUCTIONS = 100000;
+		//Per lane; the lanes of a batch are loaded and stored around every frame, which is part of what the batch group measures.
+		static const unsigned int mBATCH_FRAME_INSTRUCTIONS = 1000;
+		static constexpr double mDEFAULT_MINIMUM_SECONDS = 0.2;
+
+		CHIP_8_BENCHMARK(std::ostream&, double, const std::string&, CHIP_8_MEMORY_MODEL);
+		void AddProgram(const std::string&, CHIP_8_QUIRKS);
+		void RunDispatch();
+		void RunDrawing();
+		void RunHousekeeping();
+		void RunPrograms();
+		void RunBatches();
+};
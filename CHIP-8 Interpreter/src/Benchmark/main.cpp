@@ -0,0 +1,127 @@
+#include "Benchmark/Benchmark.h"
+#include "Headless/Headless.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+const char* Usage =
+	"Usage: CHIP-8_Benchmark [options]\n"
+	"  --group NAME        run only dispatch, drawing, housekeeping, program or batch; may be given more than once (default all)\n"
+	"  --filter TEXT       run only the measurements whose \"<group>/<case>\" contains TEXT\n"
+	"  --min-time SECONDS  time every measurement for at least SECONDS (default 0.2)\n"
+	"  --quirks NAME       default, cosmac-vip, super-chip or xo-chip, for the --rom options after it (default default)\n"
+	"  --memory NAME       strict or wrapped memory model for every measurement (default strict)\n"
+	"  --rom FILE          add FILE to the program group, next to the built-in programs\n"
+	"  --output FILE       write the results to FILE instead of the standard output\n"
+	"Every measurement is written as one JSON object per line.\n";
+
+int main(int argc, char* argv[])
+{
+	std::string OutputFile;
+	std::string Filter;
+	std::vector<std::string> Programs;
+	std::vector<CHIP_8_QUIRKS> ProgramQuirks;
+	std::vector<std::string> Groups;
+	double MinimumSeconds = CHIP_8_BENCHMARK::mDEFAULT_MINIMUM_SECONDS;
+	CHIP_8_QUIRKS Quirks = CHIP_8_QUIRKS__DEFAULT;
+	CHIP_8_MEMORY_MODEL MemoryModel = CHIP_8_MEMORY_MODEL__STRICT;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* Argument = argv[i];
+		bool HasValue = (i + 1) < argc;
+		if (!strcmp(Argument, "--group") && HasValue)
+		{
+			const char* Name = argv[++i];
+			if (strcmp(Name, "dispatch") && strcmp(Name, "drawing") && strcmp(Name, "housekeeping") && strcmp(Name, "program") && strcmp(Name, "batch"))
+			{
+				std::cerr << "Unknown group \"" << Name << "\".\n" << Usage;
+				return 1;
+			}
+			Groups.push_back(Name);
+		}
+		else if (!strcmp(Argument, "--filter") && HasValue)
+			Filter = argv[++i];
+		else if (!strcmp(Argument, "--min-time") && HasValue)
+			MinimumSeconds = strtod(argv[++i], nullptr);
+		else if (!strcmp(Argument, "--quirks") && HasValue)
+		{
+			const char* Name = argv[++i];
+			if (!CHIP_8_HEADLESS::FindQuirks(Name, Quirks))
+			{
+				std::cerr << "Unknown quirk profile \"" << Name << "\".\n" << Usage;
+				return 1;
+			}
+		}
+		else if (!strcmp(Argument, "--memory") && HasValue)
+		{
+			const char* Name = argv[++i];
+			if (!CHIP_8_HEADLESS::FindMemoryModel(Name, MemoryModel))
+			{
+				std::cerr << "Unknown memory model \"" << Name << "\".\n" << Usage;
+				return 1;
+			}
+		}
+		else if (!strcmp(Argument, "--rom") && HasValue)
+		{
+			Programs.push_back(argv[++i]);
+			ProgramQuirks.push_back(Quirks);
+		}
+		else if (!strcmp(Argument, "--output") && HasValue)
+			OutputFile = argv[++i];
+		else
+		{
+			std::cerr << Usage;
+			return 1;
+		}
+	}
+
+	auto IsGroupSelected = [&Groups](const char* Name)
+	{
+		if (Groups.empty())
+			return true;
+		for (const std::string& Group : Groups)
+		{
+			if (Group == Name)
+				return true;
+		}
+		return false;
+	};
+
+	try
+	{
+		std::ofstream File;
+		if (!OutputFile.empty())
+		{
+			File.open(OutputFile);
+			if (!File)
+				throw(std::runtime_error("Could not open output file \"" + OutputFile + "\"."));
+		}
+		CHIP_8_BENCHMARK Benchmark(OutputFile.empty() ? std::cout : File, MinimumSeconds, Filter, MemoryModel);
+		for (size_t i = 0; i < Programs.size(); ++i)
+		{
+			Benchmark.AddProgram(Programs[i], ProgramQuirks[i]);
+		}
+
+		if (IsGroupSelected("dispatch"))
+			Benchmark.RunDispatch();
+		if (IsGroupSelected("drawing"))
+			Benchmark.RunDrawing();
+		if (IsGroupSelected("housekeeping"))
+			Benchmark.RunHousekeeping();
+		if (IsGroupSelected("program"))
+			Benchmark.RunPrograms();
+		if (IsGroupSelected("batch"))
+			Benchmark.RunBatches();
+	}
+	catch (const std::exception& Error)
+	{
+		std::cerr << Error.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,175 @@
+#include "Headless/Farm.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+//Quotes a text as the value of a result field: backslashes and quotes in it are escaped with a backslash, so that the field ends at the first unescaped quote.
+static std::string QuoteValue(const std::string& Text)
+{
+	std::string Quoted = "\"";
+	for (char Character : Text)
+	{
+		if ((Character == '"') || (Character == '\\'))
+			Quoted += '\\';
+		Quoted += Character;
+	}
+	return Quoted + "\"";
+}
+
+CHIP_8_FARM::CHIP_8_FARM(CHIP_8_ENGINE Engine, unsigned int InstructionsPerSecond, uint64_t Seed) : mEngine{ Engine }, mMemoryModel{ CHIP_8_MEMORY_MODEL__STRICT }, mNumberOfInstructionsPerSecond{ InstructionsPerSecond }, mSeed{ Seed }, mOutput{ nullptr }, mFailedJobs{ 0 }
+{
+}
+
+//Applies to every job, as the engine does.
+void CHIP_8_FARM::SetMemoryModel(CHIP_8_MEMORY_MODEL Model)
+{
+	mMemoryModel = Model;
+}
+
+void CHIP_8_FARM::LoadManifest(const std::string& Filename)
+{
+	std::ifstream File(Filename);
+	if (!File)
+		throw(std::runtime_error("Could not open manifest \"" + Filename + "\"."));
+
+	std::string Line;
+	unsigned int LineNumber = 0;
+	while (std::getline(File, Line))
+	{
+		++LineNumber;
+		std::istringstream Fields(Line);
+		CHIP_8_FARM_JOB Job;
+		Fields >> std::ws;
+		if (Fields.eof() || (Fields.peek() == '#'))
+			continue;
+		if (!(Fields >> Job.Program >> Job.Quirks >> Job.InputScript >> Job.Frames))
+			throw(std::runtime_error("Manifest line " + std::to_string(LineNumber) + " is not \"<program> <quirks> <input script or -> <frames>\"."));
+		if (Job.InputScript == "-")
+			Job.InputScript.clear();
+		mJobs.push_back(Job);
+	}
+}
+
+bool CHIP_8_FARM::TakeJob(unsigned int Worker, unsigned int& Job)
+{
+	{
+		WORKER_QUEUE& Own = *mQueues[Worker];
+		std::lock_guard<std::mutex> Guard(Own.Lock);
+		if (!Own.Jobs.empty())
+		{
+			Job = Own.Jobs.back();
+			Own.Jobs.pop_back();
+			return true;
+		}
+	}
+	for (size_t i = 1; i < mQueues.size(); ++i)
+	{
+		WORKER_QUEUE& Victim = *mQueues[(Worker + i) % mQueues.size()];
+		std::lock_guard<std::mutex> Guard(Victim.Lock);
+		if (!Victim.Jobs.empty())
+		{
+			Job = Victim.Jobs.front();
+			Victim.Jobs.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void CHIP_8_FARM::Work(unsigned int Worker)
+{
+	CHIP_8_HEADLESS Runner(mEngine, mNumberOfInstructionsPerSecond, mSeed);
+	Runner.SetMemoryModel(mMemoryModel);
+	unsigned int Job;
+	while (TakeJob(Worker, Job))
+	{
+		RunJob(Runner, Job);
+	}
+}
+
+void CHIP_8_FARM::RunJob(CHIP_8_HEADLESS& Runner, unsigned int JobIndex)
+{
+	const CHIP_8_FARM_JOB& Job = mJobs[JobIndex];
+	std::ostringstream Result;
+	Result << "job=" << JobIndex << " program=" << Job.Program;
+	try
+	{
+		std::shared_ptr<CHIP_8_ROM> ROM = mROMStore.Open(Job.Program);
+		CHIP_8_QUIRKS Profile;
+		if (Job.Quirks == "auto")
+		{
+			Profile = ROM->GetQuirks();
+			Result << " quirks=" << CHIP_8_HEADLESS::GetQuirksName(Profile);
+		}
+		else if (!CHIP_8_HEADLESS::FindQuirks(Job.Quirks, Profile))
+			throw(std::runtime_error("quirk profile \"" + Job.Quirks + "\" is not known"));
+		Runner.SetQuirks(Profile);
+		Runner.LoadProgram(*ROM);
+		if (!Job.InputScript.empty())
+			Runner.LoadInputScript(Job.InputScript);
+		Runner.RunFrames(Job.Frames);
+
+		char Text[64];
+		Result << " status=" << CHIP_8_HEADLESS::GetStatusName(Runner.GetInterpreter().GetStatus());
+		Result << " frames=" << Runner.GetFrames();
+		Result << " instructions=" << Runner.GetInstructions();
+		snprintf(Text, sizeof(Text), "%.6f", Runner.GetWallTime());
+		Result << " wall_time_seconds=" << Text;
+		snprintf(Text, sizeof(Text), "%016llx", static_cast<unsigned long long>(Runner.GetDisplayHash()));
+		Result << " display_hash=" << Text;
+		if (!CHIP_8_HEADLESS::IsSuccess(Runner.GetInterpreter().GetStatus()))
+			++mFailedJobs;
+	}
+	catch (const std::exception& Error)
+	{
+		Result << " status=FAILED error=" << QuoteValue(Error.what());
+		++mFailedJobs;
+	}
+	Result << "\n";
+
+	std::lock_guard<std::mutex> Guard(mOutputLock);
+	*mOutput << Result.str();
+	mOutput->flush();
+}
+
+//Runs all jobs of the manifest and returns how many of them failed to load or ended in an interpreter error. The results are followed by a comment line with
+//the statistics of the ROM store.
+unsigned int CHIP_8_FARM::Run(unsigned int NumberOfThreads, std::ostream& Output)
+{
+	if (NumberOfThreads == 0)
+		NumberOfThreads = 1;
+	mOutput = &Output;
+	mFailedJobs = 0;
+
+	mQueues.clear();
+	for (unsigned int i = 0; i < NumberOfThreads; ++i)
+	{
+		mQueues.emplace_back(new WORKER_QUEUE);
+	}
+	for (unsigned int i = 0; i < mJobs.size(); ++i)
+	{
+		mQueues[i % NumberOfThreads]->Jobs.push_back(i);
+	}
+
+	std::vector<std::thread> Threads;
+	for (unsigned int i = 1; i < NumberOfThreads; ++i)
+	{
+		Threads.emplace_back(&CHIP_8_FARM::Work, this, i);
+	}
+	Work(0);
+	for (std::thread& Thread : Threads)
+	{
+		Thread.join();
+	}
+
+	CHIP_8_ROM_STORE_STATISTICS Statistics = mROMStore.GetStatistics();
+	Output << "# rom_store opens=" << Statistics.Opens << " file_hits=" << Statistics.FileHits << " content_hits=" << Statistics.ContentHits << " misses=" << Statistics.Misses;
+	Output << " analysis_hits=" << Statistics.AnalysisHits << " analysis_misses=" << Statistics.AnalysisMisses << " roms=" << Statistics.NumberOfROMs << " bytes=" << Statistics.Bytes << "\n";
+	Output.flush();
+
+	mOutput = nullptr;
+	return mFailedJobs;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "Interpreter/CHIP-8.h"
+#include "Interpreter/CHIP-8_ROM_Store.h"
+#include "Headless/Headless.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//One line of a manifest: "<program> <quirks> <input script or -> <frames>". Lines starting with '#' are ignored. Quirks "auto" runs the program under the profile its
+//ROM finds for it.
+struct CHIP_8_FARM_JOB
+{
+	std::string Program;
+	std::string Quirks;
+	std::string InputScript;
+	unsigned int Frames;
+};
+
+//Runs every job of a manifest on a pool of threads, each with its own runner and interpreter. Jobs are dealt out round-robin to per-thread queues; a thread takes work
+//from the back of its own queue and, once that is empty, steals from the front of the others. Each result is written as one line as soon as its job finishes.
+//Programs are opened through one ROM store shared by all threads, so a program run by many jobs is read and decoded once.
+class CHIP_8_FARM
+{
+	private:
+		struct WORKER_QUEUE
+		{
+			std::mutex Lock;
+			std::deque<unsigned int> Jobs;
+		};
+
+		CHIP_8_ENGINE mEngine;
+		CHIP_8_MEMORY_MODEL mMemoryModel;
+		unsigned int mNumberOfInstructionsPerSecond;
+		uint64_t mSeed;
+		std::vector<CHIP_8_FARM_JOB> mJobs;
+		CHIP_8_ROM_STORE mROMStore;
+		std::vector<std::unique_ptr<WORKER_QUEUE>> mQueues;
+		std::mutex mOutputLock;
+		std::ostream* mOutput;
+		std::atomic<unsigned int> mFailedJobs;
+
+		bool TakeJob(unsigned int, unsigned int&);
+		void Work(unsigned int);
+		void RunJob(CHIP_8_HEADLESS&, unsigned int);
+
+	public:
+		CHIP_8_FARM(CHIP_8_ENGINE, unsigned int, uint64_t);
+		void SetMemoryModel(CHIP_8_MEMORY_MODEL);
+		void LoadManifest(const std::string&);
+		unsigned int Run(unsigned int, std::ostream&);
+};
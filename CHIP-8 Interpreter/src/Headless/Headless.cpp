@@ -0,0 +1,568 @@
+#include "Headless/Headless.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#if CHIP_8_PROFILING == true
+//Indices of the non-zero counts, largest count first.
+static std::vector<unsigned int> SortByCount(const uint64_t* Counts, unsigned int NumberOfCounts)
+{
+	std::vector<unsigned int> Indices;
+	for (unsigned int i = 0; i < NumberOfCounts; ++i)
+	{
+		if (Counts[i] != 0)
+			Indices.push_back(i);
+	}
+	std::stable_sort(Indices.begin(), Indices.end(), [Counts](unsigned int a, unsigned int b) { return Counts[a] > Counts[b]; });
+	return Indices;
+}
+#endif
+
+CHIP_8_HEADLESS::CHIP_8_HEADLESS(CHIP_8_ENGINE Engine, unsigned int InstructionsPerSecond, uint64_t Seed) : mRewind{ nullptr }, mTrace{ nullptr }, mScheduler{ nullptr }, mDueFrames{ 0 }, mNextInputEvent{ 0 }, mRate(InstructionsPerSecond), mSeed{ Seed }, mFrames{ 0 }, mInstructions{ 0 }, mWallTime{ 0 }, mLastStopReason{ CHIP_8_STOP_REASON__BUDGET_EXHAUSTED }
+{
+	mInterpreter = new CHIP_8(Engine);
+}
+
+CHIP_8_HEADLESS::~CHIP_8_HEADLESS()
+{
+	delete mScheduler;
+	delete mTrace;
+	delete mRewind;
+	delete mInterpreter;
+}
+
+//Starts a new run; the input script, if any, has to be loaded afterwards.
+void CHIP_8_HEADLESS::LoadProgram(const std::string& Filename)
+{
+	std::ifstream File(Filename, std::ios::binary);
+	if (!File)
+		throw(std::runtime_error("Could not open program file \"" + Filename + "\"."));
+	std::vector<uint8_t> Buffer((std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+	LoadProgram(Buffer.data(), static_cast<unsigned int>(Buffer.size()), nullptr);
+}
+
+//Loads a program of a ROM store with the instructions it decoded, which spares decoding them again as they are first run.
+void CHIP_8_HEADLESS::LoadProgram(CHIP_8_ROM& ROM)
+{
+	LoadProgram(ROM.GetData(), ROM.GetSize(), ROM.GetDecodedInstructions());
+}
+
+void CHIP_8_HEADLESS::LoadProgram(const uint8_t* Program, unsigned int Size, const CHIP_8_DECODED_INSTRUCTION* DecodedInstructions)
+{
+	mInputEvents.clear();
+	mNextInputEvent = 0;
+	mRate.Reset();
+	mFrames = 0;
+	mInstructions = 0;
+	mWallTime = 0;
+	mLastStopReason = CHIP_8_STOP_REASON__BUDGET_EXHAUSTED;
+
+	if (mInterpreter->LoadProgram(Program, Size, DecodedInstructions) != CHIP_8_ERROR_CODE__STATUS_OK)
+		throw(std::runtime_error("Program is too big to fit in the memory."));
+	mInterpreter->SetSeed(mSeed);
+	if (mRewind)
+		mRewind->Clear();
+}
+
+void CHIP_8_HEADLESS::LoadInputScript(const std::string& Filename)
+{
+	std::ifstream File(Filename);
+	if (!File)
+		throw(std::runtime_error("Could not open input script \"" + Filename + "\"."));
+
+	std::string Line;
+	unsigned int LineNumber = 0;
+	while (std::getline(File, Line))
+	{
+		++LineNumber;
+		std::istringstream Fields(Line);
+		std::string Action;
+		CHIP_8_INPUT_EVENT Event;
+		Fields >> std::ws;
+		if (Fields.eof() || (Fields.peek() == '#'))
+			continue;
+		if (!(Fields >> Event.Frame >> Action >> std::hex >> Event.Button) || (Event.Button > 0xF) || ((Action != "press") && (Action != "release")))
+			throw(std::runtime_error("Input script line " + std::to_string(LineNumber) + " is not \"<frame> press|release <button>\"."));
+		Event.Pressed = (Action == "press");
+		mInputEvents.push_back(Event);
+	}
+	std::stable_sort(mInputEvents.begin(), mInputEvents.end(), [](const CHIP_8_INPUT_EVENT& A, const CHIP_8_INPUT_EVENT& B) { return A.Frame < B.Frame; });
+	mNextInputEvent = 0;
+}
+
+//The profile stays selected for the following programs until it is changed again.
+void CHIP_8_HEADLESS::SetQuirks(CHIP_8_QUIRKS Profile)
+{
+	mInterpreter->SetQuirks(Profile);
+}
+
+//Like the profile, the memory model stays selected for the following programs.
+void CHIP_8_HEADLESS::SetMemoryModel(CHIP_8_MEMORY_MODEL Model)
+{
+	mInterpreter->SetMemoryModel(Model);
+}
+
+void CHIP_8_HEADLESS::LoadState(const std::string& Filename)
+{
+	std::ifstream File(Filename, std::ios::binary);
+	if (!File)
+		throw(std::runtime_error("Could not open snapshot file \"" + Filename + "\"."));
+	//The file holds as many bytes as the snapshot's profile needs, which only the header read first tells.
+	CHIP_8_SNAPSHOT Snapshot;
+	File.read(reinterpret_cast<char*>(&Snapshot), sizeof(Snapshot));
+	size_t Size = static_cast<size_t>(File.gcount());
+	File.clear();
+	if ((Size < offsetof(CHIP_8_SNAPSHOT, Memory)) || (Size != Snapshot.GetSize()) || (File.peek() != std::char_traits<char>::eof()) || !mInterpreter->RestoreSnapshot(Snapshot))
+		throw(std::runtime_error("\"" + Filename + "\" is not a snapshot this version can restore."));
+	if (mRewind)
+		mRewind->Clear();
+}
+
+void CHIP_8_HEADLESS::SaveState(const std::string& Filename)
+{
+	CHIP_8_SNAPSHOT Snapshot;
+	mInterpreter->SaveSnapshot(Snapshot);
+	std::ofstream File(Filename, std::ios::binary);
+	if (!File || !File.write(reinterpret_cast<const char*>(&Snapshot), Snapshot.GetSize()))
+		throw(std::runtime_error("Could not write snapshot file \"" + Filename + "\"."));
+}
+
+//Records every following frame into a rewind history of the given size in bytes.
+void CHIP_8_HEADLESS::EnableRewind(size_t MemoryBudget)
+{
+	delete mRewind;
+	mRewind = new CHIP_8_REWIND(MemoryBudget);
+}
+
+//Records every instruction executed from now on into a trace file, which the report flushes.
+void CHIP_8_HEADLESS::EnableTrace(const std::string& Filename)
+{
+	mInterpreter->SetTrace(nullptr);
+	delete mTrace;
+	mTrace = nullptr;
+	mTrace = new CHIP_8_TRACE(Filename);
+	mInterpreter->SetTrace(mTrace);
+}
+
+//Runs every following frame at its time, 60 a second, sleeping in between as the front end does, and adds to the report how late the frames started.
+void CHIP_8_HEADLESS::EnableRealTime()
+{
+	delete mScheduler;
+	mScheduler = new CHIP_8_FRAME_SCHEDULER(60, CHIP_8_HOST::mMAX_FRAMES_PER_RUN);
+}
+
+//Steps the machine back by the given number of frames, as far as the history reaches.
+void CHIP_8_HEADLESS::RewindFrames(unsigned int NumberOfFrames)
+{
+	if (!mRewind)
+		throw(std::runtime_error("Rewinding needs a rewind history."));
+	if (NumberOfFrames >= mRewind->GetNumberOfFrames())
+		throw(std::runtime_error("The rewind history holds only " + std::to_string(mRewind->GetNumberOfFrames()) + " frames."));
+	uint64_t Before = mInterpreter->GetExecutedInstructions();
+	if (!mRewind->Rewind(*mInterpreter, NumberOfFrames))
+		throw(std::runtime_error("The rewind history could not be restored."));
+	mFrames -= NumberOfFrames;
+	mInstructions -= Before - mInterpreter->GetExecutedInstructions();
+}
+
+void CHIP_8_HEADLESS::ApplyInput()
+{
+	while ((mNextInputEvent < mInputEvents.size()) && (mInputEvents[mNextInputEvent].Frame <= mFrames))
+	{
+		const CHIP_8_INPUT_EVENT& Event = mInputEvents[mNextInputEvent];
+		if (Event.Pressed)
+			mInterpreter->PressButton(Event.Button);
+		else
+			mInterpreter->UnpressButton(Event.Button);
+		++mNextInputEvent;
+	}
+}
+
+//A run keeps to real time from its start, not from when real time was asked for.
+void CHIP_8_HEADLESS::RestartScheduler()
+{
+	if (mScheduler)
+		mScheduler->Restart();
+	mDueFrames = 0;
+}
+
+//Runs one 60th of a second, executing no more than the given number of instructions, and returns how many were executed.
+unsigned int CHIP_8_HEADLESS::RunOneFrame(unsigned int MaximumInstructions)
+{
+	if (mScheduler)
+	{
+		if (mDueFrames == 0)
+			mDueFrames = mScheduler->WaitForFrames();
+		--mDueFrames;
+	}
+	ApplyInput();
+
+	unsigned int InstructionsPerFrame = mRate.NextFrame();
+	if (InstructionsPerFrame > MaximumInstructions)
+		InstructionsPerFrame = MaximumInstructions;
+
+	uint64_t Before = mInterpreter->GetExecutedInstructions();
+	mLastStopReason = mInterpreter->RunFrame(InstructionsPerFrame);
+	unsigned int Executed = static_cast<unsigned int>(mInterpreter->GetExecutedInstructions() - Before);
+	mInstructions += Executed;
+	++mFrames;
+	if (mRewind)
+		mRewind->Push(*mInterpreter);
+	return Executed;
+}
+
+void CHIP_8_HEADLESS::RunFrames(unsigned int NumberOfFrames)
+{
+	std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+	RestartScheduler();
+	for (unsigned int i = 0; i < NumberOfFrames; ++i)
+	{
+		RunOneFrame(~0u);
+		if (mLastStopReason == CHIP_8_STOP_REASON__ERROR)
+			break;
+	}
+	mWallTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+}
+
+//Runs whole frames until the given number of instructions has been executed. Stops early on an error, or when the program waits for a key no remaining script line will press.
+void CHIP_8_HEADLESS::RunInstructions(uint64_t NumberOfInstructions)
+{
+	std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+	RestartScheduler();
+	uint64_t Executed = 0;
+	while (Executed < NumberOfInstructions)
+	{
+		uint64_t Remaining = NumberOfInstructions - Executed;
+		Executed += RunOneFrame((Remaining > ~0u) ? ~0u : static_cast<unsigned int>(Remaining));
+		if (mLastStopReason == CHIP_8_STOP_REASON__ERROR)
+			break;
+		if ((mLastStopReason == CHIP_8_STOP_REASON__WAITING_FOR_KEY) && (mNextInputEvent == mInputEvents.size()))
+			break;
+	}
+	mWallTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+}
+
+CHIP_8& CHIP_8_HEADLESS::GetInterpreter()
+{
+	return *mInterpreter;
+}
+
+unsigned int CHIP_8_HEADLESS::GetFrames()
+{
+	return mFrames;
+}
+
+uint64_t CHIP_8_HEADLESS::GetInstructions()
+{
+	return mInstructions;
+}
+
+double CHIP_8_HEADLESS::GetWallTime()
+{
+	return mWallTime;
+}
+
+//The hash of the current frame, as a front end would be handed it.
+uint64_t CHIP_8_HEADLESS::GetDisplayHash()
+{
+	CHIP_8_FRAME Frame;
+	Frame.Capture(*mInterpreter);
+	return Frame.GetHash();
+}
+
+const char* CHIP_8_HEADLESS::GetStatusName(CHIP_8_ERROR_CODE Status)
+{
+	switch (Status)
+	{
+		case CHIP_8_ERROR_CODE__STATUS_OK:
+			return "OK";
+		case CHIP_8_ERROR_CODE__RESET:
+			return "RESET";
+		case CHIP_8_ERROR_CODE__PROGRAM_TOO_BIG:
+			return "PROGRAM_TOO_BIG";
+		case CHIP_8_ERROR_CODE__OUT_OF_BOUNDS_MEMORY_ACCESS:
+			return "OUT_OF_BOUNDS_MEMORY_ACCESS";
+		case CHIP_8_ERROR_CODE__INSTRUCTION_NOT_RECOGNIZED:
+			return "INSTRUCTION_NOT_RECOGNIZED";
+		case CHIP_8_ERROR_CODE__INSTRUCTION_0NNN_NOT_IMPLEMENTED:
+			return "INSTRUCTION_0NNN_NOT_IMPLEMENTED";
+		case CHIP_8_ERROR_CODE__STACK_OVERFLOW:
+			return "STACK_OVERFLOW";
+		case CHIP_8_ERROR_CODE__STACK_UNDERFLOW:
+			return "STACK_UNDERFLOW";
+		case CHIP_8_ERROR_CODE__PROGRAM_EXITED:
+			return "EXITED";
+	}
+	return "UNKNOWN";
+}
+
+//A program that is still running or that ended itself with 00FD.
+bool CHIP_8_HEADLESS::IsSuccess(CHIP_8_ERROR_CODE Status)
+{
+	return (Status == CHIP_8_ERROR_CODE__STATUS_OK) || (Status == CHIP_8_ERROR_CODE__PROGRAM_EXITED);
+}
+
+const char* CHIP_8_HEADLESS::GetQuirksName(CHIP_8_QUIRKS Profile)
+{
+	switch (Profile)
+	{
+		case CHIP_8_QUIRKS__DEFAULT:
+			return "default";
+		case CHIP_8_QUIRKS__COSMAC_VIP:
+			return "cosmac-vip";
+		case CHIP_8_QUIRKS__SUPER_CHIP:
+			return "super-chip";
+		case CHIP_8_QUIRKS__XO_CHIP:
+			return "xo-chip";
+		default:
+			return "unknown";
+	}
+}
+
+//Looks a profile up by the name GetQuirksName gives it.
+bool CHIP_8_HEADLESS::FindQuirks(const std::string& Name, CHIP_8_QUIRKS& Profile)
+{
+	for (unsigned int i = 0; i < CHIP_8_QUIRKS__NUMBER_OF_PROFILES; ++i)
+	{
+		if (Name == GetQuirksName(static_cast<CHIP_8_QUIRKS>(i)))
+		{
+			Profile = static_cast<CHIP_8_QUIRKS>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+const char* CHIP_8_HEADLESS::GetMemoryModelName(CHIP_8_MEMORY_MODEL Model)
+{
+	switch (Model)
+	{
+		case CHIP_8_MEMORY_MODEL__STRICT:
+			return "strict";
+		case CHIP_8_MEMORY_MODEL__WRAPPED:
+			return "wrapped";
+		default:
+			return "unknown";
+	}
+}
+
+//Looks a memory model up by the name GetMemoryModelName gives it.
+bool CHIP_8_HEADLESS::FindMemoryModel(const std::string& Name, CHIP_8_MEMORY_MODEL& Model)
+{
+	for (unsigned int i = 0; i < CHIP_8_MEMORY_MODEL__NUMBER_OF_MODELS; ++i)
+	{
+		if (Name == GetMemoryModelName(static_cast<CHIP_8_MEMORY_MODEL>(i)))
+		{
+			Model = static_cast<CHIP_8_MEMORY_MODEL>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+void CHIP_8_HEADLESS::WriteReport(std::ostream& Output, bool WithDisplay)
+{
+	char Text[64];
+	Output << "status: " << GetStatusName(mInterpreter->GetStatus()) << "\n";
+	Output << "quirks: " << GetQuirksName(mInterpreter->GetQuirks()) << "\n";
+	Output << "memory: " << GetMemoryModelName(mInterpreter->GetMemoryModel()) << "\n";
+	Output << "frames: " << mFrames << "\n";
+	Output << "instructions: " << mInstructions << "\n";
+	Output << "idle_instructions: " << mInterpreter->GetIdleInstructions() << "\n";
+	snprintf(Text, sizeof(Text), "%.6f", mWallTime);
+	Output << "wall_time_seconds: " << Text << "\n";
+	snprintf(Text, sizeof(Text), "%.0f", (mWallTime > 0) ? (mInstructions / mWallTime) : 0.0);
+	Output << "instructions_per_second: " << Text << "\n";
+	if (mRewind)
+	{
+		Output << "rewind_frames: " << mRewind->GetNumberOfFrames() << "\n";
+		Output << "rewind_bytes: " << mRewind->GetMemoryUsed() << "\n";
+		snprintf(Text, sizeof(Text), "%.0f", mRewind->GetBytesPerSecond());
+		Output << "rewind_bytes_per_second: " << Text << "\n";
+	}
+	if (mTrace)
+	{
+		mTrace->Flush();
+		Output << "trace_instructions: " << mTrace->GetNumberOfInstructions() << "\n";
+		Output << "trace_bytes: " << mTrace->GetBytesWritten() << "\n";
+	}
+	if (mScheduler)
+	{
+		CHIP_8_FRAME_TIMING Timing = mScheduler->GetTiming();
+		Output << "realtime_frames: " << Timing.Frames << "\n";
+		Output << "realtime_dropped_frames: " << Timing.DroppedFrames << "\n";
+		snprintf(Text, sizeof(Text), "%.1f", Timing.MeanLateness);
+		Output << "frame_lateness_mean_us: " << Text << "\n";
+		snprintf(Text, sizeof(Text), "%.1f", Timing.MaxLateness);
+		Output << "frame_lateness_max_us: " << Text << "\n";
+		snprintf(Text, sizeof(Text), "%.1f", Timing.DeviationOfLateness);
+		Output << "frame_lateness_deviation_us: " << Text << "\n";
+	}
+
+	snprintf(Text, sizeof(Text), "PC: %03X  I: %03X  SP: %X  DT: %02X  ST: %02X", mInterpreter->GetRegisterPC(), mInterpreter->GetRegisterI(), mInterpreter->GetRegisterSP(), mInterpreter->GetTimerDT(), mInterpreter->GetTimerST());
+	Output << Text << "\n";
+	Output << "V:";
+	for (unsigned int i = 0; i < 16; ++i)
+	{
+		snprintf(Text, sizeof(Text), " %02X", mInterpreter->GetRegisterVx(i));
+		Output << Text;
+	}
+	Output << "\n";
+
+	if (WithDisplay)
+	{
+		Output << "display: " << mInterpreter->GetResolutionX() << "x" << mInterpreter->GetResolutionY() << "\n";
+		for (unsigned int y = 0; y < mInterpreter->GetResolutionY(); ++y)
+		{
+			std::string Row(mInterpreter->GetResolutionX(), '.');
+			for (unsigned int x = 0; x < mInterpreter->GetResolutionX(); ++x)
+			{
+				if (mInterpreter->GetDisplay(x, y))
+					Row[x] = '#';
+			}
+			Output << Row << "\n";
+		}
+	}
+}
+
+//What static analysis finds in the memory of the machine, from the start of the program, followed by the disassembly.
+void CHIP_8_HEADLESS::WriteAnalysis(std::ostream& Output)
+{
+	CHIP_8_ANALYSIS Analysis(*mInterpreter);
+	Output << "quirks: " << GetQuirksName(Analysis.GetQuirks()) << "\n";
+	Output << "instructions: " << Analysis.GetNumberOfInstructions() << "\n";
+	Output << "code_bytes: " << Analysis.GetNumberOfCodeBytes() << "\n";
+	Output << "blocks: " << Analysis.GetBlocks().size() << "\n";
+	Output << "unrecognized_instructions: " << Analysis.GetNumberOfUnrecognizedInstructions() << "\n";
+	Output << "computed_jumps: " << Analysis.GetComputedJumps().size() << "\n";
+	Output << "memory_writes: " << Analysis.GetWrites().size() << "\n";
+	Output << "overwritable_code_bytes: " << Analysis.GetNumberOfOverwritableCodeBytes() << "\n";
+	Output << "suggested_engine: " << ((Analysis.SuggestEngine() == CHIP_8_ENGINE__JIT) ? "jit" : "threaded") << "\n";
+	Analysis.WriteListing(Output);
+}
+
+//Times saving and restoring the current state. Restores alternate between it and the state one frame later, so they pay for the memory that changed in between,
+//as rewinding would. The machine is left in the state it was in.
+void CHIP_8_HEADLESS::BenchmarkSnapshots(unsigned int Iterations, std::ostream& Output)
+{
+	std::vector<CHIP_8_SNAPSHOT> Snapshots(2);
+	mInterpreter->SaveSnapshot(Snapshots[0]);
+	mInterpreter->RunFrame(mRate.GetPerSecond() / 60);
+	mInterpreter->SaveSnapshot(Snapshots[1]);
+
+	std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < Iterations; ++i)
+	{
+		mInterpreter->SaveSnapshot(Snapshots[i & 1]);
+	}
+	double SaveTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+	Start = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < Iterations; ++i)
+	{
+		mInterpreter->RestoreSnapshot(Snapshots[i & 1]);
+	}
+	double RestoreTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	mInterpreter->RestoreSnapshot(Snapshots[0]);
+
+	char Text[64];
+	Output << "snapshot_bytes: " << Snapshots[0].GetSize() << "\n";
+	snprintf(Text, sizeof(Text), "%.1f", SaveTime * 1e9 / Iterations);
+	Output << "snapshot_save_ns: " << Text << "\n";
+	snprintf(Text, sizeof(Text), "%.1f", RestoreTime * 1e9 / Iterations);
+	Output << "snapshot_restore_ns: " << Text << "\n";
+}
+
+#if CHIP_8_PROFILING == true
+//Writes the profile in the format of the report: the totals, then every operation that ran and the addresses that ran most, most frequent first.
+void CHIP_8_HEADLESS::WriteProfile(std::ostream& Output)
+{
+	const CHIP_8_PROFILE& Profile = mInterpreter->GetProfile();
+	uint64_t Total = 0;
+	for (unsigned int i = 0; i < CHIP_8_OPERATION__NUMBER_OF_OPERATIONS; ++i)
+	{
+		Total += Profile.Operations[i];
+	}
+	double Divisor = (Total != 0) ? static_cast<double>(Total) : 1.0;
+
+	char Text[128];
+	Output << "profiled_instructions: " << Total << "\n";
+	Output << "idle_instructions: " << mInterpreter->GetIdleInstructions() << "\n";
+	Output << "profiled_frames: " << Profile.Frames << "\n";
+	snprintf(Text, sizeof(Text), "%.6f", Profile.Seconds);
+	Output << "execution_seconds: " << Text << "\n";
+	snprintf(Text, sizeof(Text), "%.6f", Profile.DrawSeconds);
+	Output << "draw_seconds: " << Text << "\n";
+	snprintf(Text, sizeof(Text), "%.6f", Profile.Seconds - Profile.DrawSeconds);
+	Output << "other_seconds: " << Text << "\n";
+	snprintf(Text, sizeof(Text), "%.9f", (Profile.Frames != 0) ? (Profile.Seconds / Profile.Frames) : 0.0);
+	Output << "seconds_per_frame: " << Text << "\n";
+	snprintf(Text, sizeof(Text), "%.9f", Profile.LongestFrameSeconds);
+	Output << "longest_frame_seconds: " << Text << "\n";
+
+	Output << "operations:\n";
+	for (unsigned int Operation : SortByCount(Profile.Operations, CHIP_8_OPERATION__NUMBER_OF_OPERATIONS))
+	{
+		snprintf(Text, sizeof(Text), "  %-24s %14llu %7.3f%%", CHIP_8::GetOperationName(static_cast<CHIP_8_OPERATION>(Operation)), static_cast<unsigned long long>(Profile.Operations[Operation]), Profile.Operations[Operation] * 100.0 / Divisor);
+		Output << Text << "\n";
+	}
+
+	Output << "hot_addresses:\n";
+	std::vector<unsigned int> Addresses = SortByCount(Profile.Addresses, CHIP_8_PROFILE::NUMBER_OF_ADDRESSES);
+	if (Addresses.size() > mHOT_ADDRESSES)
+		Addresses.resize(mHOT_ADDRESSES);
+	for (unsigned int Address : Addresses)
+	{
+		snprintf(Text, sizeof(Text), "  %03X  %-24s %14llu %7.3f%%", Address, CHIP_8::GetOperationName(static_cast<CHIP_8_OPERATION>(Profile.AddressOperations[Address])), static_cast<unsigned long long>(Profile.Addresses[Address]), Profile.Addresses[Address] * 100.0 / Divisor);
+		Output << Text << "\n";
+	}
+}
+
+//The same profile as one JSON object, with every address that ran rather than the hottest only. Operation names need no escaping.
+void CHIP_8_HEADLESS::WriteProfileJson(std::ostream& Output)
+{
+	const CHIP_8_PROFILE& Profile = mInterpreter->GetProfile();
+	uint64_t Total = 0;
+	for (unsigned int i = 0; i < CHIP_8_OPERATION__NUMBER_OF_OPERATIONS; ++i)
+	{
+		Total += Profile.Operations[i];
+	}
+
+	char Text[64];
+	Output << "{\n";
+	Output << "  \"profiled_instructions\": " << Total << ",\n";
+	Output << "  \"idle_instructions\": " << mInterpreter->GetIdleInstructions() << ",\n";
+	Output << "  \"profiled_frames\": " << Profile.Frames << ",\n";
+	snprintf(Text, sizeof(Text), "%.9f", Profile.Seconds);
+	Output << "  \"execution_seconds\": " << Text << ",\n";
+	snprintf(Text, sizeof(Text), "%.9f", Profile.DrawSeconds);
+	Output << "  \"draw_seconds\": " << Text << ",\n";
+	snprintf(Text, sizeof(Text), "%.9f", Profile.LongestFrameSeconds);
+	Output << "  \"longest_frame_seconds\": " << Text << ",\n";
+
+	Output << "  \"operations\": [";
+	const char* Separator = "\n";
+	for (unsigned int Operation : SortByCount(Profile.Operations, CHIP_8_OPERATION__NUMBER_OF_OPERATIONS))
+	{
+		Output << Separator << "    { \"operation\": \"" << CHIP_8::GetOperationName(static_cast<CHIP_8_OPERATION>(Operation)) << "\", \"count\": " << Profile.Operations[Operation] << " }";
+		Separator = ",\n";
+	}
+	Output << "\n  ],\n";
+
+	Output << "  \"addresses\": [";
+	Separator = "\n";
+	for (unsigned int Address : SortByCount(Profile.Addresses, CHIP_8_PROFILE::NUMBER_OF_ADDRESSES))
+	{
+		Output << Separator << "    { \"address\": " << Address << ", \"operation\": \"" << CHIP_8::GetOperationName(static_cast<CHIP_8_OPERATION>(Profile.AddressOperations[Address])) << "\", \"count\": " << Profile.Addresses[Address] << " }";
+		Separator = ",\n";
+	}
+	Output << "\n  ]\n";
+	Output << "}\n";
+}
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+#include "Interpreter/CHIP-8.h"
+#include "Interpreter/CHIP-8_Analysis.h"
+#include "Interpreter/CHIP-8_Rewind.h"
+#include "Interpreter/CHIP-8_ROM_Store.h"
+#include "Interpreter/CHIP-8_Trace.h"
+#include "Host/CHIP-8_Host.h"
+#include "Host/CHIP-8_Scheduler.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+//One line of an input script: "<frame> press <button>" or "<frame> release <button>", the button in hexadecimal. Lines starting with '#' are ignored.
+struct CHIP_8_INPUT_EVENT
+{
+	unsigned int Frame;
+	unsigned int Button;
+	bool Pressed;
+};
+
+//Runs the interpreter without any windowing system, paced in 60ths of a second of emulated time like the interface, but as fast as the host allows unless it is
+//told to keep to real time.
+class CHIP_8_HEADLESS
+{
+	private:
+		CHIP_8* mInterpreter;
+		CHIP_8_REWIND* mRewind;
+		CHIP_8_TRACE* mTrace;
+		CHIP_8_FRAME_SCHEDULER* mScheduler;
+		unsigned int mDueFrames;
+		std::vector<CHIP_8_INPUT_EVENT> mInputEvents;
+		size_t mNextInputEvent;
+		CHIP_8_INSTRUCTION_RATE mRate;
+		uint64_t mSeed;
+		unsigned int mFrames;
+		uint64_t mInstructions;
+		double mWallTime;
+		CHIP_8_STOP_REASON mLastStopReason;
+
+		void LoadProgram(const uint8_t*, unsigned int, const CHIP_8_DECODED_INSTRUCTION*);
+		void ApplyInput();
+		void RestartScheduler();
+		unsigned int RunOneFrame(unsigned int);
+
+	public:
+		static const unsigned int mDEFAULT_IPS = 500;
+
+		CHIP_8_HEADLESS(CHIP_8_ENGINE, unsigned int, uint64_t);
+		CHIP_8_HEADLESS(const CHIP_8_HEADLESS&) = delete;
+		CHIP_8_HEADLESS& operator=(const CHIP_8_HEADLESS&) = delete;
+		~CHIP_8_HEADLESS();
+		void LoadProgram(const std::string&);
+		void LoadProgram(CHIP_8_ROM&);
+		void LoadInputScript(const std::string&);
+		void SetQuirks(CHIP_8_QUIRKS);
+		void SetMemoryModel(CHIP_8_MEMORY_MODEL);
+		void LoadState(const std::string&);
+		void SaveState(const std::string&);
+		void EnableRewind(size_t);
+		void RewindFrames(unsigned int);
+		void EnableTrace(const std::string&);
+		void EnableRealTime();
+		void RunFrames(unsigned int);
+		void RunInstructions(uint64_t);
+		CHIP_8& GetInterpreter();
+		unsigned int GetFrames();
+		uint64_t GetInstructions();
+		double GetWallTime();
+		uint64_t GetDisplayHash();
+		void WriteReport(std::ostream&, bool);
+		void WriteAnalysis(std::ostream&);
+		void BenchmarkSnapshots(unsigned int, std::ostream&);
+#if CHIP_8_PROFILING == true
+		static const unsigned int mHOT_ADDRESSES = 20;
+		void WriteProfile(std::ostream&);
+		void WriteProfileJson(std::ostream&);
+#endif
+		static const char* GetStatusName(CHIP_8_ERROR_CODE);
+		static bool IsSuccess(CHIP_8_ERROR_CODE);
+		static const char* GetQuirksName(CHIP_8_QUIRKS);
+		static bool FindQuirks(const std::string&, CHIP_8_QUIRKS&);
+		static const char* GetMemoryModelName(CHIP_8_MEMORY_MODEL);
+		static bool FindMemoryModel(const std::string&, CHIP_8_MEMORY_MODEL&);
+};
@@ -0,0 +1,255 @@
+#include "Interpreter/CHIP-8.h"
+#include "Headless/Headless.h"
+#include "Headless/Farm.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+const char* Usage =
+	"Usage: CHIP-8_Headless <program> [options]\n"
+	"       CHIP-8_Headless --farm <manifest> [--threads N] [--engine NAME] [--memory NAME] [--ips N] [--seed N] [--output FILE]\n"
+	"  --frames N          run N 60ths of a second (default 600)\n"
+	"  --instructions N    run whole frames until N instructions have been executed\n"
+	"  --ips N             instructions per second (default 500)\n"
+	"  --engine NAME       switch, threaded or jit (default switch)\n"
+	"  --seed N            seed of the random number generator (default 0)\n"
+	"  --quirks NAME       default, cosmac-vip, super-chip or xo-chip (default default)\n"
+	"  --memory NAME       strict, which stops on out of bounds accesses, or wrapped, which masks addresses to memory without checking them (default strict)\n"
+	"  --input FILE        input script, lines of \"<frame> press|release <button>\"\n"
+	"  --output FILE       write the report to FILE instead of the standard output\n"
+	"  --no-display        leave the framebuffer out of the report\n"
+	"  --load-state FILE   continue from a snapshot saved with --save-state instead of from the start of the program\n"
+	"  --save-state FILE   save a snapshot of the machine at the end of the run\n"
+	"  --rewind BYTES      record every frame into a rewind history of at most BYTES and add its size to the report\n"
+	"  --rewind-back N     step back N frames through the rewind history at the end of the run\n"
+	"  --snapshot-benchmark N  time N snapshots and N restores at the end of the run and add the cost to the report\n"
+	"  --realtime          run the frames at their time, 60 a second, instead of as fast as possible, and add how late they started to the report\n"
+	"  --trace FILE        record every executed instruction into FILE, which CHIP-8_Trace reads\n"
+	"  --analyze           write what static analysis finds in the program and its disassembly instead of running it\n"
+	"  --profile FILE      write the execution profile to FILE; needs a build with CHIP_8_PROFILING defined as true\n"
+	"  --profile-json FILE write the execution profile to FILE as JSON; needs the same build\n"
+	"  --farm FILE         run every \"<program> <quirks> <input script or -> <frames>\" line of FILE, one result line per job\n"
+	"  --threads N         threads for --farm (default: one per hardware thread)\n";
+
+int main(int argc, char* argv[])
+{
+	std::string Program;
+	std::string InputScript;
+	std::string OutputFile;
+	std::string Manifest;
+	std::string LoadStateFile;
+	std::string SaveStateFile;
+	std::string TraceFile;
+	std::string ProfileFile;
+	std::string ProfileJsonFile;
+	unsigned int SnapshotIterations = 0;
+	unsigned long long RewindBudget = 0;
+	unsigned int RewindFrames = 0;
+	unsigned int NumberOfThreads = std::thread::hardware_concurrency();
+	unsigned int Frames = 600;
+	unsigned long long Instructions = 0;
+	unsigned int InstructionsPerSecond = CHIP_8_HEADLESS::mDEFAULT_IPS;
+	unsigned long long Seed = 0;
+	CHIP_8_ENGINE Engine = CHIP_8_ENGINE__SWITCH;
+	CHIP_8_QUIRKS Quirks = CHIP_8_QUIRKS__DEFAULT;
+	CHIP_8_MEMORY_MODEL MemoryModel = CHIP_8_MEMORY_MODEL__STRICT;
+	bool WithDisplay = true;
+	bool Analyze = false;
+	bool RealTime = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* Argument = argv[i];
+		bool HasValue = (i + 1) < argc;
+		if (!strcmp(Argument, "--frames") && HasValue)
+			Frames = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+		else if (!strcmp(Argument, "--instructions") && HasValue)
+			Instructions = strtoull(argv[++i], nullptr, 10);
+		else if (!strcmp(Argument, "--ips") && HasValue)
+			InstructionsPerSecond = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+		else if (!strcmp(Argument, "--engine") && HasValue)
+		{
+			const char* Name = argv[++i];
+			if (!strcmp(Name, "switch"))
+				Engine = CHIP_8_ENGINE__SWITCH;
+			else if (!strcmp(Name, "threaded"))
+				Engine = CHIP_8_ENGINE__THREADED;
+			else if (!strcmp(Name, "jit"))
+				Engine = CHIP_8_ENGINE__JIT;
+			else
+			{
+				std::cerr << "Unknown engine \"" << Name << "\".\n" << Usage;
+				return 1;
+			}
+		}
+		else if (!strcmp(Argument, "--quirks") && HasValue)
+		{
+			const char* Name = argv[++i];
+			if (!CHIP_8_HEADLESS::FindQuirks(Name, Quirks))
+			{
+				std::cerr << "Unknown quirk profile \"" << Name << "\".\n" << Usage;
+				return 1;
+			}
+		}
+		else if (!strcmp(Argument, "--memory") && HasValue)
+		{
+			const char* Name = argv[++i];
+			if (!CHIP_8_HEADLESS::FindMemoryModel(Name, MemoryModel))
+			{
+				std::cerr << "Unknown memory model \"" << Name << "\".\n" << Usage;
+				return 1;
+			}
+		}
+		else if (!strcmp(Argument, "--seed") && HasValue)
+			Seed = strtoull(argv[++i], nullptr, 10);
+		else if (!strcmp(Argument, "--input") && HasValue)
+			InputScript = argv[++i];
+		else if (!strcmp(Argument, "--output") && HasValue)
+			OutputFile = argv[++i];
+		else if (!strcmp(Argument, "--farm") && HasValue)
+			Manifest = argv[++i];
+		else if (!strcmp(Argument, "--threads") && HasValue)
+			NumberOfThreads = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+		else if (!strcmp(Argument, "--load-state") && HasValue)
+			LoadStateFile = argv[++i];
+		else if (!strcmp(Argument, "--save-state") && HasValue)
+			SaveStateFile = argv[++i];
+		else if (!strcmp(Argument, "--rewind") && HasValue)
+			RewindBudget = strtoull(argv[++i], nullptr, 10);
+		else if (!strcmp(Argument, "--rewind-back") && HasValue)
+			RewindFrames = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+		else if (!strcmp(Argument, "--snapshot-benchmark") && HasValue)
+			SnapshotIterations = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+		else if (!strcmp(Argument, "--trace") && HasValue)
+			TraceFile = argv[++i];
+		else if (!strcmp(Argument, "--profile") && HasValue)
+			ProfileFile = argv[++i];
+		else if (!strcmp(Argument, "--profile-json") && HasValue)
+			ProfileJsonFile = argv[++i];
+		else if (!strcmp(Argument, "--no-display"))
+			WithDisplay = false;
+		else if (!strcmp(Argument, "--analyze"))
+			Analyze = true;
+		else if (!strcmp(Argument, "--realtime"))
+			RealTime = true;
+		else if ((Argument[0] != '-') && Program.empty())
+			Program = Argument;
+		else
+		{
+			std::cerr << Usage;
+			return 1;
+		}
+	}
+	if (Program.empty() == Manifest.empty())
+	{
+		std::cerr << Usage;
+		return 1;
+	}
+#if CHIP_8_PROFILING == false
+	if (!ProfileFile.empty() || !ProfileJsonFile.empty())
+	{
+		std::cerr << "This build has no profiler; build with CHIP_8_PROFILING defined as true.\n";
+		return 1;
+	}
+#endif
+
+	try
+	{
+		if (!Manifest.empty())
+		{
+			CHIP_8_FARM Farm(Engine, InstructionsPerSecond, Seed);
+			Farm.SetMemoryModel(MemoryModel);
+			Farm.LoadManifest(Manifest);
+			unsigned int FailedJobs;
+			if (OutputFile.empty())
+				FailedJobs = Farm.Run(NumberOfThreads, std::cout);
+			else
+			{
+				std::ofstream Output(OutputFile);
+				if (!Output)
+					throw(std::runtime_error("Could not open output file \"" + OutputFile + "\"."));
+				FailedJobs = Farm.Run(NumberOfThreads, Output);
+			}
+			return (FailedJobs == 0) ? 0 : 2;
+		}
+
+		CHIP_8_HEADLESS Runner(Engine, InstructionsPerSecond, Seed);
+		Runner.SetQuirks(Quirks);
+		Runner.SetMemoryModel(MemoryModel);
+		if (RewindBudget != 0)
+			Runner.EnableRewind(static_cast<size_t>(RewindBudget));
+		if (!TraceFile.empty())
+			Runner.EnableTrace(TraceFile);
+		if (RealTime)
+			Runner.EnableRealTime();
+		Runner.LoadProgram(Program);
+		if (!InputScript.empty())
+			Runner.LoadInputScript(InputScript);
+		if (!LoadStateFile.empty())
+			Runner.LoadState(LoadStateFile);
+		if (Analyze)
+		{
+			if (OutputFile.empty())
+				Runner.WriteAnalysis(std::cout);
+			else
+			{
+				std::ofstream Output(OutputFile);
+				if (!Output)
+					throw(std::runtime_error("Could not open output file \"" + OutputFile + "\"."));
+				Runner.WriteAnalysis(Output);
+			}
+			return 0;
+		}
+
+		if (Instructions != 0)
+			Runner.RunInstructions(Instructions);
+		else
+			Runner.RunFrames(Frames);
+		if (RewindFrames != 0)
+			Runner.RewindFrames(RewindFrames);
+
+		if (!SaveStateFile.empty())
+			Runner.SaveState(SaveStateFile);
+#if CHIP_8_PROFILING == true
+		if (!ProfileFile.empty())
+		{
+			std::ofstream Profile(ProfileFile);
+			if (!Profile)
+				throw(std::runtime_error("Could not open profile file \"" + ProfileFile + "\"."));
+			Runner.WriteProfile(Profile);
+		}
+		if (!ProfileJsonFile.empty())
+		{
+			std::ofstream Profile(ProfileJsonFile);
+			if (!Profile)
+				throw(std::runtime_error("Could not open profile file \"" + ProfileJsonFile + "\"."));
+			Runner.WriteProfileJson(Profile);
+		}
+#endif
+
+		std::ofstream File;
+		std::ostream* Output = &std::cout;
+		if (!OutputFile.empty())
+		{
+			File.open(OutputFile);
+			if (!File)
+				throw(std::runtime_error("Could not open output file \"" + OutputFile + "\"."));
+			Output = &File;
+		}
+		Runner.WriteReport(*Output, WithDisplay);
+		if (SnapshotIterations != 0)
+			Runner.BenchmarkSnapshots(SnapshotIterations, *Output);
+
+		return CHIP_8_HEADLESS::IsSuccess(Runner.GetInterpreter().GetStatus()) ? 0 : 2;
+	}
+	catch (const std::exception& Error)
+	{
+		std::cerr << Error.what() << "\n";
+		return 1;
+	}
+}
@@ -0,0 +1,110 @@
+#include "Host/CHIP-8_Frame.h"
+
+#include <cstring>
+
+//Copies what the machine shows now. Number, Program and StopReason are left to the caller, which knows them.
+void CHIP_8_FRAME::Capture(CHIP_8& Machine)
+{
+	for (unsigned int Plane = 0; Plane < CHIP_8::NUMBER_OF_PLANES; ++Plane)
+	{
+		memcpy(Display[Plane], Machine.GetDisplayRows(Plane), sizeof(Display[Plane]));
+	}
+	ResolutionX = static_cast<uint16_t>(Machine.GetResolutionX());
+	ResolutionY = static_cast<uint16_t>(Machine.GetResolutionY());
+	NumberOfPlanes = static_cast<uint8_t>(Machine.GetNumberOfPlanes());
+	Sound = Machine.GetSound();
+	WaitingForKey = Machine.IsWaitingForKey();
+	Status = Machine.GetStatus();
+}
+
+//Whether the pixel is set on any plane, as CHIP_8::GetDisplay tells it.
+bool CHIP_8_FRAME::IsSet(unsigned int PositionX, unsigned int PositionY) const
+{
+	if ((PositionX >= ResolutionX) || (PositionY >= ResolutionY))
+		return false;
+	uint64_t Word = 0;
+	for (unsigned int Plane = 0; Plane < CHIP_8::NUMBER_OF_PLANES; ++Plane)
+	{
+		Word |= Display[Plane][PositionY][PositionX / 64];
+	}
+	return (Word >> (63 - (PositionX % 64))) & 1;
+}
+
+//Bit y is set when row y shows differently than in the other frame, which is every row when the resolution changed. Lets a front end that may skip frames redraw
+//only what changed since the frame it drew last.
+uint64_t CHIP_8_FRAME::GetRowsChangedSince(const CHIP_8_FRAME& Previous) const
+{
+	if ((ResolutionX != Previous.ResolutionX) || (ResolutionY != Previous.ResolutionY))
+		return (ResolutionY < 64) ? ((1ull << ResolutionY) - 1) : ~0ull;
+	uint64_t Changed = 0;
+	for (unsigned int y = 0; y < ResolutionY; ++y)
+	{
+		for (unsigned int w = 0; w < CHIP_8::DISPLAY_WORDS; ++w)
+		{
+			uint64_t Word = 0, PreviousWord = 0;
+			for (unsigned int Plane = 0; Plane < CHIP_8::NUMBER_OF_PLANES; ++Plane)
+			{
+				Word |= Display[Plane][y][w];
+				PreviousWord |= Previous.Display[Plane][y][w];
+			}
+			if (Word != PreviousWord)
+				Changed |= 1ull << y;
+		}
+	}
+	return Changed;
+}
+
+//FNV-1a over the packed display rows of the frame's mode, plane after plane, for comparing final frames without storing them.
+uint64_t CHIP_8_FRAME::GetHash() const
+{
+	unsigned int Words = ResolutionX / 64;
+	uint64_t Hash = 0xCBF29CE484222325ull;
+	for (unsigned int Plane = 0; Plane < NumberOfPlanes; ++Plane)
+	{
+		for (unsigned int y = 0; y < ResolutionY; ++y)
+		{
+			for (unsigned int w = 0; w < Words; ++w)
+			{
+				uint64_t Word = Display[Plane][y][w];
+				for (unsigned int i = 0; i < 8; ++i)
+				{
+					Hash ^= (Word >> (i * 8)) & 0xFF;
+					Hash *= 0x100000001B3ull;
+				}
+			}
+		}
+	}
+	return Hash;
+}
+
+CHIP_8_FRAME_BUFFER::CHIP_8_FRAME_BUFFER() : mFrames{}, mBack{ 0 }, mMiddle{ 1 }, mFront{ 2 }
+{
+}
+
+//The frame to fill before the next Publish. Only the thread making frames may call it.
+CHIP_8_FRAME& CHIP_8_FRAME_BUFFER::GetBackFrame()
+{
+	return mFrames[mBack];
+}
+
+//Makes the back frame the latest one and carries on in the frame it replaces. The release pairs with the acquire in Acquire, so the shower sees the frame whole.
+void CHIP_8_FRAME_BUFFER::Publish()
+{
+	mBack = mMiddle.exchange(mBack | mFRESH, std::memory_order_acq_rel) & mINDEX;
+}
+
+//The latest frame published, or null when there is none since the last call. It stays valid and unchanged until the next call; only the thread showing frames may
+//call it.
+const CHIP_8_FRAME* CHIP_8_FRAME_BUFFER::Acquire()
+{
+	if (!(mMiddle.load(std::memory_order_relaxed) & mFRESH))
+		return nullptr;
+	mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) & mINDEX;
+	return &mFrames[mFront];
+}
+
+//The frame Acquire returned last, or a blank one before any.
+const CHIP_8_FRAME& CHIP_8_FRAME_BUFFER::GetFrontFrame()
+{
+	return mFrames[mFront];
+}
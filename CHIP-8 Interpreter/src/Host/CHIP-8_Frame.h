@@ -0,0 +1,52 @@
+#pragma once
+#include "Interpreter/CHIP-8.h"
+
+#include <atomic>
+#include <cstdint>
+
+//What the machine shows at the end of a frame: the packed rows of every plane, laid out as CHIP_8 keeps them, with what the front end needs besides to present it.
+struct CHIP_8_FRAME
+{
+	uint64_t Display[CHIP_8::NUMBER_OF_PLANES][CHIP_8::RESOLUTION_Y][CHIP_8::DISPLAY_WORDS];
+	//Frames run since the program was loaded.
+	uint64_t Number;
+	//Counts the programs loaded, so frames of the one before can be told apart.
+	uint32_t Program;
+	uint16_t ResolutionX;
+	uint16_t ResolutionY;
+	uint8_t NumberOfPlanes;
+	bool Sound;
+	bool WaitingForKey;
+	CHIP_8_ERROR_CODE Status;
+	CHIP_8_STOP_REASON StopReason;
+
+	void Capture(CHIP_8&);
+	bool IsSet(unsigned int, unsigned int) const;
+	uint64_t GetRowsChangedSince(const CHIP_8_FRAME&) const;
+	uint64_t GetHash() const;
+};
+
+//Hands frames from one thread that makes them to one that shows them, neither ever waiting for the other. Of its three frames the maker fills one while the shower
+//reads another; the third holds the last frame published and is swapped, atomically, with the maker's when it publishes and with the shower's when it acquires.
+//Frames published while the shower is busy replace each other, so it always gets the latest one.
+class CHIP_8_FRAME_BUFFER
+{
+	private:
+		static const unsigned int mINDEX = 0x3;
+		//Set on the middle index when it holds a frame the shower has not acquired yet.
+		static const unsigned int mFRESH = 0x4;
+
+		CHIP_8_FRAME mFrames[3];
+		unsigned int mBack;
+		std::atomic<unsigned int> mMiddle;
+		unsigned int mFront;
+
+	public:
+		CHIP_8_FRAME_BUFFER();
+		CHIP_8_FRAME_BUFFER(const CHIP_8_FRAME_BUFFER&) = delete;
+		CHIP_8_FRAME_BUFFER& operator=(const CHIP_8_FRAME_BUFFER&) = delete;
+		CHIP_8_FRAME& GetBackFrame();
+		void Publish();
+		const CHIP_8_FRAME* Acquire();
+		const CHIP_8_FRAME& GetFrontFrame();
+};
@@ -0,0 +1,189 @@
+#include "Host/CHIP-8_Host.h"
+
+CHIP_8_INSTRUCTION_RATE::CHIP_8_INSTRUCTION_RATE(unsigned int PerSecond) : mPerSecond{ PerSecond }, mRemainder{ 0 }
+{
+}
+
+//Takes effect from the next frame on; the remainder carried so far is kept.
+void CHIP_8_INSTRUCTION_RATE::SetPerSecond(unsigned int PerSecond)
+{
+	mPerSecond = PerSecond;
+}
+
+unsigned int CHIP_8_INSTRUCTION_RATE::GetPerSecond()
+{
+	return mPerSecond;
+}
+
+//Drops the remainder, as at the start of a program.
+void CHIP_8_INSTRUCTION_RATE::Reset()
+{
+	mRemainder = 0;
+}
+
+//The instructions of the next frame.
+unsigned int CHIP_8_INSTRUCTION_RATE::NextFrame()
+{
+	mRemainder += mPerSecond;
+	unsigned int Instructions = mRemainder / 60;
+	mRemainder %= 60;
+	return Instructions;
+}
+
+//The thread is started last, once everything it uses is set up.
+CHIP_8_HOST::CHIP_8_HOST(CHIP_8_ENGINE Engine, unsigned int InstructionsPerSecond) : mRate(InstructionsPerSecond), mScheduler(60, mMAX_FRAMES_PER_RUN), mFrameNumber{ 0 }, mLoadedPrograms{ 0 }, mRequestedPrograms{ 0 }, mTiming{}, mStopping{ false }
+{
+	mInterpreter = new CHIP_8(Engine);
+	mThread = std::thread(&CHIP_8_HOST::Emulate, this);
+}
+
+CHIP_8_HOST::~CHIP_8_HOST()
+{
+	{
+		std::lock_guard<std::mutex> Guard(mLock);
+		mStopping = true;
+	}
+	mWake.notify_one();
+	mThread.join();
+	delete mInterpreter;
+}
+
+void CHIP_8_HOST::Post(COMMAND_KIND Kind, unsigned int Value, std::shared_ptr<CHIP_8_ROM> ROM)
+{
+	{
+		std::lock_guard<std::mutex> Guard(mLock);
+		mCommands.push_back(COMMAND{ Kind, Value, std::move(ROM) });
+	}
+	mWake.notify_one();
+}
+
+//Starts the program over from the next frame, under the quirk profile its analysis suggests.
+void CHIP_8_HOST::LoadProgram(std::shared_ptr<CHIP_8_ROM> ROM)
+{
+	CHIP_8_QUIRKS Profile = ROM->GetQuirks();
+	LoadProgram(std::move(ROM), Profile);
+}
+
+//Starts the program over from the next frame, under the given quirk profile. Frames of the program before are still published until then; IsCurrent tells them apart.
+void CHIP_8_HOST::LoadProgram(std::shared_ptr<CHIP_8_ROM> ROM, CHIP_8_QUIRKS Profile)
+{
+	++mRequestedPrograms;
+	Post(COMMAND_KIND__LOAD_PROGRAM, Profile, std::move(ROM));
+}
+
+void CHIP_8_HOST::PressButton(unsigned int Button)
+{
+	Post(COMMAND_KIND__PRESS_BUTTON, Button, nullptr);
+}
+
+void CHIP_8_HOST::UnpressButton(unsigned int Button)
+{
+	Post(COMMAND_KIND__UNPRESS_BUTTON, Button, nullptr);
+}
+
+void CHIP_8_HOST::SetInstructionsPerSecond(unsigned int InstructionsPerSecond)
+{
+	Post(COMMAND_KIND__SET_SPEED, InstructionsPerSecond, nullptr);
+}
+
+//The latest frame, or null when none was published since the last call. It stays unchanged until the next call.
+const CHIP_8_FRAME* CHIP_8_HOST::AcquireFrame()
+{
+	return mFrames.Acquire();
+}
+
+//The frame AcquireFrame returned last.
+const CHIP_8_FRAME& CHIP_8_HOST::GetFrame()
+{
+	return mFrames.GetFrontFrame();
+}
+
+//Whether the frame is of the program loaded last, rather than of one it replaced.
+bool CHIP_8_HOST::IsCurrent(const CHIP_8_FRAME& Frame)
+{
+	return Frame.Program == mRequestedPrograms;
+}
+
+//How late the emulation thread has woken for its frames so far.
+CHIP_8_FRAME_TIMING CHIP_8_HOST::GetTiming()
+{
+	std::lock_guard<std::mutex> Guard(mLock);
+	return mTiming;
+}
+
+//A loaded program starts its frame clock anew, so it does not catch up on the time spent before.
+void CHIP_8_HOST::Execute(const COMMAND& Command)
+{
+	switch (Command.Kind)
+	{
+		case COMMAND_KIND__LOAD_PROGRAM:
+			mInterpreter->SetQuirks(static_cast<CHIP_8_QUIRKS>(Command.Value));
+			Command.ROM->LoadInto(*mInterpreter);
+			++mLoadedPrograms;
+			mRate.Reset();
+			mFrameNumber = 0;
+			mScheduler.Restart();
+			break;
+		case COMMAND_KIND__PRESS_BUTTON:
+			mInterpreter->PressButton(Command.Value);
+			break;
+		case COMMAND_KIND__UNPRESS_BUTTON:
+			mInterpreter->UnpressButton(Command.Value);
+			break;
+		case COMMAND_KIND__SET_SPEED:
+			mRate.SetPerSecond(Command.Value);
+			break;
+	}
+}
+
+//Runs the frames, stopping at an error as the machine would only stop again, and publishes the last one.
+void CHIP_8_HOST::RunFrames(unsigned int NumberOfFrames)
+{
+	CHIP_8_STOP_REASON StopReason = CHIP_8_STOP_REASON__BUDGET_EXHAUSTED;
+	for (unsigned int i = 0; i < NumberOfFrames; ++i)
+	{
+		StopReason = mInterpreter->RunFrame(mRate.NextFrame());
+		++mFrameNumber;
+		if (StopReason == CHIP_8_STOP_REASON__ERROR)
+			break;
+	}
+
+	CHIP_8_FRAME& Frame = mFrames.GetBackFrame();
+	Frame.Capture(*mInterpreter);
+	Frame.Number = mFrameNumber;
+	Frame.Program = mLoadedPrograms;
+	Frame.StopReason = StopReason;
+	mFrames.Publish();
+}
+
+//Body of the emulation thread: sleeps until the scheduler's next deadline or a command comes in, and runs the frames due, at most mMAX_FRAMES_PER_RUN of them.
+//Commands are carried out, and frames run, with the lock released, so the front end never waits for the machine.
+void CHIP_8_HOST::Emulate()
+{
+	std::unique_lock<std::mutex> Lock(mLock);
+	while (!mStopping)
+	{
+		mWake.wait_until(Lock, mScheduler.GetNextDeadline(), [this] { return mStopping || !mCommands.empty(); });
+		if (mStopping)
+			break;
+		if (!mCommands.empty())
+		{
+			std::deque<COMMAND> Commands;
+			Commands.swap(mCommands);
+			Lock.unlock();
+			for (const COMMAND& Command : Commands)
+			{
+				Execute(Command);
+			}
+			Lock.lock();
+			continue;
+		}
+
+		Lock.unlock();
+		unsigned int Due = mScheduler.TakeDueFrames();
+		if (Due != 0)
+			RunFrames(Due);
+		Lock.lock();
+		mTiming = mScheduler.GetTiming();
+	}
+}
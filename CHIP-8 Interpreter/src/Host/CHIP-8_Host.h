@@ -0,0 +1,85 @@
+#pragma once
+#include "Interpreter/CHIP-8.h"
+#include "Interpreter/CHIP-8_ROM_Store.h"
+#include "Host/CHIP-8_Frame.h"
+#include "Host/CHIP-8_Scheduler.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+//Splits a number of instructions per second over frames of a 60th of a second, carrying what does not divide evenly over to the next frames.
+class CHIP_8_INSTRUCTION_RATE
+{
+	private:
+		unsigned int mPerSecond;
+		unsigned int mRemainder;
+
+	public:
+		CHIP_8_INSTRUCTION_RATE(unsigned int);
+		void SetPerSecond(unsigned int);
+		unsigned int GetPerSecond();
+		void Reset();
+		unsigned int NextFrame();
+};
+
+//Runs a machine on a thread of its own, 60 frames a second of the host's clock, sleeping between frames, and publishes every run's last frame through a frame buffer. The front end calls
+//in from its own thread: what it asks for is queued and carried out by the emulation thread before its next frame, and it takes the latest frame when it is ready
+//to show one, so slow presenting never delays the machine and a busy machine never delays presenting. When the machine falls more than mMAX_FRAMES_PER_RUN frames
+//behind, as after the host was suspended, the frames in between are dropped instead of being caught up.
+class CHIP_8_HOST
+{
+	private:
+		enum COMMAND_KIND { COMMAND_KIND__LOAD_PROGRAM, COMMAND_KIND__PRESS_BUTTON, COMMAND_KIND__UNPRESS_BUTTON, COMMAND_KIND__SET_SPEED };
+
+		struct COMMAND
+		{
+			COMMAND_KIND Kind;
+			//The button, the instructions per second, or the quirk profile of the program to load.
+			unsigned int Value;
+			std::shared_ptr<CHIP_8_ROM> ROM;
+		};
+
+		//Only touched by the emulation thread.
+		CHIP_8* mInterpreter;
+		CHIP_8_INSTRUCTION_RATE mRate;
+		CHIP_8_FRAME_SCHEDULER mScheduler;
+		uint64_t mFrameNumber;
+		uint32_t mLoadedPrograms;
+
+		//Only touched by the front end.
+		uint32_t mRequestedPrograms;
+
+		CHIP_8_FRAME_BUFFER mFrames;
+		std::mutex mLock;
+		std::condition_variable mWake;
+		std::deque<COMMAND> mCommands;
+		CHIP_8_FRAME_TIMING mTiming;
+		bool mStopping;
+		std::thread mThread;
+
+		void Post(COMMAND_KIND, unsigned int, std::shared_ptr<CHIP_8_ROM>);
+		void Execute(const COMMAND&);
+		void RunFrames(unsigned int);
+		void Emulate();
+
+	public:
+		static const unsigned int mMAX_FRAMES_PER_RUN = 4;
+
+		CHIP_8_HOST(CHIP_8_ENGINE, unsigned int);
+		CHIP_8_HOST(const CHIP_8_HOST&) = delete;
+		CHIP_8_HOST& operator=(const CHIP_8_HOST&) = delete;
+		~CHIP_8_HOST();
+		void LoadProgram(std::shared_ptr<CHIP_8_ROM>);
+		void LoadProgram(std::shared_ptr<CHIP_8_ROM>, CHIP_8_QUIRKS);
+		void PressButton(unsigned int);
+		void UnpressButton(unsigned int);
+		void SetInstructionsPerSecond(unsigned int);
+		const CHIP_8_FRAME* AcquireFrame();
+		const CHIP_8_FRAME& GetFrame();
+		bool IsCurrent(const CHIP_8_FRAME&);
+		CHIP_8_FRAME_TIMING GetTiming();
+};
@@ -0,0 +1,88 @@
+#include "Host/CHIP-8_Scheduler.h"
+
+#include <cmath>
+#include <thread>
+
+CHIP_8_FRAME_SCHEDULER::CHIP_8_FRAME_SCHEDULER(unsigned int FramesPerSecond, unsigned int MaxFramesBehind) : mFramesPerSecond{ FramesPerSecond }, mMaxFramesBehind{ MaxFramesBehind }, mFrames{ 0 }
+{
+	mStart = CLOCK::now();
+	ResetTiming();
+}
+
+//Starts the clock anew from now, as when a program is loaded, so the time before is not caught up on. The timing is kept.
+void CHIP_8_FRAME_SCHEDULER::Restart()
+{
+	mStart = CLOCK::now();
+	mFrames = 0;
+}
+
+//Rounded up to the nanosecond, so a frame is always due at its deadline.
+CHIP_8_FRAME_SCHEDULER::CLOCK::time_point CHIP_8_FRAME_SCHEDULER::GetNextDeadline()
+{
+	return mStart + std::chrono::nanoseconds(((mFrames + 1) * 1000000000ull + mFramesPerSecond - 1) / mFramesPerSecond);
+}
+
+//The number of frames due now, which are then counted as run; none before the next deadline.
+unsigned int CHIP_8_FRAME_SCHEDULER::TakeDueFrames()
+{
+	CLOCK::time_point Now = CLOCK::now();
+	CLOCK::time_point Deadline = GetNextDeadline();
+	if (Now < Deadline)
+		return 0;
+
+	double Lateness = std::chrono::duration<double, std::micro>(Now - Deadline).count();
+	++mWakeups;
+	mLatenessSum += Lateness;
+	mLatenessSquaresSum += Lateness * Lateness;
+	if (Lateness > mMaxLateness)
+		mMaxLateness = Lateness;
+
+	uint64_t Elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Now - mStart).count());
+	uint64_t Due = ((Elapsed * mFramesPerSecond) / 1000000000ull) - mFrames;
+	if (Due > mMaxFramesBehind)
+	{
+		mDroppedFrames += Due - mMaxFramesBehind;
+		Due = mMaxFramesBehind;
+		mStart = Now;
+		mFrames = 0;
+	}
+	else
+		mFrames += Due;
+	mTotalFrames += Due;
+	return static_cast<unsigned int>(Due);
+}
+
+//Sleeps until frames are due and takes them, for a caller with nothing else to wait for.
+unsigned int CHIP_8_FRAME_SCHEDULER::WaitForFrames()
+{
+	for (;;)
+	{
+		std::this_thread::sleep_until(GetNextDeadline());
+		unsigned int Due = TakeDueFrames();
+		if (Due != 0)
+			return Due;
+	}
+}
+
+CHIP_8_FRAME_TIMING CHIP_8_FRAME_SCHEDULER::GetTiming()
+{
+	CHIP_8_FRAME_TIMING Timing;
+	Timing.Frames = mTotalFrames;
+	Timing.Wakeups = mWakeups;
+	Timing.DroppedFrames = mDroppedFrames;
+	Timing.MeanLateness = (mWakeups != 0) ? (mLatenessSum / mWakeups) : 0;
+	Timing.MaxLateness = mMaxLateness;
+	double Variance = (mWakeups != 0) ? ((mLatenessSquaresSum / mWakeups) - (Timing.MeanLateness * Timing.MeanLateness)) : 0;
+	Timing.DeviationOfLateness = (Variance > 0) ? std::sqrt(Variance) : 0;
+	return Timing;
+}
+
+void CHIP_8_FRAME_SCHEDULER::ResetTiming()
+{
+	mTotalFrames = 0;
+	mWakeups = 0;
+	mDroppedFrames = 0;
+	mLatenessSum = 0;
+	mLatenessSquaresSum = 0;
+	mMaxLateness = 0;
+}
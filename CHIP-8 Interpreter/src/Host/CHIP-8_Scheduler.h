@@ -0,0 +1,49 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+//How well a scheduler kept to its deadlines. Lateness is how long after the deadline of the next frame the scheduler found it due, in microseconds; it is measured
+//once per wakeup, however many frames were due then.
+struct CHIP_8_FRAME_TIMING
+{
+	uint64_t Frames;
+	uint64_t Wakeups;
+	//Frames left out when the clock was started anew, far behind.
+	uint64_t DroppedFrames;
+	double MeanLateness;
+	double MaxLateness;
+	double DeviationOfLateness;
+};
+
+//Paces frames at a fixed rate of the host's steady clock, for a caller that sleeps until GetNextDeadline and then takes the frames due. The deadlines are absolute,
+//the nth frame being due n frames' time after the start, so a late wakeup or a slow frame delays the frames after it only until the next deadline, and the rate
+//does not drift with the time lost. When more than the given number of frames are due at once, as after the host was suspended, the frames in between are dropped
+//and the clock starts anew.
+class CHIP_8_FRAME_SCHEDULER
+{
+	public:
+		typedef std::chrono::steady_clock CLOCK;
+
+	private:
+		unsigned int mFramesPerSecond;
+		unsigned int mMaxFramesBehind;
+		CLOCK::time_point mStart;
+		//Frames taken since mStart.
+		uint64_t mFrames;
+
+		uint64_t mTotalFrames;
+		uint64_t mWakeups;
+		uint64_t mDroppedFrames;
+		double mLatenessSum;
+		double mLatenessSquaresSum;
+		double mMaxLateness;
+
+	public:
+		CHIP_8_FRAME_SCHEDULER(unsigned int, unsigned int);
+		void Restart();
+		CLOCK::time_point GetNextDeadline();
+		unsigned int TakeDueFrames();
+		unsigned int WaitForFrames();
+		CHIP_8_FRAME_TIMING GetTiming();
+		void ResetTiming();
+};
@@ -9,10 +9,6 @@
 
 void CHIP_8_INTERFACE::Reset()
 {
-	mMainClockStart.QuadPart = 0;;
-	mMainClockStop.QuadPart = 0;;
-	mTimerStart.QuadPart = 0;
-	mTimerStop.QuadPart = 0;
 	StopSound();
 	mError = false;
 }
@@ -28,16 +24,7 @@ void CHIP_8_INTERFACE::HandleError(CHIP_8_ERROR_CODE Error)
 				if (!mStartupMessage)
 				{
 					std::wstring Text = L"This is a CHIP-8 language interpreter.\nDrag and drop a program file to load.\nUse the + and - keys to change Instructions Per Second.\n\n";
-#if INCORRECT_SHIFT_INSTRUCTIONS_VERSION == true
-					Text += L"This version of the interpreter implements the binary shift instructions according to changed, popular definitions. Programs expecting the original definitions may not work correctly.\n\n ";
-#else
-					Text += L"This version of the interpreter implements the binary shift instructions according to the original definitions. Programs expecting later, changed definitions may not work correctly.\n\n ";
-#endif
-#if INCORRECT_MEMORY_INSTRUCTIONS_VERSION == true
-					Text += L"This version of the interpreter implements the memory store and load instructions according to changed, popular definitions. Programs expecting the original definitions may not work correctly.\n\n ";
-#else
-					Text += L"This version of the interpreter implements the memory store and load instructions according to the original definitions. Programs expecting later, changed definitions may not work correctly.\n\n ";
-#endif
+					Text += L"This interpreter implements the binary shift and the memory store and load instructions according to the original definitions. Programs expecting later, changed definitions may not work correctly.\n\n ";
 					Text += L"Key bindings:\n0 :  0\n1 :  1\n2 :  2 ,  Up Arrow\n3 :  3\n4 :  4 ,  Left Arrow\n5 :  5 ,  Space Bar\n6 :  6 ,  Right Arrow\n7 :  7\n8 :  8\n9 :  9\nA :  A\nB :  B ,  Down Arrow\nC :  C\nD :  D\nE :  E\nF :  F";
 					MessageBox(mWindow, Text.c_str(), L"CHIP-8 Interpreter", 0);
 					mStartupMessage = true;
@@ -80,6 +67,12 @@ void CHIP_8_INTERFACE::HandleError(CHIP_8_ERROR_CODE Error)
 				mError = true;
 				break;
 			}
+			case CHIP_8_ERROR_CODE__PROGRAM_EXITED:
+			{
+				MessageBox(mWindow, L"Program has exited.", L"CHIP-8 Interpreter", 0);
+				mError = true;
+				break;
+			}
 		}
 	}
 }
@@ -88,20 +81,21 @@ void CHIP_8_INTERFACE::LoadProgram(wchar_t* Filename)
 {
 	Reset();
 
-	HANDLE File;
-	if ((File = CreateFile(Filename, GENERIC_READ, 0, 0, OPEN_EXISTING, 0, 0)) != INVALID_HANDLE_VALUE)
+	//The store takes UTF-8 names. A program dropped again unchanged is neither read nor decoded again, nor analyzed again for the quirk profile it runs under.
+	int Length = WideCharToMultiByte(CP_UTF8, 0, Filename, -1, nullptr, 0, nullptr, nullptr);
+	if (Length > 0)
 	{
-		LARGE_INTEGER Size;
-		GetFileSizeEx(File, &Size);
-		LPVOID Buffer = new char[Size.LowPart];
-		if (ReadFile(File, Buffer, Size.LowPart, 0, 0))
-			mInterpreter->LoadProgram((char*)Buffer, static_cast<unsigned int>(Size.LowPart));
-		delete[] Buffer;
-		CloseHandle(File);
+		std::string Name(Length, '\0');
+		WideCharToMultiByte(CP_UTF8, 0, Filename, -1, &Name[0], Length, nullptr, nullptr);
+		Name.resize(Length - 1);
+		try
+		{
+			mHost->LoadProgram(mROMStore.Open(Name));
+		}
+		catch (const std::exception&)
+		{
+		}
 	}
-
-	QueryPerformanceCounter(&mMainClockStart);
-	QueryPerformanceCounter(&mTimerStart);
 }
 
 bool LoadBeepWave(unsigned char*& BeepWave)
@@ -131,14 +125,11 @@ bool LoadBeepWave(unsigned char*& BeepWave)
 
 CHIP_8_INTERFACE::CHIP_8_INTERFACE(HWND Window, HDC InnerContext, HBRUSH PixelUnset, HBRUSH PixelSet) : mWindow{ Window }, mInnerContext{ InnerContext }, mPixelUnset{ PixelUnset }, mPixelSet{ PixelSet }
 {
-	mInterpreter = new CHIP_8;
-
 	mNuberOfInstructionsPerSecond = mDEFAULT_IPS;
+	mHost = new CHIP_8_HOST(CHIP_8_ENGINE__SWITCH, mNuberOfInstructionsPerSecond);
+	mShownFrame = mHost->GetFrame();
 	UpdateSpeed();
 
-	QueryPerformanceFrequency(&mOne60thOfSecond);
-	mOne60thOfSecond.QuadPart /= 60;
-
 	if (!LoadBeepWave(BeepWave))
 		throw(std::runtime_error("Could not find resource."));
 
@@ -148,7 +139,7 @@ CHIP_8_INTERFACE::CHIP_8_INTERFACE(HWND Window, HDC InnerContext, HBRUSH PixelUn
 
 CHIP_8_INTERFACE::~CHIP_8_INTERFACE()
 {
-	delete mInterpreter;
+	delete mHost;
 }
 
 void CHIP_8_INTERFACE::DropFile(WPARAM hDrop)
@@ -171,66 +162,66 @@ void CHIP_8_INTERFACE::PressButton(WPARAM Button)
 	{
 		case VK_NUMPAD0:
 		case 0x30:
-			mInterpreter->PressButton(0x0);
+			mHost->PressButton(0x0);
 			break;
 		case VK_NUMPAD1:
 		case 0x31:
-			mInterpreter->PressButton(0x1);
+			mHost->PressButton(0x1);
 			break;
 		case VK_NUMPAD2:
 		case 0x32:
 		case VK_UP:
-			mInterpreter->PressButton(0x2);
+			mHost->PressButton(0x2);
 			break;
 		case VK_NUMPAD3:
 		case 0x33:
-			mInterpreter->PressButton(0x3);
+			mHost->PressButton(0x3);
 			break;
 		case VK_NUMPAD4:
 		case 0x34:
 		case VK_LEFT:
-			mInterpreter->PressButton(0x4);
+			mHost->PressButton(0x4);
 			break;
 		case VK_NUMPAD5:
 		case 0x35:
 		case VK_SPACE:
-			mInterpreter->PressButton(0x5);
+			mHost->PressButton(0x5);
 			break;
 		case VK_NUMPAD6:
 		case 0x36:
 		case VK_RIGHT:
-			mInterpreter->PressButton(0x6);
+			mHost->PressButton(0x6);
 			break;
 		case VK_NUMPAD7:
 		case 0x37:
-			mInterpreter->PressButton(0x7);
+			mHost->PressButton(0x7);
 			break;
 		case VK_NUMPAD8:
 		case 0x38:
 		case VK_DOWN:
-			mInterpreter->PressButton(0x8);
+			mHost->PressButton(0x8);
 			break;
 		case VK_NUMPAD9:
 		case 0x39:
-			mInterpreter->PressButton(0x9);
+			mHost->PressButton(0x9);
 			break;
 		case 'A':
-			mInterpreter->PressButton(0xA);
+			mHost->PressButton(0xA);
 			break;
 		case 'B':
-			mInterpreter->PressButton(0xB);
+			mHost->PressButton(0xB);
 			break;
 		case 'C':
-			mInterpreter->PressButton(0xC);
+			mHost->PressButton(0xC);
 			break;
 		case 'D':
-			mInterpreter->PressButton(0xD);
+			mHost->PressButton(0xD);
 			break;
 		case 'E':
-			mInterpreter->PressButton(0xE);
+			mHost->PressButton(0xE);
 			break;
 		case 'F':
-			mInterpreter->PressButton(0xF);
+			mHost->PressButton(0xF);
 			break;
 		case VK_ESCAPE:
 			SendMessage(mWindow, WM_CLOSE, 0, 0);
@@ -252,66 +243,66 @@ void CHIP_8_INTERFACE::UnpressButton(WPARAM Button)
 	{
 		case VK_NUMPAD0:
 		case 0x30:
-			mInterpreter->UnpressButton(0x0);
+			mHost->UnpressButton(0x0);
 			break;
 		case VK_NUMPAD1:
 		case 0x31:
-			mInterpreter->UnpressButton(0x1);
+			mHost->UnpressButton(0x1);
 			break;
 		case VK_NUMPAD2:
 		case 0x32:
 		case VK_UP:
-			mInterpreter->UnpressButton(0x2);
+			mHost->UnpressButton(0x2);
 			break;
 		case VK_NUMPAD3:
 		case 0x33:
-			mInterpreter->UnpressButton(0x3);
+			mHost->UnpressButton(0x3);
 			break;
 		case VK_NUMPAD4:
 		case 0x34:
 		case VK_LEFT:
-			mInterpreter->UnpressButton(0x4);
+			mHost->UnpressButton(0x4);
 			break;
 		case VK_NUMPAD5:
 		case 0x35:
 		case VK_SPACE:
-			mInterpreter->UnpressButton(0x5);
+			mHost->UnpressButton(0x5);
 			break;
 		case VK_NUMPAD6:
 		case 0x36:
 		case VK_RIGHT:
-			mInterpreter->UnpressButton(0x6);
+			mHost->UnpressButton(0x6);
 			break;
 		case VK_NUMPAD7:
 		case 0x37:
-			mInterpreter->UnpressButton(0x7);
+			mHost->UnpressButton(0x7);
 			break;
 		case VK_NUMPAD8:
 		case 0x38:
 		case VK_DOWN:
-			mInterpreter->UnpressButton(0x8);
+			mHost->UnpressButton(0x8);
 			break;
 		case VK_NUMPAD9:
 		case 0x39:
-			mInterpreter->UnpressButton(0x9);
+			mHost->UnpressButton(0x9);
 			break;
 		case 'A':
-			mInterpreter->UnpressButton(0xA);
+			mHost->UnpressButton(0xA);
 			break;
 		case 'B':
-			mInterpreter->UnpressButton(0xB);
+			mHost->UnpressButton(0xB);
 			break;
 		case 'C':
-			mInterpreter->UnpressButton(0xC);
+			mHost->UnpressButton(0xC);
 			break;
 		case 'D':
-			mInterpreter->UnpressButton(0xD);
+			mHost->UnpressButton(0xD);
 			break;
 		case 'E':
-			mInterpreter->UnpressButton(0xE);
+			mHost->UnpressButton(0xE);
 			break;
 		case 'F':
-			mInterpreter->UnpressButton(0xF);
+			mHost->UnpressButton(0xF);
 			break;
 	}
 }
@@ -330,8 +321,6 @@ void CHIP_8_INTERFACE::StopSound()
 
 void CHIP_8_INTERFACE::UpdateSpeed()
 {
-	QueryPerformanceFrequency(&mMainClockFrequency);
-	mMainClockFrequency.QuadPart /= mNuberOfInstructionsPerSecond;
 	std::wstring Caption = L"CHIP-8 Interpreter   IPS: " + std::to_wstring(mNuberOfInstructionsPerSecond);
 	SetWindowText(mWindow, Caption.c_str());
 }
@@ -341,6 +330,7 @@ void CHIP_8_INTERFACE::IncreaseSpeed()
 	if (mNuberOfInstructionsPerSecond < mMAX_IPS)
 	{
 		mNuberOfInstructionsPerSecond += 100;
+		mHost->SetInstructionsPerSecond(mNuberOfInstructionsPerSecond);
 		UpdateSpeed();
 	}
 }
@@ -350,30 +340,23 @@ void CHIP_8_INTERFACE::DecreaseSpeed()
 	if (mNuberOfInstructionsPerSecond > mMIN_IPS)
 	{
 		mNuberOfInstructionsPerSecond -= 100;
+		mHost->SetInstructionsPerSecond(mNuberOfInstructionsPerSecond);
 		UpdateSpeed();
 	}
 }
 
-void CHIP_8_INTERFACE::Run()
+//Shows the latest frame the emulation thread published, if there is a new one, without ever waiting for it. Only the rows that differ from the frame shown before
+//are drawn again, as frames published in between may have been skipped.
+void CHIP_8_INTERFACE::Present()
 {
-	QueryPerformanceCounter(&mMainClockStop);
-	if (mMainClockStop.QuadPart - mMainClockStart.QuadPart < mMainClockFrequency.QuadPart)
+	const CHIP_8_FRAME* Frame = mHost->AcquireFrame();
+	if ((Frame == nullptr) || !mHost->IsCurrent(*Frame))
 		return;
-	mMainClockStart.QuadPart = mMainClockStop.QuadPart;
-
-	QueryPerformanceCounter(&mTimerStop);
-	LARGE_INTEGER TimerDelta;
-	TimerDelta.QuadPart = mTimerStop.QuadPart - mTimerStart.QuadPart;
-	TimerDelta.QuadPart /= mOne60thOfSecond.QuadPart;
-
-	CHIP_8_ERROR_CODE Result;
-	if (Result = mInterpreter->Step(static_cast <unsigned int>(TimerDelta.QuadPart)))
-		HandleError(Result);
 
-	if (TimerDelta.QuadPart > 0)
-		mTimerStart.QuadPart = mTimerStop.QuadPart;
+	if (Frame->StopReason == CHIP_8_STOP_REASON__ERROR)
+		HandleError(Frame->Status);
 
-	if (mInterpreter->GetSound())
+	if (Frame->Sound)
 	{
 		if (!mSoundPlaying)
 		{
@@ -388,49 +371,47 @@ void CHIP_8_INTERFACE::Run()
 		}
 	}
 
-	if (mInterpreter->DidDrawingHappen())
+	//The inner context has the size of the high resolution mode; in the low resolution mode every pixel covers Scale by Scale of it.
+	//Pixels set on any of the XO-CHIP's planes are drawn in the one colour.
+	uint64_t DamagedRows = Frame->GetRowsChangedSince(mShownFrame);
+	if (DamagedRows != 0)
 	{
-		RECT Rect = { 0, 0, mInterpreter->RESOLUTION_X, mInterpreter->RESOLUTION_Y };
-		FillRect(mInnerContext, &Rect, mPixelUnset);
-
-		bool Drawing = false;
-		for (unsigned int y = 0; y < mInterpreter->RESOLUTION_Y; ++y)
+		const uint64_t LEFTMOST_PIXEL = 1ull << 63;
+		const unsigned int Scale = CHIP_8::RESOLUTION_X / Frame->ResolutionX;
+		const unsigned int Words = Frame->ResolutionX / 64;
+		for (unsigned int y = 0; y < Frame->ResolutionY; ++y)
 		{
-			for (unsigned int x = 0; x <= mInterpreter->RESOLUTION_X; ++x)
+			if (!(DamagedRows & (1ull << y)))
+				continue;
+			RECT Rect = { 0, static_cast<LONG>(y * Scale), CHIP_8::RESOLUTION_X, static_cast<LONG>((y + 1) * Scale) };
+			FillRect(mInnerContext, &Rect, mPixelUnset);
+
+			for (unsigned int w = 0; w < Words; ++w)
 			{
-				if (x == mInterpreter->RESOLUTION_X)
+				uint64_t Row = 0;
+				for (unsigned int Plane = 0; Plane < CHIP_8::NUMBER_OF_PLANES; ++Plane)
 				{
-					if (Drawing)
-					{
-						Rect.right = x;
-						Rect.bottom = Rect.top + 1;
-						FillRect(mInnerContext, &Rect, mPixelSet);
-						Drawing = false;
-					}
+					Row |= Frame->Display[Plane][y][w];
 				}
-				else
+				unsigned int x = w * 64;
+				while (Row != 0)
 				{
-					if (Drawing)
+					while (!(Row & LEFTMOST_PIXEL))
 					{
-						if (!mInterpreter->GetDisplay(x, y))
-						{
-							Rect.right = x;
-							Rect.bottom = Rect.top + 1;
-							FillRect(mInnerContext, &Rect, mPixelSet);
-							Drawing = false;
-						}
+						Row <<= 1;
+						++x;
 					}
-					else
+					Rect.left = x * Scale;
+					while (Row & LEFTMOST_PIXEL)
 					{
-						if (mInterpreter->GetDisplay(x, y))
-						{
-							Rect.left = x;
-							Rect.top = y;
-							Drawing = true;
-						}
+						Row <<= 1;
+						++x;
 					}
+					Rect.right = x * Scale;
+					FillRect(mInnerContext, &Rect, mPixelSet);
 				}
 			}
 		}
 	}
+	mShownFrame = *Frame;
 }
\ No newline at end of file
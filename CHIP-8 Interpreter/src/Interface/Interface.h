@@ -1,11 +1,15 @@
 #pragma once
 #include "Interpreter\CHIP-8.h"
+#include "Interpreter\CHIP-8_ROM_Store.h"
+#include "Host\CHIP-8_Host.h"
 #include "Interface\Windows_include.h"
 
 class CHIP_8_INTERFACE
 {
 private:
-	CHIP_8* mInterpreter;
+	CHIP_8_ROM_STORE mROMStore;
+	CHIP_8_HOST* mHost;
+	CHIP_8_FRAME mShownFrame;
 	HWND mWindow;
 	HDC mInnerContext;
 	HBRUSH mPixelUnset;
@@ -14,12 +18,6 @@ private:
 	static const unsigned int mMAX_IPS = 2000;
 	static const unsigned int mMIN_IPS = 100;
 	unsigned int mNuberOfInstructionsPerSecond;
-	LARGE_INTEGER mMainClockFrequency;
-	LARGE_INTEGER mMainClockStart;
-	LARGE_INTEGER mMainClockStop;
-	LARGE_INTEGER mOne60thOfSecond;
-	LARGE_INTEGER mTimerStart;
-	LARGE_INTEGER mTimerStop;
 	bool mSoundPlaying;
 	bool mStartupMessage;
 	bool mError;
@@ -40,5 +38,5 @@ public:
 	void UpdateSpeed();
 	void IncreaseSpeed();
 	void DecreaseSpeed();
-	void Run();
+	void Present();
 };
\ No newline at end of file
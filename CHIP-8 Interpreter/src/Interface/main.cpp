@@ -2,12 +2,14 @@
 #include "Interpreter\CHIP-8.h"
 #include "Interface\Interface.h"
 #include "Interface\Windows_include.h"
+#include "Host\CHIP-8_Scheduler.h"
 
+#include <Mmsystem.h>
 #include <shellapi.h>
 
 CHIP_8_INTERFACE* Interface = nullptr;
 
-const int RefreshRate = 30;
+const int RefreshRate = 60;
 
 const RECT InnerContextSize = { 0, 0, CHIP_8::RESOLUTION_X, CHIP_8::RESOLUTION_Y };
 HDC InnerContext = NULL;
@@ -80,11 +82,6 @@ LRESULT WINAPI EventProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam)
 
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR lpCmdLine, int nShowCmd)
 {
-	LARGE_INTEGER Frequency;
-	if (!QueryPerformanceFrequency(&Frequency)) return 0;
-	LARGE_INTEGER Tick, Start, Stop;
-	Tick.QuadPart = Frequency.QuadPart / RefreshRate;
-
 	HWND WindowHandle;
 	WNDCLASSEX WindowClass;
 	TCHAR WindowClassName[] = L"CHIP_8_2020.01.11";
@@ -101,7 +98,7 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR lpCmdLine, int nShowC
 
 	if (!RegisterClassEx(&WindowClass)) return 0;
 
-	RECT WindowRect = {0, 0, CHIP_8::RESOLUTION_X * 10, CHIP_8::RESOLUTION_Y * 10};
+	RECT WindowRect = {0, 0, CHIP_8::RESOLUTION_X * 5, CHIP_8::RESOLUTION_Y * 5};
 	if (0 == AdjustWindowRectEx(&WindowRect, WS_CAPTION | WS_SYSMENU | WS_THICKFRAME | WS_MINIMIZEBOX | WS_MAXIMIZEBOX, true, WS_EX_ACCEPTFILES))
 	{
 		WindowRect.left = CW_USEDEFAULT;
@@ -123,23 +120,34 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR lpCmdLine, int nShowC
 
 	MSG Msg;
 
-	QueryPerformanceCounter(&Start);
+	//Sleeps are as long as asked, not rounded up to the default 15.6 ms tick, so both threads wake on time for their frames.
+	timeBeginPeriod(1);
+	//The machine runs on its own thread, so this one only has messages to handle and frames to show. It sleeps until either is due, and the scheduler's absolute
+	//deadlines keep refreshes at the rate however late each wakeup is.
+	CHIP_8_FRAME_SCHEDULER Refresh(RefreshRate, 1);
 	for (;;)
 	{
-		if (PeekMessage(&Msg, NULL, 0, 0, PM_REMOVE))
+		long long Wait = std::chrono::duration_cast<std::chrono::milliseconds>(Refresh.GetNextDeadline() - CHIP_8_FRAME_SCHEDULER::CLOCK::now() + std::chrono::microseconds(999)).count();
+		MsgWaitForMultipleObjectsEx(0, NULL, (Wait > 0) ? static_cast<DWORD>(Wait) : 0, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+		bool Quit = false;
+		while (PeekMessage(&Msg, NULL, 0, 0, PM_REMOVE))
 		{
-			if (Msg.message == WM_QUIT) break;
+			if (Msg.message == WM_QUIT)
+			{
+				Quit = true;
+				break;
+			}
 			DispatchMessage(&Msg);
 		}
-		if (Interface)
-			Interface->Run();
-		QueryPerformanceCounter(&Stop);
-		if (Stop.QuadPart - Start.QuadPart >= Tick.QuadPart)
+		if (Quit) break;
+		if (Refresh.TakeDueFrames() != 0)
 		{
+			if (Interface)
+				Interface->Present();
 			InvalidateRect(WindowHandle, NULL, false);
-			Start = Stop;
 		}
 	}
+	timeEndPeriod(1);
 
 	DeleteObject(PixelUnset);
 	DeleteObject(PixelSet);
@@ -1,7 +1,14 @@
-﻿#include <cstdlib>
+﻿#include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <ctime>
+#include <type_traits>
+#if CHIP_8_PROFILING == true
+#include <chrono>
+#endif
 
-#include "Interpreter\CHIP-8.h"
+#include "Interpreter/CHIP-8.h"
+#include "Interpreter/CHIP-8_Trace.h"
 
 const uint8_t CHIP_8::Font[NUMBER_OF_FONT_SPRITES][SIZE_OF_FONT_SPRITES] =
 {
@@ -23,23 +30,224 @@ const uint8_t CHIP_8::Font[NUMBER_OF_FONT_SPRITES][SIZE_OF_FONT_SPRITES] =
 	{ 0xF0, 0x80, 0xF0, 0x80, 0x80}       /* "F" sprite*/
 };
 
- CHIP_8::CHIP_8()
+//The SUPER-CHIP's 8x10 digits for Fx30. It only had "0" to "9"; "A" to "F" are the ones later interpreters added.
+const uint8_t CHIP_8::BigFont[NUMBER_OF_FONT_SPRITES][SIZE_OF_BIG_FONT_SPRITES] =
+{
+	{ 0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF },     /* "0" sprite*/
+	{ 0x18, 0x78, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF },     /* "1" sprite*/
+	{ 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF },     /* "2" sprite*/
+	{ 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF },     /* "3" sprite*/
+	{ 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03 },     /* "4" sprite*/
+	{ 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF },     /* "5" sprite*/
+	{ 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF },     /* "6" sprite*/
+	{ 0xFF, 0xFF, 0x03, 0x03, 0x06, 0x0C, 0x18, 0x18, 0x18, 0x18 },     /* "7" sprite*/
+	{ 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF },     /* "8" sprite*/
+	{ 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF },     /* "9" sprite*/
+	{ 0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3 },     /* "A" sprite*/
+	{ 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC },     /* "B" sprite*/
+	{ 0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C },     /* "C" sprite*/
+	{ 0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC },     /* "D" sprite*/
+	{ 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF },     /* "E" sprite*/
+	{ 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0 }      /* "F" sprite*/
+};
+
+//Instructions the SUPER-CHIP added, which profiles without them do not recognize.
+//The handler is variadic for the commas of its template arguments.
+#define SUPER_CHIP_HANDLER(Profile, ...) (CHIP_8_QUIRK_POLICY<Profile>::SUPER_CHIP_INSTRUCTIONS ? &CHIP_8::__VA_ARGS__ : &CHIP_8::Instruction_NotRecognized)
+
+//Instructions the XO-CHIP added on top of the SUPER-CHIP's.
+#define XO_CHIP_HANDLER(Profile, ...) (CHIP_8_QUIRK_POLICY<Profile>::XO_CHIP_INSTRUCTIONS ? &CHIP_8::__VA_ARGS__ : &CHIP_8::Instruction_NotRecognized)
+
+//One row of InstructionHandlers, with the quirk-dependent handlers instantiated for the given profile and every handler that moves PC or touches memory for the given
+//memory model.
+#define INSTRUCTION_HANDLERS(Profile, Model) \
+	{ \
+		&CHIP_8::Instruction_NotRecognized,     /* never dispatched, decoded first*/ \
+		&CHIP_8::Instruction_NotRecognized,                                          \
+		&CHIP_8::Instruction_0nnn__SYS_addr,                                         \
+		SUPER_CHIP_HANDLER(Profile, Instruction_00Cn__SCD_nibble<Model>),            \
+		XO_CHIP_HANDLER(Profile, Instruction_00Dn__SCU_nibble<Model>),               \
+		&CHIP_8::Instruction_00E0__CLS<Model>,                                       \
+		&CHIP_8::Instruction_00EE__RET<Model>,                                       \
+		SUPER_CHIP_HANDLER(Profile, Instruction_00FB__SCR<Model>),                   \
+		SUPER_CHIP_HANDLER(Profile, Instruction_00FC__SCL<Model>),                   \
+		SUPER_CHIP_HANDLER(Profile, Instruction_00FD__EXIT),                         \
+		SUPER_CHIP_HANDLER(Profile, Instruction_00FE__LOW<Model>),                   \
+		SUPER_CHIP_HANDLER(Profile, Instruction_00FF__HIGH<Model>),                  \
+		&CHIP_8::Instruction_1nnn__JP_addr,                                          \
+		&CHIP_8::Instruction_2nnn__CALL_addr,                                        \
+		&CHIP_8::Instruction_3xnn__SE_Vx_byte<Profile, Model>,                       \
+		&CHIP_8::Instruction_4xnn__SNE_Vx_byte<Profile, Model>,                      \
+		&CHIP_8::Instruction_5xy0__SE_Vx_Vy<Profile, Model>,                         \
+		XO_CHIP_HANDLER(Profile, Instruction_5xy2__LD_I_Vx_Vy<Profile, Model>),      \
+		XO_CHIP_HANDLER(Profile, Instruction_5xy3__LD_Vx_Vy_I<Profile, Model>),      \
+		&CHIP_8::Instruction_6xnn__LD_Vx_byte<Model>,                                \
+		&CHIP_8::Instruction_7xnn__ADD_Vx_byte<Model>,                               \
+		&CHIP_8::Instruction_8xy0__LD_Vx_Vy<Model>,                                  \
+		&CHIP_8::Instruction_8xy1__OR_Vx_Vy<Profile, Model>,                         \
+		&CHIP_8::Instruction_8xy2__AND_Vx_Vy<Profile, Model>,                        \
+		&CHIP_8::Instruction_8xy3__XOR_Vx_Vy<Profile, Model>,                        \
+		&CHIP_8::Instruction_8xy4__ADD_Vx_Vy<Model>,                                 \
+		&CHIP_8::Instruction_8xy5__SUB_Vx_Vy<Model>,                                 \
+		&CHIP_8::Instruction_8xy6__SHR_Vx_Vy<Profile, Model>,                        \
+		&CHIP_8::Instruction_8xy7__SUBN_Vx_Vy<Model>,                                \
+		&CHIP_8::Instruction_8xyE__SHL_Vx_Vy<Profile, Model>,                        \
+		&CHIP_8::Instruction_9xy0__SNE_Vx_Vy<Profile, Model>,                        \
+		&CHIP_8::Instruction_Annn__LD_I_addr<Model>,                                 \
+		&CHIP_8::Instruction_Bnnn__JP_V0_addr<Profile, Model>,                       \
+		&CHIP_8::Instruction_Cxnn__RND_Vx_byte<Model>,                               \
+		&CHIP_8::Instruction_Dxyn__DRW_Vx_Vy_nibble<Profile, Model>,                 \
+		&CHIP_8::Instruction_Ex9E__SKP_Vx<Profile, Model>,                           \
+		&CHIP_8::Instruction_ExA1__SKNP_Vx<Profile, Model>,                          \
+		XO_CHIP_HANDLER(Profile, Instruction_F000__LD_I_long<Model>),                \
+		XO_CHIP_HANDLER(Profile, Instruction_Fn01__PLANE_n<Model>),                  \
+		XO_CHIP_HANDLER(Profile, Instruction_F002__AUDIO<Profile, Model>),           \
+		&CHIP_8::Instruction_Fx07__LD_Vx_DT<Model>,                                  \
+		&CHIP_8::Instruction_Fx0A__LD_Vx_K<Model>,                                   \
+		&CHIP_8::Instruction_Fx15__LD_DT_Vx<Model>,                                  \
+		&CHIP_8::Instruction_Fx18__LD_ST_Vx<Model>,                                  \
+		&CHIP_8::Instruction_Fx1E__ADD_I_Vx<Model>,                                  \
+		&CHIP_8::Instruction_Fx29__LD_F_Vx<Model>,                                   \
+		SUPER_CHIP_HANDLER(Profile, Instruction_Fx30__LD_HF_Vx<Model>),              \
+		&CHIP_8::Instruction_Fx33__LD_B_Vx<Profile, Model>,                          \
+		XO_CHIP_HANDLER(Profile, Instruction_Fx3A__PITCH_Vx<Model>),                 \
+		&CHIP_8::Instruction_Fx55__LD_I_Vx<Profile, Model>,                          \
+		&CHIP_8::Instruction_Fx65__LD_Vx_I<Profile, Model>,                          \
+		SUPER_CHIP_HANDLER(Profile, Instruction_Fx75__LD_R_Vx<Model>),               \
+		SUPER_CHIP_HANDLER(Profile, Instruction_Fx85__LD_Vx_R<Model>)                \
+	}
+
+const CHIP_8::INSTRUCTION_HANDLER CHIP_8::InstructionHandlers[CHIP_8_MEMORY_MODEL__NUMBER_OF_MODELS][CHIP_8_QUIRKS__NUMBER_OF_PROFILES][CHIP_8_OPERATION__NUMBER_OF_OPERATIONS] =
+{
+	{
+		INSTRUCTION_HANDLERS(CHIP_8_QUIRKS__DEFAULT, CHIP_8_MEMORY_MODEL__STRICT),
+		INSTRUCTION_HANDLERS(CHIP_8_QUIRKS__COSMAC_VIP, CHIP_8_MEMORY_MODEL__STRICT),
+		INSTRUCTION_HANDLERS(CHIP_8_QUIRKS__SUPER_CHIP, CHIP_8_MEMORY_MODEL__STRICT),
+		INSTRUCTION_HANDLERS(CHIP_8_QUIRKS__XO_CHIP, CHIP_8_MEMORY_MODEL__STRICT)
+	},
+	{
+		INSTRUCTION_HANDLERS(CHIP_8_QUIRKS__DEFAULT, CHIP_8_MEMORY_MODEL__WRAPPED),
+		INSTRUCTION_HANDLERS(CHIP_8_QUIRKS__COSMAC_VIP, CHIP_8_MEMORY_MODEL__WRAPPED),
+		INSTRUCTION_HANDLERS(CHIP_8_QUIRKS__SUPER_CHIP, CHIP_8_MEMORY_MODEL__WRAPPED),
+		INSTRUCTION_HANDLERS(CHIP_8_QUIRKS__XO_CHIP, CHIP_8_MEMORY_MODEL__WRAPPED)
+	}
+};
+
+//Policy values needed by code that is not instantiated per profile.
+static const unsigned int MemorySizes[CHIP_8_QUIRKS__NUMBER_OF_PROFILES] =
+{
+	CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__DEFAULT>::MEMORY_SIZE,
+	CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__COSMAC_VIP>::MEMORY_SIZE,
+	CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__SUPER_CHIP>::MEMORY_SIZE,
+	CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__XO_CHIP>::MEMORY_SIZE
+};
+
+static const bool XoChipProfiles[CHIP_8_QUIRKS__NUMBER_OF_PROFILES] =
+{
+	CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__DEFAULT>::XO_CHIP_INSTRUCTIONS,
+	CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__COSMAC_VIP>::XO_CHIP_INSTRUCTIONS,
+	CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__SUPER_CHIP>::XO_CHIP_INSTRUCTIONS,
+	CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__XO_CHIP>::XO_CHIP_INSTRUCTIONS
+};
+
+//In the order of CHIP_8_OPERATION.
+static const char* const OperationNames[CHIP_8_OPERATION__NUMBER_OF_OPERATIONS] =
+{
+	"not decoded",
+	"not recognized",
+	"0nnn SYS addr",
+	"00Cn SCD nibble",
+	"00Dn SCU nibble",
+	"00E0 CLS",
+	"00EE RET",
+	"00FB SCR",
+	"00FC SCL",
+	"00FD EXIT",
+	"00FE LOW",
+	"00FF HIGH",
+	"1nnn JP addr",
+	"2nnn CALL addr",
+	"3xnn SE Vx, byte",
+	"4xnn SNE Vx, byte",
+	"5xy0 SE Vx, Vy",
+	"5xy2 LD I, Vx, Vy",
+	"5xy3 LD Vx, Vy, I",
+	"6xnn LD Vx, byte",
+	"7xnn ADD Vx, byte",
+	"8xy0 LD Vx, Vy",
+	"8xy1 OR Vx, Vy",
+	"8xy2 AND Vx, Vy",
+	"8xy3 XOR Vx, Vy",
+	"8xy4 ADD Vx, Vy",
+	"8xy5 SUB Vx, Vy",
+	"8xy6 SHR Vx, Vy",
+	"8xy7 SUBN Vx, Vy",
+	"8xyE SHL Vx, Vy",
+	"9xy0 SNE Vx, Vy",
+	"Annn LD I, addr",
+	"Bnnn JP V0, addr",
+	"Cxnn RND Vx, byte",
+	"Dxyn DRW Vx, Vy, nibble",
+	"Ex9E SKP Vx",
+	"ExA1 SKNP Vx",
+	"F000 LD I, long",
+	"Fn01 PLANE n",
+	"F002 AUDIO",
+	"Fx07 LD Vx, DT",
+	"Fx0A LD Vx, K",
+	"Fx15 LD DT, Vx",
+	"Fx18 LD ST, Vx",
+	"Fx1E ADD I, Vx",
+	"Fx29 LD F, Vx",
+	"Fx30 LD HF, Vx",
+	"Fx33 LD B, Vx",
+	"Fx3A PITCH Vx",
+	"Fx55 LD I, Vx",
+	"Fx65 LD Vx, I",
+	"Fx75 LD R, Vx",
+	"Fx85 LD Vx, R"
+};
+
+#if CHIP_8_PROFILING == true
+//Adds the host time from its construction to its destruction to a total.
+class CHIP_8_PROFILE_TIMER
+{
+	private:
+		std::chrono::steady_clock::time_point mStart;
+		double& mTotal;
+	public:
+		CHIP_8_PROFILE_TIMER(double& Total) : mStart{ std::chrono::steady_clock::now() }, mTotal{ Total }
+		{
+		}
+		~CHIP_8_PROFILE_TIMER()
+		{
+			mTotal += std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+		}
+};
+#endif
+
+ CHIP_8::CHIP_8(CHIP_8_ENGINE SelectedEngine) : Engine{ SelectedEngine }, Quirks{ CHIP_8_QUIRKS__DEFAULT }, MemoryModel{ CHIP_8_MEMORY_MODEL__STRICT }, Trace{ nullptr }, Memory{}, RandomSeed{ static_cast<uint64_t>(time(0)) }, Display{}, HighResolution{ false }, DamagedRows{ 0 }, JitBlocks{ nullptr }, JitCoverage{ nullptr }, JitCode{ nullptr }, JitCodeUsed{ 0 }
  {
+	 Handlers = InstructionHandlers[MemoryModel][Quirks];
 	 Reset();
  }
 
+ CHIP_8::~CHIP_8()
+ {
+	 StopJit();
+ }
+
 void CHIP_8::Reset()
 {
-	for (unsigned int i = 0; i < MEMORY_SIZE; ++i)
-	{
-		Memory[i] = 0;
-	}
+	memset(Memory, 0, MemorySizes[Quirks]);
 	for (unsigned int i = 0; i < STACK_SIZE; ++i)
 	{
 		Stack[i] = 0;
 	}
 
 	LoadFonts();
+	InvalidateDecodedInstructions();
+	FlushJit();
 
 	for (unsigned int i = 0; i < NUMBER_OF_GENERAL_REGISTERS; ++i)
 	{
@@ -47,6 +255,10 @@ void CHIP_8::Reset()
 	}
 
 	Register_I = 0;
+	for (unsigned int i = 0; i < NUMBER_OF_GENERAL_REGISTERS; ++i)
+	{
+		Register_RPL[i] = 0;
+	}
 
 	Register_PC = 0;
 	Register_SP = 0;
@@ -54,6 +266,12 @@ void CHIP_8::Reset()
 	Timer_DT = 0;
 	Timer_ST = 0;
 	SoundEmitted = false;
+	//Until a program loads its own pattern, the sound is a square wave of 500 Hz, near enough to the buzzer of the other machines.
+	for (unsigned int i = 0; i < AUDIO_PATTERN_SIZE; ++i)
+	{
+		AudioPattern[i] = 0xF0;
+	}
+	Pitch = 64;
 
 	for (unsigned int i = 0; i < NUMBER_OF_BUTTONS; ++i)
 	{
@@ -61,11 +279,21 @@ void CHIP_8::Reset()
 	}
 	ButtonHeld = false;
 	HeldButton = 0;
+	WaitingForKey = false;
 
 	DrawingHappened = false;
-	ClearDisplay();
+	Planes = 1;
+	SetResolution(false);
 
-	srand(static_cast<unsigned int>(time(0)));
+	SetSeed(RandomSeed);
+
+	StopReason = CHIP_8_STOP_REASON__BUDGET_EXHAUSTED;
+	ExecutedInstructions = 0;
+	IdleLoopLength = 1;
+	IdleInstructions = 0;
+#if CHIP_8_PROFILING == true
+	ClearProfile();
+#endif
 
 	CurrentStatus = CHIP_8_ERROR_CODE__RESET;
 }
@@ -78,12 +306,20 @@ void CHIP_8::LoadFonts()
 		{
 			Memory[FONT_AREA_START_ADDRESS + (i * SIZE_OF_FONT_SPRITES) + j] = Font[i][j];
 		}
+		for (unsigned int j = 0; j < SIZE_OF_BIG_FONT_SPRITES; ++j)
+		{
+			Memory[BIG_FONT_AREA_START_ADDRESS + (i * SIZE_OF_BIG_FONT_SPRITES) + j] = BigFont[i][j];
+		}
 	}
 }
 
+//In the wrapped memory model PC runs on from the end of the code area to its start, so it is always within the area and every fetch can read both bytes.
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::AdvanceProgramCounter()
 {
-	if (Register_PC < (MEMORY_SIZE - 2))
+	if (Model == CHIP_8_MEMORY_MODEL__WRAPPED)
+		Register_PC = (Register_PC + 2) & (MEMORY_SIZE - 1);
+	else if (Register_PC < (MEMORY_SIZE - 2))
 	{
 		Register_PC += 2;
 	}
@@ -113,9 +349,17 @@ void CHIP_8::PopStack()
 		CurrentStatus = CHIP_8_ERROR_CODE__STACK_UNDERFLOW;
 }
 
+//A 64 KB memory needs no check, I being 16 bits wide; addresses past the end wrap around, as on the XO-CHIP. The wrapped memory model makes every profile's memory
+//behave so, I being masked to its size where it is used.
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 bool CHIP_8::IsMemoryAccessSafe()
 {
-	if (Register_I >= MEMORY_SIZE)
+	if (Model == CHIP_8_MEMORY_MODEL__WRAPPED)
+	{
+		Register_I &= CHIP_8_QUIRK_POLICY<Profile>::MEMORY_SIZE - 1;
+		return true;
+	}
+	if ((CHIP_8_QUIRK_POLICY<Profile>::MEMORY_SIZE < EXTENDED_MEMORY_SIZE) && (Register_I >= CHIP_8_QUIRK_POLICY<Profile>::MEMORY_SIZE))
 	{
 		CurrentStatus = CHIP_8_ERROR_CODE__OUT_OF_BOUNDS_MEMORY_ACCESS;
 		return false;
@@ -124,33 +368,156 @@ bool CHIP_8::IsMemoryAccessSafe()
 		return true;
 }
 
-void CHIP_8::ClearDisplay()
+//Writes the byte at I. Only bytes code can run from have decoded instructions to discard, which is all of them unless the profile has extended memory.
+template<CHIP_8_QUIRKS Profile>
+void CHIP_8::StoreMemory(uint8_t Value)
+{
+	Memory[Register_I] = Value;
+	if ((CHIP_8_QUIRK_POLICY<Profile>::MEMORY_SIZE <= MEMORY_SIZE) || (Register_I < MEMORY_SIZE))
+		InvalidateDecodedInstruction(Register_I);
+}
+
+//Moves past the next instruction, which on the XO-CHIP can be the four bytes of F000 NNNN. The word after the last instruction is always within memory, so it can be read.
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::SkipInstruction()
+{
+	AdvanceProgramCounter<Model>();
+	if (CHIP_8_QUIRK_POLICY<Profile>::XO_CHIP_INSTRUCTIONS && (Memory[Register_PC] == 0xF0) && (Memory[Register_PC + 1] == 0x00))
+		AdvanceProgramCounter<Model>();
+}
+
+//Called on a jump from Jump back to Head. Replays one pass through the loop on a copy of the registers; when it only reads the delay timer and the keys, which cannot
+//change before the next frame, comes back to the jump and leaves the registers as they are now, every later pass will do exactly the same, so the loop is idle.
+void CHIP_8::CheckIdleLoop(const uint8_t* Registers, unsigned int Head, unsigned int Jump)
+{
+	uint8_t V[NUMBER_OF_GENERAL_REGISTERS];
+	memcpy(V, Registers, sizeof(V));
+	unsigned int Length = 1;
+	unsigned int Address = Head;
+	while (Address != Jump)
+	{
+		if (Address > Jump)
+			return;
+		uint16_t Instruction = (Memory[Address] << 8) | Memory[Address + 1];
+		unsigned int x = (Instruction & 0x0F00) >> 8;
+		unsigned int y = (Instruction & 0x00F0) >> 4;
+		bool Skip;
+		switch (DecodeInstruction(Instruction))
+		{
+			case CHIP_8_OPERATION__Fx07__LD_Vx_DT:
+				V[x] = Timer_DT;
+				Skip = false;
+				break;
+			case CHIP_8_OPERATION__3xnn__SE_Vx_byte:
+				Skip = V[x] == (Instruction & 0x00FF);
+				break;
+			case CHIP_8_OPERATION__4xnn__SNE_Vx_byte:
+				Skip = V[x] != (Instruction & 0x00FF);
+				break;
+			case CHIP_8_OPERATION__5xy0__SE_Vx_Vy:
+				Skip = V[x] == V[y];
+				break;
+			case CHIP_8_OPERATION__9xy0__SNE_Vx_Vy:
+				Skip = V[x] != V[y];
+				break;
+			case CHIP_8_OPERATION__Ex9E__SKP_Vx:
+				Skip = Keypad[V[x] & 0xF];
+				break;
+			case CHIP_8_OPERATION__ExA1__SKNP_Vx:
+				Skip = !Keypad[V[x] & 0xF];
+				break;
+			default:
+				return;
+		}
+		Address += 2;
+		if (Skip)
+			Address += (XoChipProfiles[Quirks] && (Memory[Address] == 0xF0) && (Memory[Address + 1] == 0x00)) ? 4 : 2;
+		++Length;
+	}
+	if (memcmp(V, Registers, sizeof(V)) != 0)
+		return;
+	IdleLoopLength = Length;
+	StopReason = CHIP_8_STOP_REASON__IDLE_LOOP;
+}
+
+//Clears the given planes. Only the part of the display the current mode uses can have pixels set.
+void CHIP_8::ClearDisplay(unsigned int PlaneMask)
 {
-	for (unsigned int i = 0; i < RESOLUTION_X; ++i)
+	unsigned int Height = HighResolution ? RESOLUTION_Y : LOW_RESOLUTION_Y;
+	unsigned int Words = HighResolution ? DISPLAY_WORDS : 1;
+	for (unsigned int Plane = 0; Plane < NUMBER_OF_PLANES; ++Plane)
 	{
-		for (unsigned int j = 0; j < RESOLUTION_Y; ++j)
+		if (!(PlaneMask & (1 << Plane)))
+			continue;
+		for (unsigned int y = 0; y < Height; ++y)
 		{
-			Display[i][j] = false;
+			uint64_t Set = 0;
+			for (unsigned int i = 0; i < Words; ++i)
+			{
+				Set |= Display[Plane][y][i];
+				Display[Plane][y][i] = 0;
+			}
+			if (Set != 0)
+				DamagedRows |= 1ull << y;
 		}
 	}
 	DrawingHappened = true;
 }
 
+//Switching modes clears every plane, as the XO-CHIP and most SUPER-CHIP interpreters do, and damages every row, the rows being drawn at a different scale afterwards.
+void CHIP_8::SetResolution(bool High)
+{
+	HighResolution = true;
+	ClearDisplay(ALL_PLANES);
+	HighResolution = High;
+	DamagedRows = ALL_ROWS;
+}
+
 bool CHIP_8::GetSound()
 {
 	return SoundEmitted;
 }
 
+//The 128 samples to loop while GetSound is true.
+const uint8_t* CHIP_8::GetAudioPattern()
+{
+	return AudioPattern;
+}
+
+uint8_t CHIP_8::GetPitch()
+{
+	return Pitch;
+}
+
+//Samples of the pattern played per second: 4000 at the default pitch of 64, doubling every 48 steps above it.
+double CHIP_8::GetAudioSampleRate()
+{
+	return 4000 * pow(2, (static_cast<double>(Pitch) - 64) / 48);
+}
+
 void CHIP_8::PressButton(unsigned int Button)
 {
-	if (Button < NUMBER_OF_BUTTONS)
+	if ((Button < NUMBER_OF_BUTTONS) && !Keypad[Button])
+	{
 		Keypad[Button] = true;
+		WaitingForKey = false;
+	}
 }
 
 void CHIP_8::UnpressButton(unsigned int Button)
 {
-	if (Button < NUMBER_OF_BUTTONS)
+	if ((Button < NUMBER_OF_BUTTONS) && Keypad[Button])
+	{
 		Keypad[Button] = false;
+		WaitingForKey = false;
+	}
+}
+
+//True while the program is stopped on Fx0A and nothing but PressButton or UnpressButton can get it going again, so a front end can block on its input until then.
+//Running the machine meanwhile only counts the timers down.
+bool CHIP_8::IsWaitingForKey()
+{
+	return WaitingForKey && (CurrentStatus == CHIP_8_ERROR_CODE__STATUS_OK);
 }
 
 bool CHIP_8::DidDrawingHappen()
@@ -160,40 +527,102 @@ bool CHIP_8::DidDrawingHappen()
 	return ReturnValue;
 }
 
+//Coordinates are in pixels of the current mode. A pixel is set when it is set on any plane.
 bool CHIP_8::GetDisplay(unsigned int PositionX, unsigned int PositionY)
 {
-	if (PositionX < RESOLUTION_X)
-		if (PositionY < RESOLUTION_Y)
-			return Display[PositionX][PositionY];
+	if (PositionX < GetResolutionX())
+		if (PositionY < GetResolutionY())
+		{
+			uint64_t Word = 0;
+			for (unsigned int Plane = 0; Plane < NUMBER_OF_PLANES; ++Plane)
+			{
+				Word |= Display[Plane][PositionY][PositionX / 64];
+			}
+			return (Word >> (63 - (PositionX % 64))) & 1;
+		}
 	return false;
 }
 
+unsigned int CHIP_8::GetResolutionX()
+{
+	return HighResolution ? RESOLUTION_X : LOW_RESOLUTION_X;
+}
+
+unsigned int CHIP_8::GetResolutionY()
+{
+	return HighResolution ? RESOLUTION_Y : LOW_RESOLUTION_Y;
+}
+
+//Planes the selected profile can draw on; the others stay clear.
+unsigned int CHIP_8::GetNumberOfPlanes()
+{
+	return XoChipProfiles[Quirks] ? NUMBER_OF_PLANES : 1;
+}
+
+//Row y of the plane starts at word y * DISPLAY_WORDS.
+const uint64_t* CHIP_8::GetDisplayRows(unsigned int Plane)
+{
+	return Display[(Plane < NUMBER_OF_PLANES) ? Plane : 0][0];
+}
+
+uint64_t CHIP_8::GetDamagedRows()
+{
+	uint64_t ReturnValue = DamagedRows;
+	DamagedRows = 0;
+	return ReturnValue;
+}
+
 CHIP_8_ERROR_CODE CHIP_8::LoadProgram(char* DataPointer, unsigned int DataSize)
+{
+	return LoadProgram(reinterpret_cast<const uint8_t*>(DataPointer), DataSize, nullptr);
+}
+
+//Decoded, when given, holds the GetPredecodedLength(DataSize) entries PredecodeProgram made from the same program, which are then not decoded again as it runs.
+CHIP_8_ERROR_CODE CHIP_8::LoadProgram(const uint8_t* DataPointer, unsigned int DataSize, const CHIP_8_DECODED_INSTRUCTION* Decoded)
 {
 	if (CurrentStatus != CHIP_8_ERROR_CODE__RESET)
 		Reset();
 
-	if (DataSize > (MEMORY_SIZE - PROGRAM_AREA_START_ADDRESS))
+	if (DataSize > (GetMemorySize() - PROGRAM_AREA_START_ADDRESS))
 	{
 		CurrentStatus = CHIP_8_ERROR_CODE__PROGRAM_TOO_BIG;
 	}
 	else
 	{
-		for (unsigned int i = 0; i < DataSize; ++i)
-		{
-			Memory[PROGRAM_AREA_START_ADDRESS + i] = DataPointer[i];
-		}
+		//A reset leaves no instruction decoded, so there is nothing to invalidate.
+		memcpy(&Memory[PROGRAM_AREA_START_ADDRESS], DataPointer, DataSize);
+		if (Decoded != nullptr)
+			memcpy(&DecodedInstructions[PROGRAM_AREA_START_ADDRESS], Decoded, GetPredecodedLength(DataSize) * sizeof(CHIP_8_DECODED_INSTRUCTION));
 		CurrentStatus = CHIP_8_ERROR_CODE__STATUS_OK;
 	}
 	Register_PC = PROGRAM_AREA_START_ADDRESS;
 	return CurrentStatus;
 }
 
-CHIP_8_ERROR_CODE CHIP_8::Step(unsigned int NumberOf60thOfSecond)
+//Entries PredecodeProgram makes for a program of the given size: one per byte of it that code can run from.
+unsigned int CHIP_8::GetPredecodedLength(unsigned int DataSize)
 {
-	if (CurrentStatus)
-		return CurrentStatus;
+	return (DataSize < (MEMORY_SIZE - PROGRAM_AREA_START_ADDRESS)) ? DataSize : (MEMORY_SIZE - PROGRAM_AREA_START_ADDRESS);
+}
 
+//Decodes a program as a machine fresh from a reset would once it is loaded, into GetPredecodedLength(DataSize) entries for the addresses from PROGRAM_AREA_START_ADDRESS.
+//The entries do not depend on the quirk profile, so one table serves every machine the program is loaded into.
+void CHIP_8::PredecodeProgram(const uint8_t* DataPointer, unsigned int DataSize, CHIP_8_DECODED_INSTRUCTION* Decoded)
+{
+	unsigned int Length = GetPredecodedLength(DataSize);
+	for (unsigned int i = 0; i < Length; ++i)
+	{
+		uint16_t FetchedInstruction = DataPointer[i] << 8;
+		if ((i + 1) < DataSize)
+			FetchedInstruction |= DataPointer[i + 1];
+		FillDecodedInstruction(Decoded[i], FetchedInstruction);
+	}
+}
+
+void CHIP_8::UpdateTimers(unsigned int NumberOf60thOfSecond)
+{
+	if (Trace && NumberOf60thOfSecond)
+		Trace->RecordTimers(NumberOf60thOfSecond);
 	if (Timer_DT)
 	{
 		if (NumberOf60thOfSecond > static_cast<unsigned int>(Timer_DT))
@@ -214,32 +643,565 @@ CHIP_8_ERROR_CODE CHIP_8::Step(unsigned int NumberOf60thOfSecond)
 			if(Timer_ST == 0)
 				SoundEmitted = false;
 		}
-	}
-	else
-		SoundEmitted = false;
-
-	FetchInstruction();
-
-	return CurrentStatus;
+	}
+	else
+		SoundEmitted = false;
+}
+
+CHIP_8_ERROR_CODE CHIP_8::Step(unsigned int NumberOf60thOfSecond)
+{
+	if (CurrentStatus)
+		return CurrentStatus;
+
+	UpdateTimers(NumberOf60thOfSecond);
+
+	StopReason = CHIP_8_STOP_REASON__BUDGET_EXHAUSTED;
+	ExecutedInstructions += ExecuteInstructions(1);
+
+	return CurrentStatus;
+}
+
+//Executes up to the given number of instructions, stopping early after an instruction that drew, failed or is waiting for a key. Timers are left to the caller.
+CHIP_8_STOP_REASON CHIP_8::RunCycles(unsigned int NumberOfInstructions)
+{
+	if (CurrentStatus)
+		return CHIP_8_STOP_REASON__ERROR;
+
+	StopReason = CHIP_8_STOP_REASON__BUDGET_EXHAUSTED;
+	ExecutedInstructions += ExecuteInstructions(NumberOfInstructions);
+
+	if (CurrentStatus)
+		return CHIP_8_STOP_REASON__ERROR;
+	return StopReason;
+}
+
+//Executes one 60th of a second worth of instructions, drawing included, then counts the timers down once.
+CHIP_8_STOP_REASON CHIP_8::RunFrame(unsigned int InstructionsPerFrame)
+{
+	if (CurrentStatus)
+		return CHIP_8_STOP_REASON__ERROR;
+
+#if CHIP_8_PROFILING == true
+	double FrameStart = ExecutionProfile.Seconds;
+#endif
+	bool Drawn = false;
+	unsigned int Executed = 0;
+	while (Executed < InstructionsPerFrame)
+	{
+		StopReason = CHIP_8_STOP_REASON__BUDGET_EXHAUSTED;
+		Executed += ExecuteInstructions(InstructionsPerFrame - Executed);
+		if (StopReason != CHIP_8_STOP_REASON__DRAWING_HAPPENED)
+			break;
+		Drawn = true;
+	}
+	ExecutedInstructions += Executed;
+#if CHIP_8_PROFILING == true
+	++ExecutionProfile.Frames;
+	if ((ExecutionProfile.Seconds - FrameStart) > ExecutionProfile.LongestFrameSeconds)
+		ExecutionProfile.LongestFrameSeconds = ExecutionProfile.Seconds - FrameStart;
+#endif
+
+	UpdateTimers(1);
+
+	if (CurrentStatus)
+		return CHIP_8_STOP_REASON__ERROR;
+	if (StopReason == CHIP_8_STOP_REASON__WAITING_FOR_KEY)
+		return CHIP_8_STOP_REASON__WAITING_FOR_KEY;
+	if (Drawn)
+		return CHIP_8_STOP_REASON__DRAWING_HAPPENED;
+	return CHIP_8_STOP_REASON__BUDGET_EXHAUSTED;
+}
+
+CHIP_8_ERROR_CODE CHIP_8::GetStatus()
+{
+	return CurrentStatus;
+}
+
+uint64_t CHIP_8::GetExecutedInstructions()
+{
+	return ExecutedInstructions;
+}
+
+//How many of the executed instructions were passes through idle loops that were counted rather than run.
+uint64_t CHIP_8::GetIdleInstructions()
+{
+	return IdleInstructions;
+}
+
+//Records every instruction from now on into the trace, whichever engine is selected, until called with nullptr. The trace is not owned, and must outlive its use here.
+void CHIP_8::SetTrace(CHIP_8_TRACE* NewTrace)
+{
+	Trace = NewTrace;
+}
+
+const char* CHIP_8::GetOperationName(CHIP_8_OPERATION Operation)
+{
+	if (Operation < CHIP_8_OPERATION__NUMBER_OF_OPERATIONS)
+		return OperationNames[Operation];
+	return OperationNames[CHIP_8_OPERATION__NOT_RECOGNIZED];
+}
+
+#if CHIP_8_PROFILING == true
+const CHIP_8_PROFILE& CHIP_8::GetProfile()
+{
+	return ExecutionProfile;
+}
+
+void CHIP_8::ClearProfile()
+{
+	static_assert(CHIP_8_PROFILE::NUMBER_OF_ADDRESSES == MEMORY_SIZE, "The profile needs an entry for every address code can run from.");
+	memset(&ExecutionProfile, 0, sizeof(ExecutionProfile));
+}
+
+//Counts the instruction at the address as run. Called before it runs, so an instruction that overwrites itself is counted as what it was.
+void CHIP_8::ProfileInstruction(unsigned int Address)
+{
+	if (Address >= (MEMORY_SIZE - 1))
+		return;
+	if (DecodedInstructions[Address].Operation == CHIP_8_OPERATION__NOT_DECODED)
+		DecodeInstructionAt(Address);
+	uint8_t Operation = DecodedInstructions[Address].Operation;
+	++ExecutionProfile.Operations[Operation];
+	++ExecutionProfile.Addresses[Address];
+	ExecutionProfile.AddressOperations[Address] = Operation;
+}
+#endif
+
+uint8_t CHIP_8::GetRegisterVx(unsigned int Register)
+{
+	if (Register < NUMBER_OF_GENERAL_REGISTERS)
+		return Register_Vx[Register];
+	return 0;
+}
+
+uint16_t CHIP_8::GetRegisterI()
+{
+	return Register_I;
+}
+
+uint16_t CHIP_8::GetRegisterPC()
+{
+	return Register_PC;
+}
+
+uint8_t CHIP_8::GetRegisterSP()
+{
+	return Register_SP;
+}
+
+uint8_t CHIP_8::GetTimerDT()
+{
+	return Timer_DT;
+}
+
+uint8_t CHIP_8::GetTimerST()
+{
+	return Timer_ST;
+}
+
+//Selects the quirk profile used from the next instruction on. It is kept across resets, so it can be chosen before or after loading a program.
+void CHIP_8::SetQuirks(CHIP_8_QUIRKS Profile)
+{
+	if (Profile >= CHIP_8_QUIRKS__NUMBER_OF_PROFILES)
+		return;
+	//Memory the new profile does not have is cleared, as memory past the profile's size is always zero; memory it gains already is.
+	if (MemorySizes[Profile] < MemorySizes[Quirks])
+		memset(Memory + MemorySizes[Profile], 0, MemorySizes[Quirks] - MemorySizes[Profile]);
+	Quirks = Profile;
+	Handlers = InstructionHandlers[MemoryModel][Quirks];
+	FlushJit();
+}
+
+//Selects the memory model used from the next instruction on. Like the quirk profile it is kept across resets, and it is not part of snapshots: it changes how
+//faults are caught, not what a correct program does.
+void CHIP_8::SetMemoryModel(CHIP_8_MEMORY_MODEL Model)
+{
+	if (Model >= CHIP_8_MEMORY_MODEL__NUMBER_OF_MODELS)
+		return;
+	MemoryModel = Model;
+	Handlers = InstructionHandlers[MemoryModel][Quirks];
+	WrapAddresses();
+}
+
+CHIP_8_MEMORY_MODEL CHIP_8::GetMemoryModel()
+{
+	return MemoryModel;
+}
+
+//Brings PC and the return addresses into the code area, which the wrapped memory model counts on; in the strict model the checks catch them instead.
+void CHIP_8::WrapAddresses()
+{
+	if (MemoryModel != CHIP_8_MEMORY_MODEL__WRAPPED)
+		return;
+	Register_PC &= MEMORY_SIZE - 1;
+	for (unsigned int i = 0; i < STACK_SIZE; ++i)
+	{
+		Stack[i] &= MEMORY_SIZE - 1;
+	}
+}
+
+CHIP_8_QUIRKS CHIP_8::GetQuirks()
+{
+	return Quirks;
+}
+
+//Bytes of memory the selected profile addresses, which limits the size of programs.
+unsigned int CHIP_8::GetMemorySize()
+{
+	return MemorySizes[Quirks];
+}
+
+void CHIP_8::SetSeed(uint64_t Seed)
+{
+	RandomSeed = Seed;
+	//splitmix64 spreads nearby seeds apart and keeps the state away from zero, where xorshift would stay forever.
+	uint64_t Mixed = Seed + 0x9E3779B97F4A7C15ull;
+	Mixed = (Mixed ^ (Mixed >> 30)) * 0xBF58476D1CE4E5B9ull;
+	Mixed = (Mixed ^ (Mixed >> 27)) * 0x94D049BB133111EBull;
+	Mixed ^= Mixed >> 31;
+	RandomState = (Mixed != 0) ? Mixed : 1;
+}
+
+uint64_t CHIP_8::GetSeed()
+{
+	return RandomSeed;
+}
+
+uint64_t CHIP_8::GetRandomState()
+{
+	return RandomState;
+}
+
+void CHIP_8::SetRandomState(uint64_t State)
+{
+	RandomState = (State != 0) ? State : 1;
+}
+
+uint8_t CHIP_8::GenerateRandomByte()
+{
+	RandomState ^= RandomState >> 12;
+	RandomState ^= RandomState << 25;
+	RandomState ^= RandomState >> 27;
+	return static_cast<uint8_t>((RandomState * 0x2545F4914F6CDD1Dull) >> 56);
+}
+
+static_assert(std::is_trivially_copyable<CHIP_8_SNAPSHOT>::value, "Snapshots have to be copyable as plain bytes.");
+static_assert(sizeof(CHIP_8_SNAPSHOT) == 67736, "The snapshot layout changed; check it has no padding and raise CHIP_8_SNAPSHOT::VERSION.");
+static_assert(offsetof(CHIP_8_SNAPSHOT, Memory) + sizeof(CHIP_8_SNAPSHOT::Memory) == sizeof(CHIP_8_SNAPSHOT), "Memory has to be the last field of snapshots, which are cut short after the profile's memory.");
+
+//The bytes of the snapshot that hold its state: everything up to the memory, and as much memory as its profile has. A snapshot with a profile the machine does not know
+//counts in full, for RestoreSnapshot to reject.
+size_t CHIP_8_SNAPSHOT::GetSize() const
+{
+	if (Quirks >= CHIP_8_QUIRKS__NUMBER_OF_PROFILES)
+		return sizeof(CHIP_8_SNAPSHOT);
+	return offsetof(CHIP_8_SNAPSHOT, Memory) + MemorySizes[Quirks];
+}
+
+void CHIP_8::SaveSnapshot(CHIP_8_SNAPSHOT& Snapshot)
+{
+	Snapshot.Magic = CHIP_8_SNAPSHOT::MAGIC;
+	Snapshot.Version = CHIP_8_SNAPSHOT::VERSION;
+	Snapshot.ExecutedInstructions = ExecutedInstructions;
+	Snapshot.RandomSeed = RandomSeed;
+	Snapshot.RandomState = RandomState;
+	memcpy(Snapshot.Display, Display, sizeof(Display));
+	memcpy(Snapshot.Memory, Memory, MemorySizes[Quirks]);
+	memcpy(Snapshot.Stack, Stack, sizeof(Stack));
+	Snapshot.Register_I = Register_I;
+	Snapshot.Register_PC = Register_PC;
+	memcpy(Snapshot.Register_Vx, Register_Vx, sizeof(Register_Vx));
+	memcpy(Snapshot.Register_RPL, Register_RPL, sizeof(Register_RPL));
+	for (unsigned int i = 0; i < NUMBER_OF_BUTTONS; ++i)
+	{
+		Snapshot.Keypad[i] = Keypad[i];
+	}
+	memcpy(Snapshot.AudioPattern, AudioPattern, sizeof(AudioPattern));
+	Snapshot.Register_SP = Register_SP;
+	Snapshot.Timer_DT = Timer_DT;
+	Snapshot.Timer_ST = Timer_ST;
+	Snapshot.SoundEmitted = SoundEmitted;
+	Snapshot.ButtonHeld = ButtonHeld;
+	Snapshot.HeldButton = static_cast<uint8_t>(HeldButton);
+	Snapshot.WaitingForKey = WaitingForKey;
+	Snapshot.DrawingHappened = DrawingHappened;
+	Snapshot.Quirks = static_cast<uint8_t>(Quirks);
+	Snapshot.CurrentStatus = static_cast<uint8_t>(CurrentStatus);
+	Snapshot.StopReason = static_cast<uint8_t>(StopReason);
+	Snapshot.HighResolution = HighResolution;
+	Snapshot.Planes = Planes;
+	Snapshot.Pitch = Pitch;
+	memset(Snapshot.Reserved, 0, sizeof(Snapshot.Reserved));
+}
+
+//Returns false, leaving the machine untouched, for a snapshot of another version or with values the machine cannot hold. Only the decoded instructions of bytes that differ
+//are discarded, so going back and forth between nearby states keeps the caches warm.
+bool CHIP_8::RestoreSnapshot(const CHIP_8_SNAPSHOT& Snapshot)
+{
+	if ((Snapshot.Magic != CHIP_8_SNAPSHOT::MAGIC) || (Snapshot.Version != CHIP_8_SNAPSHOT::VERSION))
+		return false;
+	if ((Snapshot.Register_SP > STACK_SIZE) || (Snapshot.HeldButton >= NUMBER_OF_BUTTONS) || (Snapshot.Quirks >= CHIP_8_QUIRKS__NUMBER_OF_PROFILES) || (Snapshot.CurrentStatus > CHIP_8_ERROR_CODE__PROGRAM_EXITED) || (Snapshot.StopReason > CHIP_8_STOP_REASON__DRAWING_HAPPENED) || (Snapshot.Planes > ALL_PLANES))
+		return false;
+
+	//Switching the profile first clears the memory the snapshot's profile does not have, which the snapshot does not hold either.
+	if (Quirks != Snapshot.Quirks)
+		SetQuirks(static_cast<CHIP_8_QUIRKS>(Snapshot.Quirks));
+
+	//Bytes past MEMORY_SIZE are never decoded, so they are simply copied.
+	const unsigned int CHUNK_SIZE = 64;
+	for (unsigned int i = 0; i < MEMORY_SIZE; i += CHUNK_SIZE)
+	{
+		if (memcmp(Memory + i, Snapshot.Memory + i, CHUNK_SIZE) == 0)
+			continue;
+		for (unsigned int j = i; j < (i + CHUNK_SIZE); ++j)
+		{
+			if (Memory[j] != Snapshot.Memory[j])
+			{
+				Memory[j] = Snapshot.Memory[j];
+				InvalidateDecodedInstruction(j);
+			}
+		}
+	}
+	memcpy(Memory + MEMORY_SIZE, Snapshot.Memory + MEMORY_SIZE, MemorySizes[Quirks] - MEMORY_SIZE);
+	if (HighResolution != (Snapshot.HighResolution != 0))
+		DamagedRows = ALL_ROWS;
+	HighResolution = Snapshot.HighResolution != 0;
+	for (unsigned int Plane = 0; Plane < NUMBER_OF_PLANES; ++Plane)
+	{
+		for (unsigned int y = 0; y < RESOLUTION_Y; ++y)
+		{
+			for (unsigned int i = 0; i < DISPLAY_WORDS; ++i)
+			{
+				if (Display[Plane][y][i] != Snapshot.Display[Plane][y][i])
+					DamagedRows |= 1ull << y;
+				Display[Plane][y][i] = Snapshot.Display[Plane][y][i];
+			}
+		}
+	}
+	Planes = Snapshot.Planes;
+
+	ExecutedInstructions = Snapshot.ExecutedInstructions;
+	RandomSeed = Snapshot.RandomSeed;
+	SetRandomState(Snapshot.RandomState);
+	memcpy(Stack, Snapshot.Stack, sizeof(Stack));
+	Register_I = Snapshot.Register_I;
+	Register_PC = Snapshot.Register_PC;
+	memcpy(Register_Vx, Snapshot.Register_Vx, sizeof(Register_Vx));
+	memcpy(Register_RPL, Snapshot.Register_RPL, sizeof(Register_RPL));
+	for (unsigned int i = 0; i < NUMBER_OF_BUTTONS; ++i)
+	{
+		Keypad[i] = Snapshot.Keypad[i] != 0;
+	}
+	Register_SP = Snapshot.Register_SP;
+	Timer_DT = Snapshot.Timer_DT;
+	Timer_ST = Snapshot.Timer_ST;
+	SoundEmitted = Snapshot.SoundEmitted != 0;
+	memcpy(AudioPattern, Snapshot.AudioPattern, sizeof(AudioPattern));
+	Pitch = Snapshot.Pitch;
+	ButtonHeld = Snapshot.ButtonHeld != 0;
+	HeldButton = Snapshot.HeldButton;
+	WaitingForKey = Snapshot.WaitingForKey != 0;
+	DrawingHappened = Snapshot.DrawingHappened != 0;
+	CurrentStatus = static_cast<CHIP_8_ERROR_CODE>(Snapshot.CurrentStatus);
+	StopReason = static_cast<CHIP_8_STOP_REASON>(Snapshot.StopReason);
+	WrapAddresses();
+	return true;
+}
+
+void CHIP_8::InvalidateDecodedInstructions()
+{
+	for (unsigned int i = 0; i < MEMORY_SIZE; ++i)
+	{
+		DecodedInstructions[i].Operation = CHIP_8_OPERATION__NOT_DECODED;
+	}
+}
+
+void CHIP_8::InvalidateDecodedInstruction(unsigned int Address)
+{
+	//A written byte is the first half of the instruction at its own address and the second half of the one before it.
+	DecodedInstructions[Address].Operation = CHIP_8_OPERATION__NOT_DECODED;
+	if (Address > 0)
+		DecodedInstructions[Address - 1].Operation = CHIP_8_OPERATION__NOT_DECODED;
+	if ((JitCoverage != nullptr) && JitCoverage[Address])
+		FlushJit();
+}
+
+void CHIP_8::DecodeInstructionAt(unsigned int Address)
+{
+	uint16_t FetchedInstruction = Memory[Address];
+	FetchedInstruction <<= 8;
+	FetchedInstruction += Memory[Address + 1];
+	FillDecodedInstruction(DecodedInstructions[Address], FetchedInstruction);
+}
+
+void CHIP_8::FillDecodedInstruction(CHIP_8_DECODED_INSTRUCTION& Decoded, uint16_t FetchedInstruction)
+{
+	Decoded.Instruction = FetchedInstruction;
+	Decoded.nnn = FetchedInstruction & 0x0FFF;
+	Decoded.x = (FetchedInstruction & 0x0F00) >> 8;
+	Decoded.y = (FetchedInstruction & 0x00F0) >> 4;
+	Decoded.n = FetchedInstruction & 0x000F;
+	Decoded.nn = FetchedInstruction & 0x00FF;
+	Decoded.Operation = DecodeInstruction(FetchedInstruction);
+}
+
+//The wrapped memory model keeps PC within the code area, so there is nothing to check; the byte after its last address is past the area but still within memory.
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::FetchInstruction()
+{
+	if ((Model == CHIP_8_MEMORY_MODEL__WRAPPED) || (Register_PC < (MEMORY_SIZE - 1)))
+	{
+		const CHIP_8_DECODED_INSTRUCTION& Decoded = DecodedInstructions[Register_PC];
+		if (Decoded.Operation == CHIP_8_OPERATION__NOT_DECODED)
+			DecodeInstructionAt(Register_PC);
+		(this->*Handlers[Decoded.Operation])(Decoded.Instruction);
+	}
+	else
+	{
+		CurrentStatus = CHIP_8_ERROR_CODE__OUT_OF_BOUNDS_MEMORY_ACCESS;
+	}
+}
+
+void CHIP_8::FetchInstruction()
+{
+	if (MemoryModel == CHIP_8_MEMORY_MODEL__WRAPPED)
+		FetchInstruction<CHIP_8_MEMORY_MODEL__WRAPPED>();
+	else
+		FetchInstruction<CHIP_8_MEMORY_MODEL__STRICT>();
+}
+
+//Stands in for running Fx0A again while the keypad has not changed since it stopped, which would only stop again. The beep of a held key is kept up as Fx0A would.
+bool CHIP_8::ContinueWaitingForKey()
+{
+	if (!WaitingForKey)
+		return false;
+	if (ButtonHeld)
+		Timer_ST = 255;
+	StopReason = CHIP_8_STOP_REASON__WAITING_FOR_KEY;
+	return true;
+}
+
+//When an engine stops on an idle loop, as many whole passes through it as the budget holds are counted as executed, and the rest of the budget runs normally.
+unsigned int CHIP_8::ExecuteInstructions(unsigned int NumberOfInstructions)
+{
+#if CHIP_8_PROFILING == true
+	CHIP_8_PROFILE_TIMER Timer(ExecutionProfile.Seconds);
+#endif
+	unsigned int Executed = 0;
+	if ((NumberOfInstructions != 0) && ContinueWaitingForKey())
+		return Executed;
+	do
+	{
+		if (Trace)
+		{
+			Executed += ExecuteTraced(NumberOfInstructions - Executed);
+		}
+		else
+		{
+			switch (Engine)
+			{
+				case CHIP_8_ENGINE__THREADED:
+					Executed += (this->*ThreadedEngines[MemoryModel][Quirks])(NumberOfInstructions - Executed);
+					break;
+				case CHIP_8_ENGINE__JIT:
+					Executed += (this->*JitEngines[MemoryModel][Quirks])(NumberOfInstructions - Executed);
+					break;
+				default:
+					Executed += (this->*SwitchEngines[MemoryModel])(NumberOfInstructions - Executed);
+					break;
+			}
+		}
+		if (StopReason != CHIP_8_STOP_REASON__IDLE_LOOP)
+			break;
+		StopReason = CHIP_8_STOP_REASON__BUDGET_EXHAUSTED;
+		unsigned int Skipped = ((NumberOfInstructions - Executed) / IdleLoopLength) * IdleLoopLength;
+		Executed += Skipped;
+		IdleInstructions += Skipped;
+		if (Trace && Skipped)
+			Trace->RecordIdleLoop(Skipped);
+	} while (Executed < NumberOfInstructions);
+	return Executed;
 }
 
-void CHIP_8::FetchInstruction()
+template<CHIP_8_MEMORY_MODEL Model>
+unsigned int CHIP_8::ExecuteSwitch(unsigned int NumberOfInstructions)
 {
-
-	if (Register_PC < (MEMORY_SIZE - 1))
+	unsigned int Executed = 0;
+	while ((Executed < NumberOfInstructions) && (CurrentStatus == CHIP_8_ERROR_CODE__STATUS_OK) && (StopReason == CHIP_8_STOP_REASON__BUDGET_EXHAUSTED))
 	{
-		uint16_t FetchedInstruction = Memory[Register_PC];
-		FetchedInstruction <<= 8;
-		FetchedInstruction += Memory[Register_PC + 1];
-		InstructionSwitch(FetchedInstruction);
+#if CHIP_8_PROFILING == true
+		ProfileInstruction(Register_PC);
+#endif
+		FetchInstruction<Model>();
+		++Executed;
 	}
-	else
+	return Executed;
+}
+
+const CHIP_8::ENGINE_FUNCTION CHIP_8::SwitchEngines[CHIP_8_MEMORY_MODEL__NUMBER_OF_MODELS] =
+{
+	&CHIP_8::ExecuteSwitch<CHIP_8_MEMORY_MODEL__STRICT>,
+	&CHIP_8::ExecuteSwitch<CHIP_8_MEMORY_MODEL__WRAPPED>
+};
+
+//The switch engine, recording every instruction with what it changed: the registers are compared before and after, and the bytes Fx33, Fx55 and 5xy2 store are
+//read back from where I pointed. An instruction that fails is recorded too, without its writes, as it is usually what the trace is wanted for.
+unsigned int CHIP_8::ExecuteTraced(unsigned int NumberOfInstructions)
+{
+	unsigned int Executed = 0;
+	while ((Executed < NumberOfInstructions) && (CurrentStatus == CHIP_8_ERROR_CODE__STATUS_OK) && (StopReason == CHIP_8_STOP_REASON__BUDGET_EXHAUSTED))
 	{
-		CurrentStatus = CHIP_8_ERROR_CODE__OUT_OF_BOUNDS_MEMORY_ACCESS;
+#if CHIP_8_PROFILING == true
+		ProfileInstruction(Register_PC);
+#endif
+		uint16_t Address = Register_PC;
+		uint16_t Instruction = ((MemoryModel == CHIP_8_MEMORY_MODEL__WRAPPED) || (Address < (MEMORY_SIZE - 1))) ? static_cast<uint16_t>((Memory[Address] << 8) | Memory[Address + 1]) : 0;
+		uint8_t Registers[NUMBER_OF_GENERAL_REGISTERS];
+		memcpy(Registers, Register_Vx, sizeof(Registers));
+		uint16_t I = Register_I;
+
+		FetchInstruction();
+		++Executed;
+
+		uint64_t Before[2], After[2];
+		memcpy(Before, Registers, sizeof(Before));
+		memcpy(After, Register_Vx, sizeof(After));
+		uint16_t ChangedRegisters = 0;
+		if ((Before[0] != After[0]) || (Before[1] != After[1]))
+		{
+			for (unsigned int i = 0; i < NUMBER_OF_GENERAL_REGISTERS; ++i)
+			{
+				if (Registers[i] != Register_Vx[i])
+					ChangedRegisters |= 1 << i;
+			}
+		}
+		//Matched by hand, as decoding every instruction again would cost more than the rest of the recording.
+		unsigned int WriteLength = 0;
+		if (CurrentStatus == CHIP_8_ERROR_CODE__STATUS_OK)
+		{
+			unsigned int Vx = (Instruction & 0x0F00) >> 8;
+			unsigned int Vy = (Instruction & 0x00F0) >> 4;
+			if ((Instruction & 0xF0FF) == 0xF033)
+				WriteLength = 3;
+			else if ((Instruction & 0xF0FF) == 0xF055)
+				WriteLength = Vx + 1;
+			else if ((Instruction & 0xF00F) == 0x5002)
+				WriteLength = ((Vx <= Vy) ? (Vy - Vx) : (Vx - Vy)) + 1;
+		}
+		//The handlers wrap every byte's address to memory, so a write may go on at the start of memory; the bytes are gathered from where they actually went.
+		unsigned int MemoryMask = MemorySizes[Quirks] - 1;
+		uint16_t WriteAddress = static_cast<uint16_t>(I & MemoryMask);
+		uint8_t Written[NUMBER_OF_GENERAL_REGISTERS];
+		for (unsigned int i = 0; i < WriteLength; ++i)
+		{
+			Written[i] = Memory[(WriteAddress + i) & MemoryMask];
+		}
+		Trace->RecordInstruction(Address, Instruction, ChangedRegisters, Register_Vx, I != Register_I, Register_I, WriteAddress, WriteLength, Written);
 	}
+	return Executed;
 }
 
-void CHIP_8::InstructionSwitch(uint16_t FetchedInstruction)
+CHIP_8_OPERATION CHIP_8::DecodeInstruction(uint16_t FetchedInstruction)
 {
 	uint16_t part = FetchedInstruction & 0xF000;
 	switch (part)
@@ -256,43 +1218,59 @@ void CHIP_8::InstructionSwitch(uint16_t FetchedInstruction)
 					{
 						case 0x00E0:
 						{
-							Instruction_00E0__CLS();
-							break;
+							return CHIP_8_OPERATION__00E0__CLS;
 						}
 						case 0x00EE:
 						{
-							Instruction_00EE__RET();
-							break;
+							return CHIP_8_OPERATION__00EE__RET;
+						}
+						case 0x00FB:
+						{
+							return CHIP_8_OPERATION__00FB__SCR;
+						}
+						case 0x00FC:
+						{
+							return CHIP_8_OPERATION__00FC__SCL;
+						}
+						case 0x00FD:
+						{
+							return CHIP_8_OPERATION__00FD__EXIT;
+						}
+						case 0x00FE:
+						{
+							return CHIP_8_OPERATION__00FE__LOW;
+						}
+						case 0x00FF:
+						{
+							return CHIP_8_OPERATION__00FF__HIGH;
 						}
 						default:
-							CurrentStatus = CHIP_8_ERROR_CODE__INSTRUCTION_NOT_RECOGNIZED;
+							if ((part & 0x00F0) == 0x00C0)
+								return CHIP_8_OPERATION__00Cn__SCD_nibble;
+							if ((part & 0x00F0) == 0x00D0)
+								return CHIP_8_OPERATION__00Dn__SCU_nibble;
+							return CHIP_8_OPERATION__NOT_RECOGNIZED;
 					}
-					break;
 				}
 				default:
-					Instruction_0nnn__SYS_addr(FetchedInstruction);
+					return CHIP_8_OPERATION__0nnn__SYS_addr;
 			}
-			break;
 		}
 		case 0x1000:
 		{
-			Instruction_1nnn__JP_addr(FetchedInstruction);
-			break;
+			return CHIP_8_OPERATION__1nnn__JP_addr;
 		}
 		case 0x2000:
 		{
-			Instruction_2nnn__CALL_addr(FetchedInstruction);
-			break;
+			return CHIP_8_OPERATION__2nnn__CALL_addr;
 		}
 		case 0x3000:
 		{
-			Instruction_3xnn__SE_Vx_byte(FetchedInstruction);
-			break;
+			return CHIP_8_OPERATION__3xnn__SE_Vx_byte;
 		}
 		case 0x4000:
 		{
-			Instruction_4xnn__SNE_Vx_byte(FetchedInstruction);
-			break;
+			return CHIP_8_OPERATION__4xnn__SNE_Vx_byte;
 		}
 		case 0x5000:
 		{
@@ -301,23 +1279,27 @@ void CHIP_8::InstructionSwitch(uint16_t FetchedInstruction)
 			{
 				case 0x0000:
 				{
-					Instruction_5xy0__SE_Vx_Vy(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__5xy0__SE_Vx_Vy;
+				}
+				case 0x0002:
+				{
+					return CHIP_8_OPERATION__5xy2__LD_I_Vx_Vy;
+				}
+				case 0x0003:
+				{
+					return CHIP_8_OPERATION__5xy3__LD_Vx_Vy_I;
 				}
 				default:
-					CurrentStatus = CHIP_8_ERROR_CODE__INSTRUCTION_NOT_RECOGNIZED;
+					return CHIP_8_OPERATION__NOT_RECOGNIZED;
 			}
-			break;
 		}
 		case 0x6000:
 		{
-			Instruction_6xnn__LD_Vx_byte(FetchedInstruction);
-			break;
+			return CHIP_8_OPERATION__6xnn__LD_Vx_byte;
 		}
 		case 0x7000:
 		{
-			Instruction_7xnn__ADD_Vx_byte(FetchedInstruction);
-			break;
+			return CHIP_8_OPERATION__7xnn__ADD_Vx_byte;
 		}
 		case 0x8000:
 		{
@@ -326,53 +1308,43 @@ void CHIP_8::InstructionSwitch(uint16_t FetchedInstruction)
 			{
 				case 0x0000:
 				{
-					Instruction_8xy0__LD_Vx_Vy(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__8xy0__LD_Vx_Vy;
 				}
 				case 0x0001:
 				{
-					Instruction_8xy1__OR_Vx_Vy(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__8xy1__OR_Vx_Vy;
 				}
 				case 0x0002:
 				{
-					Instruction_8xy2__AND_Vx_Vy(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__8xy2__AND_Vx_Vy;
 				}
 				case 0x0003:
 				{
-					Instruction_8xy3__XOR_Vx_Vy(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__8xy3__XOR_Vx_Vy;
 				}
 				case 0x0004:
 				{
-					Instruction_8xy4__ADD_Vx_Vy(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__8xy4__ADD_Vx_Vy;
 				}
 				case 0x0005:
 				{
-					Instruction_8xy5__SUB_Vx_Vy(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__8xy5__SUB_Vx_Vy;
 				}
 				case 0x0006:
 				{
-					Instruction_8xy6__SHR_Vx_Vy(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__8xy6__SHR_Vx_Vy;
 				}
 				case 0x0007:
 				{
-					Instruction_8xy7__SUBN_Vx_Vy(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__8xy7__SUBN_Vx_Vy;
 				}
 				case 0x000E:
 				{
-					Instruction_8xyE__SHL_Vx_Vy(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__8xyE__SHL_Vx_Vy;
 				}
 				default:
-					CurrentStatus = CHIP_8_ERROR_CODE__INSTRUCTION_NOT_RECOGNIZED;
+					return CHIP_8_OPERATION__NOT_RECOGNIZED;
 			}
-			break;
 		}
 		case 0x9000:
 		{
@@ -381,34 +1353,27 @@ void CHIP_8::InstructionSwitch(uint16_t FetchedInstruction)
 			{
 				case 0x0000:
 				{
-					Instruction_9xy0__SNE_Vx_Vy(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__9xy0__SNE_Vx_Vy;
 				}
 				default:
-					CurrentStatus = CHIP_8_ERROR_CODE__INSTRUCTION_NOT_RECOGNIZED;
+					return CHIP_8_OPERATION__NOT_RECOGNIZED;
 			}
-			break;
 		}
 		case 0xA000:
 		{
-			Instruction_Annn__LD_I_addr(FetchedInstruction);
-			break;
+			return CHIP_8_OPERATION__Annn__LD_I_addr;
 		}
 		case 0xB000:
 		{
-			Instruction_Bnnn__JP_V0_addr(FetchedInstruction);
-			break;
+			return CHIP_8_OPERATION__Bnnn__JP_V0_addr;
 		}
 		case 0xC000:
 		{
-			Instruction_Cxnn__RND_Vx_byte(FetchedInstruction);
-			break;
+			return CHIP_8_OPERATION__Cxnn__RND_Vx_byte;
 		}
 		case 0xD000:
 		{
-			Instruction_Dxyn__DRW_Vx_Vy_nibble(FetchedInstruction);
-			DrawingHappened = true;
-			break;
+			return CHIP_8_OPERATION__Dxyn__DRW_Vx_Vy_nibble;
 		}
 		case 0xE000:
 		{
@@ -417,75 +1382,100 @@ void CHIP_8::InstructionSwitch(uint16_t FetchedInstruction)
 			{
 				case 0x009E:
 				{
-					Instruction_Ex9E__SKP_Vx(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__Ex9E__SKP_Vx;
 				}
 				case 0x00A1:
 				{
-					Instruction_ExA1__SKNP_Vx(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__ExA1__SKNP_Vx;
 				}
 				default:
-					CurrentStatus = CHIP_8_ERROR_CODE__INSTRUCTION_NOT_RECOGNIZED;
+					return CHIP_8_OPERATION__NOT_RECOGNIZED;
 			}
-			break;
 		}
 		case 0xF000:
 		{
 			part = FetchedInstruction & 0x00FF;
 			switch (part)
 			{
+				case 0x0000:
+				{
+					if (FetchedInstruction == 0xF000)
+						return CHIP_8_OPERATION__F000__LD_I_long;
+					return CHIP_8_OPERATION__NOT_RECOGNIZED;
+				}
+				case 0x0001:
+				{
+					return CHIP_8_OPERATION__Fn01__PLANE_n;
+				}
+				case 0x0002:
+				{
+					if (FetchedInstruction == 0xF002)
+						return CHIP_8_OPERATION__F002__AUDIO;
+					return CHIP_8_OPERATION__NOT_RECOGNIZED;
+				}
 				case 0x0007:
 				{
-					Instruction_Fx07__LD_Vx_DT(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__Fx07__LD_Vx_DT;
 				}
 				case 0x000A:
 				{
-					Instruction_Fx0A__LD_Vx_K(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__Fx0A__LD_Vx_K;
 				}
 				case 0x0015:
 				{
-					Instruction_Fx15__LD_DT_Vx(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__Fx15__LD_DT_Vx;
 				}
 				case 0x0018:
 				{
-					Instruction_Fx18__LD_ST_Vx(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__Fx18__LD_ST_Vx;
 				}
 				case 0x001E:
 				{
-					Instruction_Fx1E__ADD_I_Vx(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__Fx1E__ADD_I_Vx;
 				}
 				case 0x0029:
 				{
-					Instruction_Fx29__LD_F_Vx(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__Fx29__LD_F_Vx;
+				}
+				case 0x0030:
+				{
+					return CHIP_8_OPERATION__Fx30__LD_HF_Vx;
 				}
 				case 0x0033:
 				{
-					Instruction_Fx33__LD_B_Vx(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__Fx33__LD_B_Vx;
+				}
+				case 0x003A:
+				{
+					return CHIP_8_OPERATION__Fx3A__PITCH_Vx;
 				}
 				case 0x0055:
 				{
-					Instruction_Fx55__LD_I_Vx(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__Fx55__LD_I_Vx;
 				}
 				case 0x0065:
 				{
-					Instruction_Fx65__LD_Vx_I(FetchedInstruction);
-					break;
+					return CHIP_8_OPERATION__Fx65__LD_Vx_I;
+				}
+				case 0x0075:
+				{
+					return CHIP_8_OPERATION__Fx75__LD_R_Vx;
+				}
+				case 0x0085:
+				{
+					return CHIP_8_OPERATION__Fx85__LD_Vx_R;
 				}
 				default:
-					CurrentStatus = CHIP_8_ERROR_CODE__INSTRUCTION_NOT_RECOGNIZED;
+					return CHIP_8_OPERATION__NOT_RECOGNIZED;
 			}
-			break;
 		}
 	}
+	return CHIP_8_OPERATION__NOT_RECOGNIZED;
+}
+
+void CHIP_8::Instruction_NotRecognized(uint16_t FetchedInstruction)
+{
+	CurrentStatus = CHIP_8_ERROR_CODE__INSTRUCTION_NOT_RECOGNIZED;
 }
 
 void CHIP_8::Instruction_0nnn__SYS_addr(uint16_t FetchedInstruction)
@@ -493,21 +1483,137 @@ void CHIP_8::Instruction_0nnn__SYS_addr(uint16_t FetchedInstruction)
 	CurrentStatus = CHIP_8_ERROR_CODE__INSTRUCTION_0NNN_NOT_IMPLEMENTED;
 }
 
-void CHIP_8::Instruction_00E0__CLS()
+//Scrolling moves whole rows in the low resolution mode too, in pixels of the current mode, as the XO-CHIP does; the SUPER-CHIP itself scrolled half as far there.
+//Only the selected planes move.
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_00Cn__SCD_nibble(uint16_t FetchedInstruction)
+{
+	unsigned int Height = HighResolution ? RESOLUTION_Y : LOW_RESOLUTION_Y;
+	unsigned int Distance = FetchedInstruction & 0x000F;
+	for (unsigned int Plane = 0; Plane < NUMBER_OF_PLANES; ++Plane)
+	{
+		if (!(Planes & (1 << Plane)))
+			continue;
+		memmove(Display[Plane][Distance], Display[Plane][0], (Height - Distance) * sizeof(Display[Plane][0]));
+		memset(Display[Plane][0], 0, Distance * sizeof(Display[Plane][0]));
+	}
+	DamagedRows = ALL_ROWS;
+	DrawingHappened = true;
+	StopReason = CHIP_8_STOP_REASON__DRAWING_HAPPENED;
+	AdvanceProgramCounter<Model>();
+}
+
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_00Dn__SCU_nibble(uint16_t FetchedInstruction)
+{
+	unsigned int Height = HighResolution ? RESOLUTION_Y : LOW_RESOLUTION_Y;
+	unsigned int Distance = FetchedInstruction & 0x000F;
+	for (unsigned int Plane = 0; Plane < NUMBER_OF_PLANES; ++Plane)
+	{
+		if (!(Planes & (1 << Plane)))
+			continue;
+		memmove(Display[Plane][0], Display[Plane][Distance], (Height - Distance) * sizeof(Display[Plane][0]));
+		memset(Display[Plane][Height - Distance], 0, Distance * sizeof(Display[Plane][0]));
+	}
+	DamagedRows = ALL_ROWS;
+	DrawingHappened = true;
+	StopReason = CHIP_8_STOP_REASON__DRAWING_HAPPENED;
+	AdvanceProgramCounter<Model>();
+}
+
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_00E0__CLS(uint16_t FetchedInstruction)
 {
-	ClearDisplay();
-	AdvanceProgramCounter();
+	ClearDisplay(Planes);
+	StopReason = CHIP_8_STOP_REASON__DRAWING_HAPPENED;
+	AdvanceProgramCounter<Model>();
 }
 
-void CHIP_8::Instruction_00EE__RET()
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_00EE__RET(uint16_t FetchedInstruction)
 {
 	PopStack();
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
+}
+
+//The row is shifted a word at a time, carrying the pixels that cross into the next word.
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_00FB__SCR(uint16_t FetchedInstruction)
+{
+	unsigned int Height = HighResolution ? RESOLUTION_Y : LOW_RESOLUTION_Y;
+	unsigned int Words = HighResolution ? DISPLAY_WORDS : 1;
+	for (unsigned int Plane = 0; Plane < NUMBER_OF_PLANES; ++Plane)
+	{
+		if (!(Planes & (1 << Plane)))
+			continue;
+		for (unsigned int y = 0; y < Height; ++y)
+		{
+			uint64_t* Row = Display[Plane][y];
+			for (unsigned int i = Words - 1; i > 0; --i)
+			{
+				Row[i] = (Row[i] >> 4) | (Row[i - 1] << 60);
+			}
+			Row[0] >>= 4;
+		}
+	}
+	DamagedRows = ALL_ROWS;
+	DrawingHappened = true;
+	StopReason = CHIP_8_STOP_REASON__DRAWING_HAPPENED;
+	AdvanceProgramCounter<Model>();
+}
+
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_00FC__SCL(uint16_t FetchedInstruction)
+{
+	unsigned int Height = HighResolution ? RESOLUTION_Y : LOW_RESOLUTION_Y;
+	unsigned int Words = HighResolution ? DISPLAY_WORDS : 1;
+	for (unsigned int Plane = 0; Plane < NUMBER_OF_PLANES; ++Plane)
+	{
+		if (!(Planes & (1 << Plane)))
+			continue;
+		for (unsigned int y = 0; y < Height; ++y)
+		{
+			uint64_t* Row = Display[Plane][y];
+			for (unsigned int i = 0; i < (Words - 1); ++i)
+			{
+				Row[i] = (Row[i] << 4) | (Row[i + 1] >> 60);
+			}
+			Row[Words - 1] <<= 4;
+		}
+	}
+	DamagedRows = ALL_ROWS;
+	DrawingHappened = true;
+	StopReason = CHIP_8_STOP_REASON__DRAWING_HAPPENED;
+	AdvanceProgramCounter<Model>();
+}
+
+void CHIP_8::Instruction_00FD__EXIT(uint16_t FetchedInstruction)
+{
+	CurrentStatus = CHIP_8_ERROR_CODE__PROGRAM_EXITED;
+}
+
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_00FE__LOW(uint16_t FetchedInstruction)
+{
+	SetResolution(false);
+	StopReason = CHIP_8_STOP_REASON__DRAWING_HAPPENED;
+	AdvanceProgramCounter<Model>();
+}
+
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_00FF__HIGH(uint16_t FetchedInstruction)
+{
+	SetResolution(true);
+	StopReason = CHIP_8_STOP_REASON__DRAWING_HAPPENED;
+	AdvanceProgramCounter<Model>();
 }
 
 void CHIP_8::Instruction_1nnn__JP_addr(uint16_t FetchedInstruction)
 {
+	unsigned int Jump = Register_PC;
 	Register_PC = FetchedInstruction & 0x0FFF;
+	if ((Register_PC <= Jump) && ((Jump - Register_PC) < (2 * MAX_IDLE_LOOP_LENGTH)))
+		CheckIdleLoop(Register_Vx, Register_PC, Jump);
 }
 
 void CHIP_8::Instruction_2nnn__CALL_addr(uint16_t FetchedInstruction)
@@ -516,24 +1622,27 @@ void CHIP_8::Instruction_2nnn__CALL_addr(uint16_t FetchedInstruction)
 	Register_PC = FetchedInstruction & 0x0FFF;
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_3xnn__SE_Vx_byte(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
 	if(Register_Vx[Vx] == (FetchedInstruction & 0x00FF))
-		AdvanceProgramCounter();
-	AdvanceProgramCounter();
+		SkipInstruction<Profile, Model>();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_4xnn__SNE_Vx_byte(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
 	if (Register_Vx[Vx] != (FetchedInstruction & 0x00FF))
-		AdvanceProgramCounter();
-	AdvanceProgramCounter();
+		SkipInstruction<Profile, Model>();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_5xy0__SE_Vx_Vy(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
@@ -541,26 +1650,70 @@ void CHIP_8::Instruction_5xy0__SE_Vx_Vy(uint16_t FetchedInstruction)
 	unsigned int Vy = FetchedInstruction & 0x00F0;
 	Vy >>= 4;
 	if(Register_Vx[Vx] == Register_Vx[Vy])
-		AdvanceProgramCounter();
-	AdvanceProgramCounter();
+		SkipInstruction<Profile, Model>();
+	AdvanceProgramCounter<Model>();
+}
+
+//Stores Vx to Vy from I on, in that order even when x is above y. Unlike Fx55, I is left unchanged.
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_5xy2__LD_I_Vx_Vy(uint16_t FetchedInstruction)
+{
+	unsigned int Vx = FetchedInstruction & 0x0F00;
+	Vx >>= 8;
+	unsigned int Vy = FetchedInstruction & 0x00F0;
+	Vy >>= 4;
+	unsigned int Count = ((Vx <= Vy) ? (Vy - Vx) : (Vx - Vy)) + 1;
+	unsigned int Start = Register_I;
+	for (unsigned int i = 0; i < Count; ++i)
+	{
+		if (!IsMemoryAccessSafe<Profile, Model>())
+			return;
+		StoreMemory<Profile>(Register_Vx[(Vx <= Vy) ? (Vx + i) : (Vx - i)]);
+		++Register_I;
+	}
+	Register_I = Start;
+	AdvanceProgramCounter<Model>();
+}
+
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_5xy3__LD_Vx_Vy_I(uint16_t FetchedInstruction)
+{
+	unsigned int Vx = FetchedInstruction & 0x0F00;
+	Vx >>= 8;
+	unsigned int Vy = FetchedInstruction & 0x00F0;
+	Vy >>= 4;
+	unsigned int Count = ((Vx <= Vy) ? (Vy - Vx) : (Vx - Vy)) + 1;
+	unsigned int Start = Register_I;
+	for (unsigned int i = 0; i < Count; ++i)
+	{
+		if (!IsMemoryAccessSafe<Profile, Model>())
+			return;
+		Register_Vx[(Vx <= Vy) ? (Vx + i) : (Vx - i)] = Memory[Register_I];
+		++Register_I;
+	}
+	Register_I = Start;
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_6xnn__LD_Vx_byte(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
 	Register_Vx[Vx] = FetchedInstruction & 0x00FF;
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_7xnn__ADD_Vx_byte(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
 	Register_Vx[Vx] += FetchedInstruction & 0x00FF;
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_8xy0__LD_Vx_Vy(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
@@ -568,9 +1721,10 @@ void CHIP_8::Instruction_8xy0__LD_Vx_Vy(uint16_t FetchedInstruction)
 	unsigned int Vy = FetchedInstruction & 0x00F0;
 	Vy >>= 4;
 	Register_Vx[Vx] = Register_Vx[Vy];
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_8xy1__OR_Vx_Vy(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
@@ -578,9 +1732,12 @@ void CHIP_8::Instruction_8xy1__OR_Vx_Vy(uint16_t FetchedInstruction)
 	unsigned int Vy = FetchedInstruction & 0x00F0;
 	Vy >>= 4;
 	Register_Vx[Vx] |= Register_Vx[Vy];
-	AdvanceProgramCounter();
+	if (CHIP_8_QUIRK_POLICY<Profile>::LOGIC_RESETS_VF)
+		Register_Vx[0xF] = 0;
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_8xy2__AND_Vx_Vy(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
@@ -588,9 +1745,12 @@ void CHIP_8::Instruction_8xy2__AND_Vx_Vy(uint16_t FetchedInstruction)
 	unsigned int Vy = FetchedInstruction & 0x00F0;
 	Vy >>= 4;
 	Register_Vx[Vx] &= Register_Vx[Vy];
-	AdvanceProgramCounter();
+	if (CHIP_8_QUIRK_POLICY<Profile>::LOGIC_RESETS_VF)
+		Register_Vx[0xF] = 0;
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_8xy3__XOR_Vx_Vy(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
@@ -598,9 +1758,12 @@ void CHIP_8::Instruction_8xy3__XOR_Vx_Vy(uint16_t FetchedInstruction)
 	unsigned int Vy = FetchedInstruction & 0x00F0;
 	Vy >>= 4;
 	Register_Vx[Vx] ^= Register_Vx[Vy];
-	AdvanceProgramCounter();
+	if (CHIP_8_QUIRK_POLICY<Profile>::LOGIC_RESETS_VF)
+		Register_Vx[0xF] = 0;
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_8xy4__ADD_Vx_Vy(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
@@ -610,9 +1773,10 @@ void CHIP_8::Instruction_8xy4__ADD_Vx_Vy(uint16_t FetchedInstruction)
 	unsigned int Result = Register_Vx[Vx] + Register_Vx[Vy];
 	Register_Vx[Vx] = Result;
 	Register_Vx[0xF] = (Result > 0xFF) ? 1 : 0;
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_8xy5__SUB_Vx_Vy(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
@@ -622,33 +1786,25 @@ void CHIP_8::Instruction_8xy5__SUB_Vx_Vy(uint16_t FetchedInstruction)
 	unsigned int Flag = (Register_Vx[Vy] > Register_Vx[Vx]) ? 0 : 1;
 	Register_Vx[Vx] -= Register_Vx[Vy];
 	Register_Vx[0xF] = Flag;
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_8xy6__SHR_Vx_Vy(uint16_t FetchedInstruction)
 {
 //"Unfortunately an erroneous assumption about 8XY6 and 8XYE, the two shift instructions, seems to have crept into Chip-8 lore at some point. Most recent documentation on Chip-8 suggests these instructions shift VX rather than VY." - "Chip-8 on the COSMAC VIP: Arithmetic and Logic Instructions" by Laurence Scotford "https://laurencescotford.com/chip-8-on-the-cosmac-vip-arithmetic-and-logic-instructions/"
-#if INCORRECT_SHIFT_INSTRUCTIONS_VERSION == true
-	//corrupted version
-	unsigned int Vx = FetchedInstruction & 0x0F00;
-	Vx >>= 8;
-	unsigned int Flag = (Register_Vx[Vx] & 0b00000001) ? 1 : 0;
-	Register_Vx[Vx] >>= 1;
-	Register_Vx[0xF] = Flag;
-	AdvanceProgramCounter();
-#else
-	//correct version
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
 	unsigned int Vy = FetchedInstruction & 0x00F0;
 	Vy >>= 4;
-	unsigned int Flag = (Register_Vx[Vy] & 0b00000001) ? 1 : 0;
-	Register_Vx[Vx] = Register_Vx[Vy] >> 1;
+	unsigned int Source = CHIP_8_QUIRK_POLICY<Profile>::SHIFT_READS_VX ? Vx : Vy;
+	unsigned int Flag = (Register_Vx[Source] & 0b00000001) ? 1 : 0;
+	Register_Vx[Vx] = Register_Vx[Source] >> 1;
 	Register_Vx[0xF] = Flag;
-	AdvanceProgramCounter();
-#endif
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_8xy7__SUBN_Vx_Vy(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
@@ -658,33 +1814,25 @@ void CHIP_8::Instruction_8xy7__SUBN_Vx_Vy(uint16_t FetchedInstruction)
 	unsigned int Flag = (Register_Vx[Vx] > Register_Vx[Vy]) ? 0 : 1;
 	Register_Vx[Vx] = Register_Vx[Vy] - Register_Vx[Vx];
 	Register_Vx[0xF] = Flag;
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_8xyE__SHL_Vx_Vy(uint16_t FetchedInstruction)
 {
 //"Unfortunately an erroneous assumption about 8XY6 and 8XYE, the two shift instructions, seems to have crept into Chip-8 lore at some point. Most recent documentation on Chip-8 suggests these instructions shift VX rather than VY." - "Chip-8 on the COSMAC VIP: Arithmetic and Logic Instructions" by Laurence Scotford "https://laurencescotford.com/chip-8-on-the-cosmac-vip-arithmetic-and-logic-instructions/"
-#if INCORRECT_SHIFT_INSTRUCTIONS_VERSION == true
-	//corrupted version
-	unsigned int Vx = FetchedInstruction & 0x0F00;
-	Vx >>= 8;
-	unsigned int Flag = (Register_Vx[Vx] & 0b10000000) ? 1 : 0;
-	Register_Vx[Vx] <<= 1;
-	Register_Vx[0xF] = Flag;
-	AdvanceProgramCounter();
-#else
-	//correct version
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
 	unsigned int Vy = FetchedInstruction & 0x00F0;
 	Vy >>= 4;
-	unsigned int Flag = (Register_Vx[Vy] & 0b10000000) ? 1 : 0;
-	Register_Vx[Vx] = Register_Vx[Vy] << 1;
+	unsigned int Source = CHIP_8_QUIRK_POLICY<Profile>::SHIFT_READS_VX ? Vx : Vy;
+	unsigned int Flag = (Register_Vx[Source] & 0b10000000) ? 1 : 0;
+	Register_Vx[Vx] = Register_Vx[Source] << 1;
 	Register_Vx[0xF] = Flag;
-	AdvanceProgramCounter();
-#endif
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_9xy0__SNE_Vx_Vy(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
@@ -692,94 +1840,196 @@ void CHIP_8::Instruction_9xy0__SNE_Vx_Vy(uint16_t FetchedInstruction)
 	unsigned int Vy = FetchedInstruction & 0x00F0;
 	Vy >>= 4;
 	if (Register_Vx[Vx] != Register_Vx[Vy])
-		AdvanceProgramCounter();
-	AdvanceProgramCounter();
+		SkipInstruction<Profile, Model>();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_Annn__LD_I_addr(uint16_t FetchedInstruction)
 {
 	Register_I = (FetchedInstruction & 0x0FFF);
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_Bnnn__JP_V0_addr(uint16_t FetchedInstruction)
 {
-	Register_PC = (FetchedInstruction & 0x0FFF) + Register_Vx[0x0];
+	unsigned int Vx = CHIP_8_QUIRK_POLICY<Profile>::JUMP_ADDS_VX ? ((FetchedInstruction & 0x0F00) >> 8) : 0x0;
+	Register_PC = (FetchedInstruction & 0x0FFF) + Register_Vx[Vx];
+	if (Model == CHIP_8_MEMORY_MODEL__WRAPPED)
+		Register_PC &= MEMORY_SIZE - 1;
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_Cxnn__RND_Vx_byte(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
 	unsigned int Mask = FetchedInstruction & 0x00FF;
-	unsigned int Result = rand();
+	unsigned int Result = GenerateRandomByte();
 	Result &= Mask;
 	Register_Vx[Vx] = Result;
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_Dxyn__DRW_Vx_Vy_nibble(uint16_t FetchedInstruction)
 {
+#if CHIP_8_PROFILING == true
+	CHIP_8_PROFILE_TIMER Timer(ExecutionProfile.DrawSeconds);
+#endif
+	DrawingHappened = true;
+	StopReason = CHIP_8_STOP_REASON__DRAWING_HAPPENED;
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
 	unsigned int Vy = FetchedInstruction & 0x00F0;
 	Vy >>= 4;
-	unsigned int OrginX = Register_Vx[Vx] % RESOLUTION_X;
-	unsigned int OrginY = Register_Vx[Vy] % RESOLUTION_Y;
+	//Profiles without the SUPER-CHIP instructions never leave the low resolution mode nor draw 16x16 sprites, so they compile to the low resolution path alone.
+	bool High = CHIP_8_QUIRK_POLICY<Profile>::SUPER_CHIP_INSTRUCTIONS && HighResolution;
+	unsigned int Width = High ? RESOLUTION_X : LOW_RESOLUTION_X;
+	unsigned int Height = High ? RESOLUTION_Y : LOW_RESOLUTION_Y;
+	unsigned int OrginX = Register_Vx[Vx] & (Width - 1);
+	unsigned int OrginY = Register_Vx[Vy] & (Height - 1);
 	unsigned int Size = FetchedInstruction & 0x000F;
+	unsigned int SpriteWidth = 8;
+	if (CHIP_8_QUIRK_POLICY<Profile>::SUPER_CHIP_INSTRUCTIONS && (Size == 0))
+	{
+		Size = 16;
+		SpriteWidth = 16;
+	}
 	unsigned int Start = Register_I;
-	unsigned int Erase = 0;
-	for (unsigned int y = 0; y < Size; ++y)
+	uint64_t Erase = 0;
+	//The XO-CHIP draws on every selected plane, each taking the sprite data after the previous one's; the other profiles only ever draw on the first plane.
+	unsigned int SelectedPlanes = CHIP_8_QUIRK_POLICY<Profile>::XO_CHIP_INSTRUCTIONS ? Planes : 1;
+	unsigned int PlaneStart = Start;
+	for (unsigned int Plane = 0; Plane < NUMBER_OF_PLANES; ++Plane)
 	{
-		if ((OrginY + y) >= RESOLUTION_Y)
-			break;
-		Register_I = Start + y;
-		if (!IsMemoryAccessSafe())
-			return;
-		unsigned int Byte = Memory[Register_I];
-		for (unsigned int x = 0; x < 8; ++x)
+		if (!(SelectedPlanes & (1 << Plane)))
+			continue;
+		uint64_t (*Rows)[DISPLAY_WORDS] = Display[Plane];
+		for (unsigned int y = 0; y < Size; ++y)
 		{
-			if ((OrginX + x) >= RESOLUTION_X)
-				break;
-			if (Byte & 0b10000000)
+			unsigned int PositionY = OrginY + y;
+			if (PositionY >= Height)
+			{
+				if (!CHIP_8_QUIRK_POLICY<Profile>::SPRITES_WRAP)
+					break;
+				PositionY -= Height;
+			}
+			Register_I = PlaneStart + (y * (SpriteWidth / 8));
+			if (!IsMemoryAccessSafe<Profile, Model>())
+				return;
+			uint64_t Bits = Memory[Register_I];
+			if (SpriteWidth == 16)
+			{
+				++Register_I;
+				if (!IsMemoryAccessSafe<Profile, Model>())
+					return;
+				Bits = (Bits << 8) | Memory[Register_I];
+			}
+			uint64_t Sprite = Bits << (64 - SpriteWidth);
+			if (!High)
 			{
-				if (!(Display[OrginX + x][OrginY + y] = !Display[OrginX + x][OrginY + y]))
-					Erase = 1;
+				//Sprite pixels shifted past the right edge fall off the word, which clips them; wrapping rotates them back in on the left, the display being exactly one word wide.
+				uint64_t Row = Sprite >> OrginX;
+				if (CHIP_8_QUIRK_POLICY<Profile>::SPRITES_WRAP && (OrginX != 0))
+					Row |= Sprite << (LOW_RESOLUTION_X - OrginX);
+				if (Row != 0)
+					DamagedRows |= 1ull << PositionY;
+				Erase |= Rows[PositionY][0] & Row;
+				Rows[PositionY][0] ^= Row;
+			}
+			else
+			{
+				//The sprite covers the word its left edge is in and possibly the next one; past the last word it is clipped, or wraps around to the first.
+				unsigned int Word = OrginX / 64;
+				unsigned int Shift = OrginX % 64;
+				uint64_t Left = Sprite >> Shift;
+				uint64_t Right = (Shift != 0) ? (Sprite << (64 - Shift)) : 0;
+				unsigned int NextWord = Word + 1;
+				if (NextWord == DISPLAY_WORDS)
+				{
+					if (!CHIP_8_QUIRK_POLICY<Profile>::SPRITES_WRAP)
+						Right = 0;
+					NextWord = 0;
+				}
+				if ((Left | Right) != 0)
+					DamagedRows |= 1ull << PositionY;
+				Erase |= (Rows[PositionY][Word] & Left) | (Rows[PositionY][NextWord] & Right);
+				Rows[PositionY][Word] ^= Left;
+				Rows[PositionY][NextWord] ^= Right;
 			}
-			Byte <<= 1;
 		}
+		PlaneStart += Size * (SpriteWidth / 8);
 	}
-	Register_Vx[0xf] = Erase;
+	Register_Vx[0xf] = (Erase != 0) ? 1 : 0;
 	Register_I = Start;
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_Ex9E__SKP_Vx(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
-	if (Keypad[Register_Vx[Vx]])
-		AdvanceProgramCounter();
-	AdvanceProgramCounter();
+	if (Keypad[Register_Vx[Vx] & 0xF])
+		SkipInstruction<Profile, Model>();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_ExA1__SKNP_Vx(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
-	if (!Keypad[Register_Vx[Vx]])
-		AdvanceProgramCounter();
-	AdvanceProgramCounter();
+	if (!Keypad[Register_Vx[Vx] & 0xF])
+		SkipInstruction<Profile, Model>();
+	AdvanceProgramCounter<Model>();
+}
+
+//The address is the word after the instruction, which is skipped along with it.
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_F000__LD_I_long(uint16_t FetchedInstruction)
+{
+	Register_I = (Memory[Register_PC + 2] << 8) | Memory[Register_PC + 3];
+	AdvanceProgramCounter<Model>();
+	AdvanceProgramCounter<Model>();
+}
+
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_Fn01__PLANE_n(uint16_t FetchedInstruction)
+{
+	unsigned int Mask = FetchedInstruction & 0x0F00;
+	Mask >>= 8;
+	Planes = Mask & ALL_PLANES;
+	AdvanceProgramCounter<Model>();
+}
+
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_F002__AUDIO(uint16_t FetchedInstruction)
+{
+	unsigned int Start = Register_I;
+	for (unsigned int i = 0; i < AUDIO_PATTERN_SIZE; ++i)
+	{
+		if (!IsMemoryAccessSafe<Profile, Model>())
+			return;
+		AudioPattern[i] = Memory[Register_I];
+		++Register_I;
+	}
+	Register_I = Start;
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_Fx07__LD_Vx_DT(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
 	Register_Vx[Vx] = Timer_DT;
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_Fx0A__LD_Vx_K(uint16_t FetchedInstruction)
 {
 	if (ButtonHeld)
@@ -792,12 +2042,19 @@ void CHIP_8::Instruction_Fx0A__LD_Vx_K(uint16_t FetchedInstruction)
 			ButtonHeld = false;
 			Timer_ST = 0;
 			SoundEmitted = false;
-			AdvanceProgramCounter();
+			AdvanceProgramCounter<Model>();
+		}
+		else
+		{
+			StopReason = CHIP_8_STOP_REASON__WAITING_FOR_KEY;
+			WaitingForKey = true;
 		}
 		Timer_ST = 255;
 	}
 	else
 	{
+		StopReason = CHIP_8_STOP_REASON__WAITING_FOR_KEY;
+		WaitingForKey = true;
 		for (unsigned int i = 0; i < NUMBER_OF_BUTTONS; ++i)
 		{
 			if (Keypad[i])
@@ -812,14 +2069,16 @@ void CHIP_8::Instruction_Fx0A__LD_Vx_K(uint16_t FetchedInstruction)
 	}
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_Fx15__LD_DT_Vx(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
 	Timer_DT = Register_Vx[Vx];
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_Fx18__LD_ST_Vx(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
@@ -827,17 +2086,19 @@ void CHIP_8::Instruction_Fx18__LD_ST_Vx(uint16_t FetchedInstruction)
 	Timer_ST = Register_Vx[Vx];
 	if (Timer_ST > 1)		//"It should be noted that in the COSMAC VIP manual, it was made clear that the minimum value that the timer will respond to is 02. Thus, setting the timer to a value of 01 would have no audible effect." - "Mastering CHIP‐8" by Matthew Mikolay "https://github.com/mattmikolay/chip-8/wiki/Mastering-CHIP%E2%80%908"
 		SoundEmitted = true;
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_Fx1E__ADD_I_Vx(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
 	Register_I += Register_Vx[Vx];
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_Fx29__LD_F_Vx(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
@@ -846,92 +2107,113 @@ void CHIP_8::Instruction_Fx29__LD_F_Vx(uint16_t FetchedInstruction)
 	{
 		Register_I = FONT_AREA_START_ADDRESS + (SIZE_OF_FONT_SPRITES * Register_Vx[Vx]);
 	}
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
+}
+
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_Fx30__LD_HF_Vx(uint16_t FetchedInstruction)
+{
+	unsigned int Vx = FetchedInstruction & 0x0F00;
+	Vx >>= 8;
+	if (Register_Vx[Vx] < NUMBER_OF_FONT_SPRITES)
+	{
+		Register_I = BIG_FONT_AREA_START_ADDRESS + (SIZE_OF_BIG_FONT_SPRITES * Register_Vx[Vx]);
+	}
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_Fx33__LD_B_Vx(uint16_t FetchedInstruction)
 {
 	unsigned int Vx = FetchedInstruction & 0x0F00;
 	Vx >>= 8;
 	unsigned int Start = Register_I;
 	unsigned int Value = Register_Vx[Vx];
-	if (!IsMemoryAccessSafe())
+	if (!IsMemoryAccessSafe<Profile, Model>())
 		return;
-	Memory[Register_I] = Value / 100;
+	StoreMemory<Profile>(Value / 100);
 	Value %= 100;
 	++Register_I;
-	if (!IsMemoryAccessSafe())
+	if (!IsMemoryAccessSafe<Profile, Model>())
 		return;
-	Memory[Register_I] = Value / 10;
+	StoreMemory<Profile>(Value / 10);
 	Value %= 10;
 	++Register_I;
-	if (!IsMemoryAccessSafe())
+	if (!IsMemoryAccessSafe<Profile, Model>())
 		return;
-	Memory[Register_I] = Value;
+	StoreMemory<Profile>(Value);
 	Register_I = Start;
-	AdvanceProgramCounter();
+	AdvanceProgramCounter<Model>();
+}
+
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_Fx3A__PITCH_Vx(uint16_t FetchedInstruction)
+{
+	unsigned int Vx = FetchedInstruction & 0x0F00;
+	Vx >>= 8;
+	Pitch = Register_Vx[Vx];
+	AdvanceProgramCounter<Model>();
 }
 
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
 void CHIP_8::Instruction_Fx55__LD_I_Vx(uint16_t FetchedInstruction)
 {
 //"Erik Bryntse’s S-CHIP documentation incorrectly implies this instruction does not modify the I register. Certain S-CHIP-compatible emulators may implement this instruction in this manner." - "CHIP‐8 Instruction Set" by Matthew Mikolay "https://github.com/mattmikolay/chip-8/wiki/CHIP%E2%80%908-Instruction-Set"
-#if INCORRECT_MEMORY_INSTRUCTIONS_VERSION == true
-	//corrupted version
 	unsigned int Range = FetchedInstruction & 0x0F00;
 	Range >>= 8;
 	unsigned int Start = Register_I;
 	for (unsigned int Vx = 0; Vx <= Range; ++Vx)
 	{
-		if (!IsMemoryAccessSafe())
+		if (!IsMemoryAccessSafe<Profile, Model>())
 			return;
-		Memory[Register_I] = Register_Vx[Vx];
+		StoreMemory<Profile>(Register_Vx[Vx]);
 		++Register_I;
 	}
-	Register_I = Start;
-	AdvanceProgramCounter();
-#else
-	//correct version
+	if (CHIP_8_QUIRK_POLICY<Profile>::MEMORY_LEAVES_I)
+		Register_I = Start;
+	AdvanceProgramCounter<Model>();
+}
+
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_Fx65__LD_Vx_I(uint16_t FetchedInstruction)
+{
+//"Erik Bryntse’s S-CHIP documentation incorrectly implies this instruction does not modify the I register. Certain S-CHIP-compatible emulators may implement this instruction in this manner." - "CHIP‐8 Instruction Set" by Matthew Mikolay "https://github.com/mattmikolay/chip-8/wiki/CHIP%E2%80%908-Instruction-Set"
 	unsigned int Range = FetchedInstruction & 0x0F00;
 	Range >>= 8;
+	unsigned int Start = Register_I;
 	for (unsigned int Vx = 0; Vx <= Range; ++Vx)
 	{
-		if (!IsMemoryAccessSafe())
+		if (!IsMemoryAccessSafe<Profile, Model>())
 			return;
-		Memory[Register_I] = Register_Vx[Vx];
+		Register_Vx[Vx] = Memory[Register_I];
 		++Register_I;
 	}
-	AdvanceProgramCounter();
-#endif
+	if (CHIP_8_QUIRK_POLICY<Profile>::MEMORY_LEAVES_I)
+		Register_I = Start;
+	AdvanceProgramCounter<Model>();
 }
 
-void CHIP_8::Instruction_Fx65__LD_Vx_I(uint16_t FetchedInstruction)
+//The SUPER-CHIP had 8 user flags; all 16 registers fit, as on the XO-CHIP. They are cleared on reset, so runs do not depend on the programs run before them.
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_Fx75__LD_R_Vx(uint16_t FetchedInstruction)
 {
-//"Erik Bryntse’s S-CHIP documentation incorrectly implies this instruction does not modify the I register. Certain S-CHIP-compatible emulators may implement this instruction in this manner." - "CHIP‐8 Instruction Set" by Matthew Mikolay "https://github.com/mattmikolay/chip-8/wiki/CHIP%E2%80%908-Instruction-Set"
-#if INCORRECT_MEMORY_INSTRUCTIONS_VERSION == true
-	//corrupted version
 	unsigned int Range = FetchedInstruction & 0x0F00;
 	Range >>= 8;
-	unsigned int Start = Register_I;
 	for (unsigned int Vx = 0; Vx <= Range; ++Vx)
 	{
-		if (!IsMemoryAccessSafe())
-			return;
-		Register_Vx[Vx] = Memory[Register_I];
-		++Register_I;
+		Register_RPL[Vx] = Register_Vx[Vx];
 	}
-	Register_I = Start;
-	AdvanceProgramCounter();
-#else
-	//correct version
+	AdvanceProgramCounter<Model>();
+}
+
+template<CHIP_8_MEMORY_MODEL Model>
+void CHIP_8::Instruction_Fx85__LD_Vx_R(uint16_t FetchedInstruction)
+{
 	unsigned int Range = FetchedInstruction & 0x0F00;
 	Range >>= 8;
 	for (unsigned int Vx = 0; Vx <= Range; ++Vx)
 	{
-		if (!IsMemoryAccessSafe())
-			return;
-		Register_Vx[Vx] = Memory[Register_I];
-		++Register_I;
+		Register_Vx[Vx] = Register_RPL[Vx];
 	}
-	AdvanceProgramCounter();
-#endif
-}
\ No newline at end of file
+	AdvanceProgramCounter<Model>();
+}
@@ -1,17 +1,159 @@
 #pragma once
-#define INCORRECT_SHIFT_INSTRUCTIONS_VERSION false
-#define INCORRECT_MEMORY_INSTRUCTIONS_VERSION false
+#include <cstddef>
 #include <cstdint>
 
-enum CHIP_8_ERROR_CODE { CHIP_8_ERROR_CODE__STATUS_OK, CHIP_8_ERROR_CODE__RESET, CHIP_8_ERROR_CODE__PROGRAM_TOO_BIG, CHIP_8_ERROR_CODE__OUT_OF_BOUNDS_MEMORY_ACCESS, CHIP_8_ERROR_CODE__INSTRUCTION_NOT_RECOGNIZED, CHIP_8_ERROR_CODE__INSTRUCTION_0NNN_NOT_IMPLEMENTED, CHIP_8_ERROR_CODE__STACK_OVERFLOW, CHIP_8_ERROR_CODE__STACK_UNDERFLOW };
+enum CHIP_8_ERROR_CODE { CHIP_8_ERROR_CODE__STATUS_OK, CHIP_8_ERROR_CODE__RESET, CHIP_8_ERROR_CODE__PROGRAM_TOO_BIG, CHIP_8_ERROR_CODE__OUT_OF_BOUNDS_MEMORY_ACCESS, CHIP_8_ERROR_CODE__INSTRUCTION_NOT_RECOGNIZED, CHIP_8_ERROR_CODE__INSTRUCTION_0NNN_NOT_IMPLEMENTED, CHIP_8_ERROR_CODE__STACK_OVERFLOW, CHIP_8_ERROR_CODE__STACK_UNDERFLOW, CHIP_8_ERROR_CODE__PROGRAM_EXITED };
+
+enum CHIP_8_OPERATION { CHIP_8_OPERATION__NOT_DECODED, CHIP_8_OPERATION__NOT_RECOGNIZED, CHIP_8_OPERATION__0nnn__SYS_addr, CHIP_8_OPERATION__00Cn__SCD_nibble, CHIP_8_OPERATION__00Dn__SCU_nibble, CHIP_8_OPERATION__00E0__CLS, CHIP_8_OPERATION__00EE__RET, CHIP_8_OPERATION__00FB__SCR, CHIP_8_OPERATION__00FC__SCL, CHIP_8_OPERATION__00FD__EXIT, CHIP_8_OPERATION__00FE__LOW, CHIP_8_OPERATION__00FF__HIGH, CHIP_8_OPERATION__1nnn__JP_addr, CHIP_8_OPERATION__2nnn__CALL_addr, CHIP_8_OPERATION__3xnn__SE_Vx_byte, CHIP_8_OPERATION__4xnn__SNE_Vx_byte, CHIP_8_OPERATION__5xy0__SE_Vx_Vy, CHIP_8_OPERATION__5xy2__LD_I_Vx_Vy, CHIP_8_OPERATION__5xy3__LD_Vx_Vy_I, CHIP_8_OPERATION__6xnn__LD_Vx_byte, CHIP_8_OPERATION__7xnn__ADD_Vx_byte, CHIP_8_OPERATION__8xy0__LD_Vx_Vy, CHIP_8_OPERATION__8xy1__OR_Vx_Vy, CHIP_8_OPERATION__8xy2__AND_Vx_Vy, CHIP_8_OPERATION__8xy3__XOR_Vx_Vy, CHIP_8_OPERATION__8xy4__ADD_Vx_Vy, CHIP_8_OPERATION__8xy5__SUB_Vx_Vy, CHIP_8_OPERATION__8xy6__SHR_Vx_Vy, CHIP_8_OPERATION__8xy7__SUBN_Vx_Vy, CHIP_8_OPERATION__8xyE__SHL_Vx_Vy, CHIP_8_OPERATION__9xy0__SNE_Vx_Vy, CHIP_8_OPERATION__Annn__LD_I_addr, CHIP_8_OPERATION__Bnnn__JP_V0_addr, CHIP_8_OPERATION__Cxnn__RND_Vx_byte, CHIP_8_OPERATION__Dxyn__DRW_Vx_Vy_nibble, CHIP_8_OPERATION__Ex9E__SKP_Vx, CHIP_8_OPERATION__ExA1__SKNP_Vx, CHIP_8_OPERATION__F000__LD_I_long, CHIP_8_OPERATION__Fn01__PLANE_n, CHIP_8_OPERATION__F002__AUDIO, CHIP_8_OPERATION__Fx07__LD_Vx_DT, CHIP_8_OPERATION__Fx0A__LD_Vx_K, CHIP_8_OPERATION__Fx15__LD_DT_Vx, CHIP_8_OPERATION__Fx18__LD_ST_Vx, CHIP_8_OPERATION__Fx1E__ADD_I_Vx, CHIP_8_OPERATION__Fx29__LD_F_Vx, CHIP_8_OPERATION__Fx30__LD_HF_Vx, CHIP_8_OPERATION__Fx33__LD_B_Vx, CHIP_8_OPERATION__Fx3A__PITCH_Vx, CHIP_8_OPERATION__Fx55__LD_I_Vx, CHIP_8_OPERATION__Fx65__LD_Vx_I, CHIP_8_OPERATION__Fx75__LD_R_Vx, CHIP_8_OPERATION__Fx85__LD_Vx_R, CHIP_8_OPERATION__NUMBER_OF_OPERATIONS };
+
+//IDLE_LOOP only passes from the engines to ExecuteInstructions, which fast-forwards the loop; nothing public returns it.
+enum CHIP_8_STOP_REASON { CHIP_8_STOP_REASON__BUDGET_EXHAUSTED, CHIP_8_STOP_REASON__ERROR, CHIP_8_STOP_REASON__WAITING_FOR_KEY, CHIP_8_STOP_REASON__DRAWING_HAPPENED, CHIP_8_STOP_REASON__IDLE_LOOP };
+
+enum CHIP_8_ENGINE { CHIP_8_ENGINE__SWITCH, CHIP_8_ENGINE__THREADED, CHIP_8_ENGINE__JIT };
+
+enum CHIP_8_QUIRKS { CHIP_8_QUIRKS__DEFAULT, CHIP_8_QUIRKS__COSMAC_VIP, CHIP_8_QUIRKS__SUPER_CHIP, CHIP_8_QUIRKS__XO_CHIP, CHIP_8_QUIRKS__NUMBER_OF_PROFILES };
+
+//How the handlers and engines guard memory. STRICT checks PC and I before every access and stops the machine with CHIP_8_ERROR_CODE__OUT_OF_BOUNDS_MEMORY_ACCESS on
+//one past the end, which is what diagnosing a faulty program wants. WRAPPED masks addresses to the memory instead, PC to the code area and I to the profile's memory,
+//so the hot path has no bounds checks at all; the byte after the code area is still within Memory, so fetches from its last address need none either.
+enum CHIP_8_MEMORY_MODEL { CHIP_8_MEMORY_MODEL__STRICT, CHIP_8_MEMORY_MODEL__WRAPPED, CHIP_8_MEMORY_MODEL__NUMBER_OF_MODELS };
+
+//Behaviour that differs between the machines programs were written for. Every profile is a specialization, so the handlers and engines built from it test nothing at run time.
+//SHIFT_READS_VX: 8xy6 and 8xyE shift Vx in place instead of storing the shifted Vy in Vx.
+//MEMORY_LEAVES_I: Fx55 and Fx65 leave I unchanged instead of leaving it past the last register transferred.
+//JUMP_ADDS_VX: Bnnn jumps to nnn plus Vx, x being the highest digit of nnn, instead of nnn plus V0.
+//SPRITES_WRAP: sprite pixels past an edge of the display reappear on the opposite edge instead of being clipped.
+//LOGIC_RESETS_VF: 8xy1, 8xy2 and 8xy3 clear VF.
+//SUPER_CHIP_INSTRUCTIONS: 00Cn, 00FB to 00FF, Fx30, Fx75 and Fx85 are recognized and Dxy0 draws a 16x16 sprite instead of nothing.
+//XO_CHIP_INSTRUCTIONS: 00Dn, 5xy2, 5xy3, F000 NNNN, Fn01, F002 and Fx3A are recognized, sprites and scrolling act on the selected planes, and skips step over F000 NNNN whole.
+//MEMORY_SIZE: bytes I can address, and the largest program plus PROGRAM_AREA_START_ADDRESS. Code only runs from the first CHIP_8::MEMORY_SIZE bytes either way.
+template<CHIP_8_QUIRKS Profile> struct CHIP_8_QUIRK_POLICY;
+
+//The behaviour this interpreter has always had: the original definitions of the shift and memory instructions, without the VIP's flag reset.
+template<> struct CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__DEFAULT>
+{
+	static const bool SHIFT_READS_VX = false;
+	static const bool MEMORY_LEAVES_I = false;
+	static const bool JUMP_ADDS_VX = false;
+	static const bool SPRITES_WRAP = false;
+	static const bool LOGIC_RESETS_VF = false;
+	static const bool SUPER_CHIP_INSTRUCTIONS = false;
+	static const bool XO_CHIP_INSTRUCTIONS = false;
+	static const unsigned int MEMORY_SIZE = 0x1000;
+};
+
+template<> struct CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__COSMAC_VIP>
+{
+	static const bool SHIFT_READS_VX = false;
+	static const bool MEMORY_LEAVES_I = false;
+	static const bool JUMP_ADDS_VX = false;
+	static const bool SPRITES_WRAP = false;
+	static const bool LOGIC_RESETS_VF = true;
+	static const bool SUPER_CHIP_INSTRUCTIONS = false;
+	static const bool XO_CHIP_INSTRUCTIONS = false;
+	static const unsigned int MEMORY_SIZE = 0x1000;
+};
+
+template<> struct CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__SUPER_CHIP>
+{
+	static const bool SHIFT_READS_VX = true;
+	static const bool MEMORY_LEAVES_I = true;
+	static const bool JUMP_ADDS_VX = true;
+	static const bool SPRITES_WRAP = false;
+	static const bool LOGIC_RESETS_VF = false;
+	static const bool SUPER_CHIP_INSTRUCTIONS = true;
+	static const bool XO_CHIP_INSTRUCTIONS = false;
+	static const unsigned int MEMORY_SIZE = 0x1000;
+};
+
+template<> struct CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__XO_CHIP>
+{
+	static const bool SHIFT_READS_VX = false;
+	static const bool MEMORY_LEAVES_I = false;
+	static const bool JUMP_ADDS_VX = false;
+	static const bool SPRITES_WRAP = true;
+	static const bool LOGIC_RESETS_VF = false;
+	static const bool SUPER_CHIP_INSTRUCTIONS = true;
+	static const bool XO_CHIP_INSTRUCTIONS = true;
+	static const unsigned int MEMORY_SIZE = 0x10000;
+};
+
+//One entry per memory address, filled the first time the address is executed and cleared whenever one of its two bytes is written.
+struct CHIP_8_DECODED_INSTRUCTION
+{
+	uint16_t Instruction;
+	uint16_t nnn;
+	uint8_t Operation;
+	uint8_t x;
+	uint8_t y;
+	uint8_t n;
+	uint8_t nn;
+};
+
+//Native code compiled from the run of instructions starting at one address. Blocks with no code mark addresses whose first instruction has to be interpreted.
+struct CHIP_8_JIT_BLOCK
+{
+	void* Code;
+	uint16_t NumberOfInstructions;
+	bool Compiled;
+};
+
+//Build with CHIP_8_PROFILING defined as true to have every CHIP_8 collect a CHIP_8_PROFILE. Otherwise none of it is compiled in.
+#ifndef CHIP_8_PROFILING
+#define CHIP_8_PROFILING false
+#endif
+
+//Where a machine spent its time since it was reset. Instructions are counted as they run, by operation and by the address they ran from, which also keeps the operation
+//last run there; idle loop passes that were skipped rather than run are not counted. Host time is taken around the engines, per frame, and around every Dxyn.
+//Lanes of a CHIP_8_BATCH are run by the batch itself, so only their drawing time is taken.
+struct CHIP_8_PROFILE
+{
+	static const unsigned int NUMBER_OF_ADDRESSES = 0x1000;
+
+	uint64_t Operations[CHIP_8_OPERATION__NUMBER_OF_OPERATIONS];
+	uint64_t Addresses[NUMBER_OF_ADDRESSES];
+	uint8_t AddressOperations[NUMBER_OF_ADDRESSES];
+	uint64_t Frames;
+	double Seconds;
+	double DrawSeconds;
+	double LongestFrameSeconds;
+};
+
+struct CHIP_8_SNAPSHOT;
+class CHIP_8_TRACE;
 
 class CHIP_8
 {
+	friend class CHIP_8_BATCH;
+	friend struct CHIP_8_SNAPSHOT;
+	friend class CHIP_8_ANALYSIS;
 	private:
 		CHIP_8_ERROR_CODE CurrentStatus;
+		CHIP_8_ENGINE Engine;
+		CHIP_8_QUIRKS Quirks;
+		CHIP_8_MEMORY_MODEL MemoryModel;
+		CHIP_8_STOP_REASON StopReason;
+		uint64_t ExecutedInstructions;
 
+		//A short loop jumping back on itself that only reads the delay timer and the keys, and leaves the registers as they were, repeats until a timer tick or input
+		//event, neither of which happens while instructions run. ExecuteInstructions counts its remaining iterations as executed instead of running them.
+		static const unsigned int MAX_IDLE_LOOP_LENGTH = 8;
+		unsigned int IdleLoopLength;
+		uint64_t IdleInstructions;
+
+		//While a trace is attached, every engine gives way to ExecuteTraced.
+		CHIP_8_TRACE* Trace;
+
+#if CHIP_8_PROFILING == true
+		CHIP_8_PROFILE ExecutionProfile;
+		void ProfileInstruction(unsigned int);
+#endif
+
+		//Code runs from the first MEMORY_SIZE bytes, all the memory most profiles have. The rest is only there for the XO-CHIP's data, which I reaches with F000 NNNN.
+		//Memory past the profile's size is always zero, so resets and snapshots only touch the profile's memory and the classic profiles never pay for the rest.
 		static const unsigned int MEMORY_SIZE = 0x1000;
-		uint8_t Memory[MEMORY_SIZE];
+		static const unsigned int EXTENDED_MEMORY_SIZE = 0x10000;
+		uint8_t Memory[EXTENDED_MEMORY_SIZE];
 
 		static const unsigned int STACK_SIZE = 16;
 		uint16_t Stack[STACK_SIZE];
@@ -20,6 +162,9 @@ class CHIP_8
 		static const unsigned int NUMBER_OF_FONT_SPRITES = 16;
 		static const unsigned int SIZE_OF_FONT_SPRITES = 5;
 		static const uint8_t Font[NUMBER_OF_FONT_SPRITES][SIZE_OF_FONT_SPRITES];
+		static const uint16_t BIG_FONT_AREA_START_ADDRESS = FONT_AREA_START_ADDRESS + (NUMBER_OF_FONT_SPRITES * SIZE_OF_FONT_SPRITES);
+		static const unsigned int SIZE_OF_BIG_FONT_SPRITES = 10;
+		static const uint8_t BigFont[NUMBER_OF_FONT_SPRITES][SIZE_OF_BIG_FONT_SPRITES];
 
 		static const uint16_t PROGRAM_AREA_START_ADDRESS = 0x200;
 
@@ -28,6 +173,9 @@ class CHIP_8
 
 		uint16_t Register_I;
 
+		//User flags of the HP 48, which Fx75 and Fx85 save the registers to and load them from.
+		uint8_t Register_RPL[NUMBER_OF_GENERAL_REGISTERS];
+
 		uint16_t Register_PC;
 		uint8_t Register_SP;
 
@@ -35,69 +183,236 @@ class CHIP_8
 		uint8_t Timer_ST;
 		bool SoundEmitted;
 
+		//The XO-CHIP's 1-bit samples, played most significant bit first and looped while the sound timer runs, at a rate set by Pitch.
+		static const unsigned int AUDIO_PATTERN_SIZE = 16;
+		uint8_t AudioPattern[AUDIO_PATTERN_SIZE];
+		uint8_t Pitch;
+
 		static const unsigned int NUMBER_OF_BUTTONS = 16;
 		bool Keypad[NUMBER_OF_BUTTONS];
 		bool ButtonHeld;
 		unsigned int HeldButton;
+		//Set when Fx0A stops to wait. Only a change of the keypad can let it finish, so it is not run again until PressButton or UnpressButton changes a button.
+		bool WaitingForKey;
+
+		//xorshift64* generator for Cxnn. Reset restarts it from the seed, so a seeded program replays identically.
+		uint64_t RandomSeed;
+		uint64_t RandomState;
 
 	public:
-		static const unsigned int RESOLUTION_X = 0x40;
-		static const unsigned int RESOLUTION_Y = 0x20;
+		//The largest display, the SUPER-CHIP's high resolution mode; programs start in the low resolution mode, which uses its top left quarter.
+		static const unsigned int RESOLUTION_X = 0x80;
+		static const unsigned int RESOLUTION_Y = 0x40;
+		static const unsigned int LOW_RESOLUTION_X = 0x40;
+		static const unsigned int LOW_RESOLUTION_Y = 0x20;
+		static const unsigned int DISPLAY_WORDS = RESOLUTION_X / 64;
+		//The XO-CHIP draws on two planes; the others only ever use the first.
+		static const unsigned int NUMBER_OF_PLANES = 2;
 	private:
-		bool Display[RESOLUTION_X][RESOLUTION_Y];
+		//DISPLAY_WORDS words per row, the leftmost pixel in the most significant bit of the first one. The low resolution mode only uses the first word of the first
+		//LOW_RESOLUTION_Y rows, and everything outside the current mode is kept clear, so it draws exactly as it did before the high resolution mode existed.
+		uint64_t Display[NUMBER_OF_PLANES][RESOLUTION_Y][DISPLAY_WORDS];
+		bool HighResolution;
+		//Bit p is set when plane p is selected for drawing, clearing and scrolling. Only Fn01 changes it from the first plane alone.
+		static const uint8_t ALL_PLANES = (1 << NUMBER_OF_PLANES) - 1;
+		uint8_t Planes;
 		bool DrawingHappened;
+		//Bit y is set when row y changed since the last call to GetDamagedRows.
+		static const uint64_t ALL_ROWS = (RESOLUTION_Y < 64) ? ((1ull << RESOLUTION_Y) - 1) : ~0ull;
+		uint64_t DamagedRows;
+
+		CHIP_8_DECODED_INSTRUCTION DecodedInstructions[MEMORY_SIZE];
+		typedef void (CHIP_8::*INSTRUCTION_HANDLER)(uint16_t);
+		static const INSTRUCTION_HANDLER InstructionHandlers[CHIP_8_MEMORY_MODEL__NUMBER_OF_MODELS][CHIP_8_QUIRKS__NUMBER_OF_PROFILES][CHIP_8_OPERATION__NUMBER_OF_OPERATIONS];
+		//The row of InstructionHandlers built for the selected memory model and quirk profile.
+		const INSTRUCTION_HANDLER* Handlers;
+		typedef unsigned int (CHIP_8::*ENGINE_FUNCTION)(unsigned int);
+		static const ENGINE_FUNCTION SwitchEngines[CHIP_8_MEMORY_MODEL__NUMBER_OF_MODELS];
+		static const ENGINE_FUNCTION ThreadedEngines[CHIP_8_MEMORY_MODEL__NUMBER_OF_MODELS][CHIP_8_QUIRKS__NUMBER_OF_PROFILES];
+		static const ENGINE_FUNCTION JitEngines[CHIP_8_MEMORY_MODEL__NUMBER_OF_MODELS][CHIP_8_QUIRKS__NUMBER_OF_PROFILES];
+
+		static const unsigned int JIT_CODE_SIZE = 0x40000;
+		static const unsigned int JIT_MAX_BLOCK_LENGTH = 64;
+		CHIP_8_JIT_BLOCK* JitBlocks;
+		uint8_t* JitCoverage;
+		uint8_t* JitCode;
+		unsigned int JitCodeUsed;
 
 		void Reset();
 		void LoadFonts();
-		void AdvanceProgramCounter();
+		void UpdateTimers(unsigned int);
+		template<CHIP_8_MEMORY_MODEL Model> void AdvanceProgramCounter();
 		void PushStack();
 		void PopStack();
-		bool IsMemoryAccessSafe();
-		void ClearDisplay();
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> bool IsMemoryAccessSafe();
+		template<CHIP_8_QUIRKS Profile> void StoreMemory(uint8_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void SkipInstruction();
+		void WrapAddresses();
+		void ClearDisplay(unsigned int);
+		void SetResolution(bool);
+		uint8_t GenerateRandomByte();
+		void InvalidateDecodedInstructions();
+		void InvalidateDecodedInstruction(unsigned int);
+		void DecodeInstructionAt(unsigned int);
+		static void FillDecodedInstruction(CHIP_8_DECODED_INSTRUCTION&, uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void FetchInstruction();
 		void FetchInstruction();
-		void InstructionSwitch(uint16_t);
+		void CheckIdleLoop(const uint8_t*, unsigned int, unsigned int);
+		bool ContinueWaitingForKey();
+		unsigned int ExecuteInstructions(unsigned int);
+		template<CHIP_8_MEMORY_MODEL Model> unsigned int ExecuteSwitch(unsigned int);
+		unsigned int ExecuteTraced(unsigned int);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> unsigned int ExecuteThreaded(unsigned int);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> unsigned int ExecuteJit(unsigned int);
+		bool StartJit();
+		void StopJit();
+		void FlushJit();
+		template<CHIP_8_QUIRKS Profile> void CompileBlock(unsigned int);
+		void Instruction_NotRecognized(uint16_t);
 		void Instruction_0nnn__SYS_addr(uint16_t);
-		void Instruction_00E0__CLS();
-		void Instruction_00EE__RET();
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_00Cn__SCD_nibble(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_00Dn__SCU_nibble(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_00E0__CLS(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_00EE__RET(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_00FB__SCR(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_00FC__SCL(uint16_t);
+		void Instruction_00FD__EXIT(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_00FE__LOW(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_00FF__HIGH(uint16_t);
 		void Instruction_1nnn__JP_addr(uint16_t);
 		void Instruction_2nnn__CALL_addr(uint16_t);
-		void Instruction_3xnn__SE_Vx_byte(uint16_t);
-		void Instruction_4xnn__SNE_Vx_byte(uint16_t);
-		void Instruction_5xy0__SE_Vx_Vy(uint16_t);
-		void Instruction_6xnn__LD_Vx_byte(uint16_t);
-		void Instruction_7xnn__ADD_Vx_byte(uint16_t);
-		void Instruction_8xy0__LD_Vx_Vy(uint16_t);
-		void Instruction_8xy1__OR_Vx_Vy(uint16_t);
-		void Instruction_8xy2__AND_Vx_Vy(uint16_t);
-		void Instruction_8xy3__XOR_Vx_Vy(uint16_t);
-		void Instruction_8xy4__ADD_Vx_Vy(uint16_t);
-		void Instruction_8xy5__SUB_Vx_Vy(uint16_t);
-		void Instruction_8xy6__SHR_Vx_Vy(uint16_t);
-		void Instruction_8xy7__SUBN_Vx_Vy(uint16_t);
-		void Instruction_8xyE__SHL_Vx_Vy(uint16_t);
-		void Instruction_9xy0__SNE_Vx_Vy(uint16_t);
-		void Instruction_Annn__LD_I_addr(uint16_t);
-		void Instruction_Bnnn__JP_V0_addr(uint16_t);
-		void Instruction_Cxnn__RND_Vx_byte(uint16_t);
-		void Instruction_Dxyn__DRW_Vx_Vy_nibble(uint16_t);
-		void Instruction_Ex9E__SKP_Vx(uint16_t);
-		void Instruction_ExA1__SKNP_Vx(uint16_t);
-		void Instruction_Fx07__LD_Vx_DT(uint16_t);
-		void Instruction_Fx0A__LD_Vx_K(uint16_t);
-		void Instruction_Fx15__LD_DT_Vx(uint16_t);
-		void Instruction_Fx18__LD_ST_Vx(uint16_t);
-		void Instruction_Fx1E__ADD_I_Vx(uint16_t);
-		void Instruction_Fx29__LD_F_Vx(uint16_t);
-		void Instruction_Fx33__LD_B_Vx(uint16_t);
-		void Instruction_Fx55__LD_I_Vx(uint16_t);
-		void Instruction_Fx65__LD_Vx_I(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_3xnn__SE_Vx_byte(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_4xnn__SNE_Vx_byte(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_5xy0__SE_Vx_Vy(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_5xy2__LD_I_Vx_Vy(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_5xy3__LD_Vx_Vy_I(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_6xnn__LD_Vx_byte(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_7xnn__ADD_Vx_byte(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_8xy0__LD_Vx_Vy(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_8xy1__OR_Vx_Vy(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_8xy2__AND_Vx_Vy(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_8xy3__XOR_Vx_Vy(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_8xy4__ADD_Vx_Vy(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_8xy5__SUB_Vx_Vy(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_8xy6__SHR_Vx_Vy(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_8xy7__SUBN_Vx_Vy(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_8xyE__SHL_Vx_Vy(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_9xy0__SNE_Vx_Vy(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_Annn__LD_I_addr(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_Bnnn__JP_V0_addr(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_Cxnn__RND_Vx_byte(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_Dxyn__DRW_Vx_Vy_nibble(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_Ex9E__SKP_Vx(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_ExA1__SKNP_Vx(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_F000__LD_I_long(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_Fn01__PLANE_n(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_F002__AUDIO(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_Fx07__LD_Vx_DT(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_Fx0A__LD_Vx_K(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_Fx15__LD_DT_Vx(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_Fx18__LD_ST_Vx(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_Fx1E__ADD_I_Vx(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_Fx29__LD_F_Vx(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_Fx30__LD_HF_Vx(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_Fx33__LD_B_Vx(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_Fx3A__PITCH_Vx(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_Fx55__LD_I_Vx(uint16_t);
+		template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model> void Instruction_Fx65__LD_Vx_I(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_Fx75__LD_R_Vx(uint16_t);
+		template<CHIP_8_MEMORY_MODEL Model> void Instruction_Fx85__LD_Vx_R(uint16_t);
 	public:
-		CHIP_8();
+		CHIP_8(CHIP_8_ENGINE = CHIP_8_ENGINE__SWITCH);
+		CHIP_8(const CHIP_8&) = delete;
+		CHIP_8& operator=(const CHIP_8&) = delete;
+		~CHIP_8();
 		bool GetSound();
+		const uint8_t* GetAudioPattern();
+		uint8_t GetPitch();
+		double GetAudioSampleRate();
 		void PressButton(unsigned int);
 		void UnpressButton(unsigned int);
+		bool IsWaitingForKey();
 		bool DidDrawingHappen();
 		bool GetDisplay(unsigned int, unsigned int);
+		unsigned int GetResolutionX();
+		unsigned int GetResolutionY();
+		unsigned int GetNumberOfPlanes();
+		const uint64_t* GetDisplayRows(unsigned int = 0);
+		uint64_t GetDamagedRows();
 		CHIP_8_ERROR_CODE LoadProgram(char*, unsigned int);
+		CHIP_8_ERROR_CODE LoadProgram(const uint8_t*, unsigned int, const CHIP_8_DECODED_INSTRUCTION* = nullptr);
+		static unsigned int GetPredecodedLength(unsigned int);
+		static void PredecodeProgram(const uint8_t*, unsigned int, CHIP_8_DECODED_INSTRUCTION*);
 		CHIP_8_ERROR_CODE Step(unsigned int);
+		CHIP_8_STOP_REASON RunCycles(unsigned int);
+		CHIP_8_STOP_REASON RunFrame(unsigned int);
+		CHIP_8_ERROR_CODE GetStatus();
+		uint64_t GetExecutedInstructions();
+		uint64_t GetIdleInstructions();
+		uint8_t GetRegisterVx(unsigned int);
+		uint16_t GetRegisterI();
+		uint16_t GetRegisterPC();
+		uint8_t GetRegisterSP();
+		uint8_t GetTimerDT();
+		uint8_t GetTimerST();
+		void SetQuirks(CHIP_8_QUIRKS);
+		CHIP_8_QUIRKS GetQuirks();
+		void SetMemoryModel(CHIP_8_MEMORY_MODEL);
+		CHIP_8_MEMORY_MODEL GetMemoryModel();
+		unsigned int GetMemorySize();
+		void SetSeed(uint64_t);
+		uint64_t GetSeed();
+		uint64_t GetRandomState();
+		void SetRandomState(uint64_t);
+		void SaveSnapshot(CHIP_8_SNAPSHOT&);
+		bool RestoreSnapshot(const CHIP_8_SNAPSHOT&);
+		void SetTrace(CHIP_8_TRACE*);
+		static CHIP_8_OPERATION DecodeInstruction(uint16_t);
+		static const char* GetOperationName(CHIP_8_OPERATION);
+#if CHIP_8_PROFILING == true
+		const CHIP_8_PROFILE& GetProfile();
+		void ClearProfile();
+#endif
+};
+
+//Complete machine state in a fixed layout that can be copied, hashed and stored as it is, in the byte order of the host. Fields are ordered by size so the layout has no
+//padding. Version changes whenever the layout or the meaning of a field does. Derived state, like decoded instructions, compiled blocks and damaged rows, is rebuilt on restore.
+//Memory comes last and only the profile's memory of it is part of the snapshot: GetSize bytes are saved, restored and stored, so a classic program's snapshot leaves out
+//the 60 KB only the XO-CHIP has.
+struct CHIP_8_SNAPSHOT
+{
+	static const uint32_t MAGIC = 0x53533843;	//"C8SS"
+	static const uint32_t VERSION = 5;
+
+	uint32_t Magic;
+	uint32_t Version;
+	uint64_t ExecutedInstructions;
+	uint64_t RandomSeed;
+	uint64_t RandomState;
+	uint64_t Display[CHIP_8::NUMBER_OF_PLANES][CHIP_8::RESOLUTION_Y][CHIP_8::DISPLAY_WORDS];
+	uint16_t Stack[CHIP_8::STACK_SIZE];
+	uint16_t Register_I;
+	uint16_t Register_PC;
+	uint8_t Register_Vx[CHIP_8::NUMBER_OF_GENERAL_REGISTERS];
+	uint8_t Register_RPL[CHIP_8::NUMBER_OF_GENERAL_REGISTERS];
+	uint8_t Keypad[CHIP_8::NUMBER_OF_BUTTONS];
+	uint8_t AudioPattern[CHIP_8::AUDIO_PATTERN_SIZE];
+	uint8_t Register_SP;
+	uint8_t Timer_DT;
+	uint8_t Timer_ST;
+	uint8_t SoundEmitted;
+	uint8_t ButtonHeld;
+	uint8_t HeldButton;
+	uint8_t WaitingForKey;
+	uint8_t DrawingHappened;
+	uint8_t Quirks;
+	uint8_t CurrentStatus;
+	uint8_t StopReason;
+	uint8_t HighResolution;
+	uint8_t Planes;
+	uint8_t Pitch;
+	uint8_t Reserved[6];
+	uint8_t Memory[CHIP_8::EXTENDED_MEMORY_SIZE];
+
+	size_t GetSize() const;
 };
\ No newline at end of file
@@ -0,0 +1,588 @@
+#include "Interpreter/CHIP-8_Analysis.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+//Everything a 16-bit I can hold.
+static const CHIP_8_ANALYSIS_RANGE AnyAddress = { 0, 0xFFFF };
+
+static CHIP_8_ANALYSIS_RANGE Join(CHIP_8_ANALYSIS_RANGE First, CHIP_8_ANALYSIS_RANGE Second)
+{
+	CHIP_8_ANALYSIS_RANGE Joined;
+	Joined.Lowest = (First.Lowest < Second.Lowest) ? First.Lowest : Second.Lowest;
+	Joined.Highest = (First.Highest > Second.Highest) ? First.Highest : Second.Highest;
+	return Joined;
+}
+
+//I plus an amount from Lowest to Highest. I is 16 bits wide, so a range that partly wraps around covers everything.
+static CHIP_8_ANALYSIS_RANGE Add(CHIP_8_ANALYSIS_RANGE Range, unsigned int Lowest, unsigned int Highest)
+{
+	Range.Lowest += Lowest;
+	Range.Highest += Highest;
+	if (Range.Lowest > AnyAddress.Highest)
+	{
+		Range.Lowest -= AnyAddress.Highest + 1;
+		Range.Highest -= AnyAddress.Highest + 1;
+	}
+	else if (Range.Highest > AnyAddress.Highest)
+		Range = AnyAddress;
+	return Range;
+}
+
+//Analyzes a program as LoadProgram would place it in a machine fresh from a reset.
+CHIP_8_ANALYSIS::CHIP_8_ANALYSIS(const uint8_t* Program, unsigned int Size, CHIP_8_QUIRKS Quirks) : mQuirks{ Quirks }
+{
+	memset(mMemory, 0, sizeof(mMemory));
+	for (unsigned int i = 0; i < CHIP_8::NUMBER_OF_FONT_SPRITES; ++i)
+	{
+		memcpy(&mMemory[CHIP_8::FONT_AREA_START_ADDRESS + (i * CHIP_8::SIZE_OF_FONT_SPRITES)], CHIP_8::Font[i], CHIP_8::SIZE_OF_FONT_SPRITES);
+		memcpy(&mMemory[CHIP_8::BIG_FONT_AREA_START_ADDRESS + (i * CHIP_8::SIZE_OF_BIG_FONT_SPRITES)], CHIP_8::BigFont[i], CHIP_8::SIZE_OF_BIG_FONT_SPRITES);
+	}
+	if (Size > (CHIP_8::MEMORY_SIZE - CHIP_8::PROGRAM_AREA_START_ADDRESS))
+		Size = CHIP_8::MEMORY_SIZE - CHIP_8::PROGRAM_AREA_START_ADDRESS;
+	memcpy(&mMemory[CHIP_8::PROGRAM_AREA_START_ADDRESS], Program, Size);
+	mProgramEnd = CHIP_8::PROGRAM_AREA_START_ADDRESS + Size;
+	Analyze();
+}
+
+//Analyzes the memory of a machine as it is now, from the start of the program and with I as a reset leaves it, whatever the machine has run since.
+CHIP_8_ANALYSIS::CHIP_8_ANALYSIS(const CHIP_8& Machine) : mQuirks{ Machine.Quirks }
+{
+	memcpy(mMemory, Machine.Memory, sizeof(mMemory));
+	mProgramEnd = CHIP_8::MEMORY_SIZE;
+	while ((mProgramEnd > CHIP_8::PROGRAM_AREA_START_ADDRESS) && (mMemory[mProgramEnd - 1] == 0))
+	{
+		--mProgramEnd;
+	}
+	Analyze();
+}
+
+void CHIP_8_ANALYSIS::Analyze()
+{
+	memset(mFlags, 0, sizeof(mFlags));
+	mInstructions.assign(CHIP_8::MEMORY_SIZE, INSTRUCTION());
+	mNumberOfInstructions = 0;
+	mNumberOfCodeBytes = 0;
+	mNumberOfOverwritableCodeBytes = 0;
+	mNumberOfUnrecognizedInstructions = 0;
+	switch (mQuirks)
+	{
+		case CHIP_8_QUIRKS__COSMAC_VIP:
+			Explore<CHIP_8_QUIRKS__COSMAC_VIP>();
+			FindWrites<CHIP_8_QUIRKS__COSMAC_VIP>();
+			break;
+		case CHIP_8_QUIRKS__SUPER_CHIP:
+			Explore<CHIP_8_QUIRKS__SUPER_CHIP>();
+			FindWrites<CHIP_8_QUIRKS__SUPER_CHIP>();
+			break;
+		case CHIP_8_QUIRKS__XO_CHIP:
+			Explore<CHIP_8_QUIRKS__XO_CHIP>();
+			FindWrites<CHIP_8_QUIRKS__XO_CHIP>();
+			break;
+		default:
+			Explore<CHIP_8_QUIRKS__DEFAULT>();
+			FindWrites<CHIP_8_QUIRKS__DEFAULT>();
+			break;
+	}
+	BuildBlocks();
+}
+
+//Fills the entry of the instruction at the address: what it is as the handlers of the profile would run it, and where control goes next. Successors that could not be
+//fetched, the word at them not being entirely within the memory code runs from, are left out, as running them stops the machine.
+template<CHIP_8_QUIRKS Profile>
+void CHIP_8_ANALYSIS::Decode(unsigned int Address)
+{
+	INSTRUCTION& Entry = mInstructions[Address];
+	Entry.Instruction = (mMemory[Address] << 8) | mMemory[Address + 1];
+	CHIP_8_OPERATION Operation = CHIP_8::DecodeInstruction(Entry.Instruction);
+	if (CHIP_8::InstructionHandlers[CHIP_8_MEMORY_MODEL__STRICT][Profile][Operation] == &CHIP_8::Instruction_NotRecognized)
+		Operation = CHIP_8_OPERATION__NOT_RECOGNIZED;
+	Entry.Operation = static_cast<uint8_t>(Operation);
+	Entry.Length = (Operation == CHIP_8_OPERATION__F000__LD_I_long) ? 4 : 2;
+	Entry.NumberOfSuccessors = 0;
+
+	unsigned int Next = Address + Entry.Length;
+	unsigned int Targets[2] = { Next, 0 };
+	unsigned int NumberOfTargets = 1;
+	switch (Operation)
+	{
+		case CHIP_8_OPERATION__NOT_RECOGNIZED:
+		case CHIP_8_OPERATION__0nnn__SYS_addr:
+		case CHIP_8_OPERATION__00FD__EXIT:
+			Entry.Exit = CHIP_8_ANALYSIS_EXIT__STOP;
+			NumberOfTargets = 0;
+			break;
+		case CHIP_8_OPERATION__00EE__RET:
+			Entry.Exit = CHIP_8_ANALYSIS_EXIT__RETURN;
+			NumberOfTargets = 0;
+			break;
+		case CHIP_8_OPERATION__Bnnn__JP_V0_addr:
+			Entry.Exit = CHIP_8_ANALYSIS_EXIT__COMPUTED_JUMP;
+			NumberOfTargets = 0;
+			break;
+		case CHIP_8_OPERATION__1nnn__JP_addr:
+			Entry.Exit = CHIP_8_ANALYSIS_EXIT__JUMP;
+			Targets[0] = Entry.Instruction & 0x0FFF;
+			break;
+		case CHIP_8_OPERATION__2nnn__CALL_addr:
+			Entry.Exit = CHIP_8_ANALYSIS_EXIT__CALL;
+			Targets[0] = Entry.Instruction & 0x0FFF;
+			Targets[1] = Next;
+			NumberOfTargets = 2;
+			break;
+		case CHIP_8_OPERATION__3xnn__SE_Vx_byte:
+		case CHIP_8_OPERATION__4xnn__SNE_Vx_byte:
+		case CHIP_8_OPERATION__5xy0__SE_Vx_Vy:
+		case CHIP_8_OPERATION__9xy0__SNE_Vx_Vy:
+		case CHIP_8_OPERATION__Ex9E__SKP_Vx:
+		case CHIP_8_OPERATION__ExA1__SKNP_Vx:
+			Entry.Exit = CHIP_8_ANALYSIS_EXIT__SKIP;
+			Targets[1] = Next + 2;
+			if (CHIP_8_QUIRK_POLICY<Profile>::XO_CHIP_INSTRUCTIONS && ((Next + 1) < CHIP_8::MEMORY_SIZE) && (mMemory[Next] == 0xF0) && (mMemory[Next + 1] == 0x00))
+				Targets[1] += 2;
+			NumberOfTargets = 2;
+			break;
+		default:
+			Entry.Exit = CHIP_8_ANALYSIS_EXIT__FALL_THROUGH;
+			break;
+	}
+	for (unsigned int i = 0; i < NumberOfTargets; ++i)
+	{
+		if ((Targets[i] + 1) < CHIP_8::MEMORY_SIZE)
+			Entry.Successors[Entry.NumberOfSuccessors++] = static_cast<uint16_t>(Targets[i]);
+	}
+}
+
+//Follows control and the range of I from the start of the program until neither changes anywhere.
+template<CHIP_8_QUIRKS Profile>
+void CHIP_8_ANALYSIS::Explore()
+{
+	std::vector<uint16_t> Work;
+	std::vector<bool> Waiting(CHIP_8::MEMORY_SIZE, false);
+	std::vector<uint16_t> ReturnAddresses;
+	std::vector<bool> IsReturnAddress(CHIP_8::MEMORY_SIZE, false);
+	CHIP_8_ANALYSIS_RANGE Returned = { 0, 0 };
+	bool AnyReturn = false;
+
+	auto Reach = [this, &Work, &Waiting](unsigned int Address, CHIP_8_ANALYSIS_RANGE I)
+	{
+		INSTRUCTION& Entry = mInstructions[Address];
+		if (!(mFlags[Address] & mFLAG_INSTRUCTION))
+		{
+			mFlags[Address] |= mFLAG_INSTRUCTION;
+			Decode<Profile>(Address);
+			Entry.I = I;
+			Entry.Refinements = 0;
+		}
+		else
+		{
+			CHIP_8_ANALYSIS_RANGE Joined = Join(Entry.I, I);
+			if ((Joined.Lowest == Entry.I.Lowest) && (Joined.Highest == Entry.I.Highest))
+				return;
+			if (++Entry.Refinements > mMAXIMUM_REFINEMENTS)
+			{
+				if (Joined.Lowest < Entry.I.Lowest)
+					Joined.Lowest = AnyAddress.Lowest;
+				if (Joined.Highest > Entry.I.Highest)
+					Joined.Highest = AnyAddress.Highest;
+			}
+			Entry.I = Joined;
+		}
+		if (!Waiting[Address])
+		{
+			Waiting[Address] = true;
+			Work.push_back(static_cast<uint16_t>(Address));
+		}
+	};
+
+	Reach(CHIP_8::PROGRAM_AREA_START_ADDRESS, { 0, 0 });
+	mFlags[CHIP_8::PROGRAM_AREA_START_ADDRESS] |= mFLAG_BLOCK_START;
+	while (!Work.empty())
+	{
+		unsigned int Address = Work.back();
+		Work.pop_back();
+		Waiting[Address] = false;
+		const INSTRUCTION& Entry = mInstructions[Address];
+		unsigned int x = (Entry.Instruction & 0x0F00) >> 8;
+
+		CHIP_8_ANALYSIS_RANGE I = Entry.I;
+		switch (Entry.Operation)
+		{
+			case CHIP_8_OPERATION__Annn__LD_I_addr:
+				I.Lowest = I.Highest = Entry.Instruction & 0x0FFF;
+				break;
+			case CHIP_8_OPERATION__F000__LD_I_long:
+				I.Lowest = I.Highest = (mMemory[(Address + 2) % CHIP_8::MEMORY_SIZE] << 8) | mMemory[(Address + 3) % CHIP_8::MEMORY_SIZE];
+				break;
+			case CHIP_8_OPERATION__Fx1E__ADD_I_Vx:
+				I = Add(I, 0, 0xFF);
+				break;
+			//Registers past the font leave I as it was.
+			case CHIP_8_OPERATION__Fx29__LD_F_Vx:
+				I = Join(I, { CHIP_8::FONT_AREA_START_ADDRESS, CHIP_8::FONT_AREA_START_ADDRESS + ((CHIP_8::NUMBER_OF_FONT_SPRITES - 1) * CHIP_8::SIZE_OF_FONT_SPRITES) });
+				break;
+			case CHIP_8_OPERATION__Fx30__LD_HF_Vx:
+				I = Join(I, { CHIP_8::BIG_FONT_AREA_START_ADDRESS, CHIP_8::BIG_FONT_AREA_START_ADDRESS + ((CHIP_8::NUMBER_OF_FONT_SPRITES - 1) * CHIP_8::SIZE_OF_BIG_FONT_SPRITES) });
+				break;
+			//Without extended memory, only the machines whose I was within it get past them.
+			case CHIP_8_OPERATION__Fx55__LD_I_Vx:
+			case CHIP_8_OPERATION__Fx65__LD_Vx_I:
+				if ((CHIP_8_QUIRK_POLICY<Profile>::MEMORY_SIZE <= AnyAddress.Highest) && (I.Lowest < CHIP_8_QUIRK_POLICY<Profile>::MEMORY_SIZE) && (I.Highest >= CHIP_8_QUIRK_POLICY<Profile>::MEMORY_SIZE))
+					I.Highest = CHIP_8_QUIRK_POLICY<Profile>::MEMORY_SIZE - 1;
+				if (!CHIP_8_QUIRK_POLICY<Profile>::MEMORY_LEAVES_I)
+					I = Add(I, x + 1, x + 1);
+				break;
+			default:
+				break;
+		}
+
+		if (Entry.Exit == CHIP_8_ANALYSIS_EXIT__RETURN)
+		{
+			CHIP_8_ANALYSIS_RANGE Joined = AnyReturn ? Join(Returned, I) : I;
+			if (AnyReturn && (Joined.Lowest == Returned.Lowest) && (Joined.Highest == Returned.Highest))
+				continue;
+			Returned = Joined;
+			AnyReturn = true;
+			for (uint16_t ReturnAddress : ReturnAddresses)
+			{
+				Reach(ReturnAddress, Returned);
+			}
+			continue;
+		}
+		if (Entry.Exit == CHIP_8_ANALYSIS_EXIT__COMPUTED_JUMP)
+		{
+			mFlags[Address] |= mFLAG_COMPUTED_JUMP;
+			continue;
+		}
+		if (Entry.NumberOfSuccessors == 0)
+			continue;
+
+		if (Entry.Exit == CHIP_8_ANALYSIS_EXIT__CALL)
+		{
+			uint16_t Target = Entry.Successors[0];
+			mFlags[Target] |= mFLAG_CALL_TARGET | mFLAG_BLOCK_START;
+			Reach(Target, I);
+			if (Entry.NumberOfSuccessors == 2)
+			{
+				uint16_t ReturnAddress = Entry.Successors[1];
+				mFlags[ReturnAddress] |= mFLAG_BLOCK_START;
+				if (!IsReturnAddress[ReturnAddress])
+				{
+					IsReturnAddress[ReturnAddress] = true;
+					ReturnAddresses.push_back(ReturnAddress);
+				}
+				if (AnyReturn)
+					Reach(ReturnAddress, Returned);
+			}
+			continue;
+		}
+		for (unsigned int i = 0; i < Entry.NumberOfSuccessors; ++i)
+		{
+			if (Entry.Exit != CHIP_8_ANALYSIS_EXIT__FALL_THROUGH)
+				mFlags[Entry.Successors[i]] |= mFLAG_BLOCK_START;
+			Reach(Entry.Successors[i], I);
+		}
+	}
+
+	for (unsigned int Address = 0; Address < CHIP_8::MEMORY_SIZE; ++Address)
+	{
+		if (!(mFlags[Address] & mFLAG_INSTRUCTION))
+			continue;
+		++mNumberOfInstructions;
+		if (mInstructions[Address].Operation == CHIP_8_OPERATION__NOT_RECOGNIZED)
+			++mNumberOfUnrecognizedInstructions;
+		for (unsigned int i = 0; (i < mInstructions[Address].Length) && ((Address + i) < CHIP_8::MEMORY_SIZE); ++i)
+		{
+			mFlags[Address + i] |= mFLAG_CODE;
+		}
+	}
+	for (unsigned int Address = 0; Address < CHIP_8::MEMORY_SIZE; ++Address)
+	{
+		if (mFlags[Address] & mFLAG_CODE)
+			++mNumberOfCodeBytes;
+	}
+}
+
+//Works out the bytes every reachable memory write may store to, from the range of I it runs with, and marks the code among them.
+template<CHIP_8_QUIRKS Profile>
+void CHIP_8_ANALYSIS::FindWrites()
+{
+	mWrites.clear();
+	for (unsigned int Address = 0; Address < CHIP_8::MEMORY_SIZE; ++Address)
+	{
+		if (!(mFlags[Address] & mFLAG_INSTRUCTION))
+			continue;
+		const INSTRUCTION& Entry = mInstructions[Address];
+		unsigned int x = (Entry.Instruction & 0x0F00) >> 8;
+		unsigned int y = (Entry.Instruction & 0x00F0) >> 4;
+		unsigned int Length;
+		switch (Entry.Operation)
+		{
+			case CHIP_8_OPERATION__Fx33__LD_B_Vx:
+				Length = 3;
+				break;
+			case CHIP_8_OPERATION__Fx55__LD_I_Vx:
+				Length = x + 1;
+				break;
+			case CHIP_8_OPERATION__5xy2__LD_I_Vx_Vy:
+				Length = ((x <= y) ? (y - x) : (x - y)) + 1;
+				break;
+			default:
+				continue;
+		}
+
+		//Without extended memory, a write from past the end stops the machine instead.
+		CHIP_8_ANALYSIS_WRITE Write;
+		Write.Address = static_cast<uint16_t>(Address);
+		Write.Bytes = Add(Entry.I, 0, Length - 1);
+		Write.OverwritesCode = false;
+		if (CHIP_8_QUIRK_POLICY<Profile>::MEMORY_SIZE <= AnyAddress.Highest)
+		{
+			if (Entry.I.Lowest >= CHIP_8_QUIRK_POLICY<Profile>::MEMORY_SIZE)
+				continue;
+			Write.Bytes.Lowest = Entry.I.Lowest;
+			if (Write.Bytes.Highest >= CHIP_8_QUIRK_POLICY<Profile>::MEMORY_SIZE)
+				Write.Bytes.Highest = CHIP_8_QUIRK_POLICY<Profile>::MEMORY_SIZE - 1;
+		}
+		for (unsigned int Byte = Write.Bytes.Lowest; (Byte <= Write.Bytes.Highest) && (Byte < CHIP_8::MEMORY_SIZE); ++Byte)
+		{
+			mFlags[Byte] |= mFLAG_WRITTEN;
+			if (mFlags[Byte] & mFLAG_CODE)
+			{
+				mFlags[Byte] |= mFLAG_OVERWRITABLE;
+				Write.OverwritesCode = true;
+			}
+		}
+		mWrites.push_back(Write);
+	}
+	for (unsigned int Address = 0; Address < CHIP_8::MEMORY_SIZE; ++Address)
+	{
+		if (mFlags[Address] & mFLAG_OVERWRITABLE)
+			++mNumberOfOverwritableCodeBytes;
+	}
+}
+
+//Cuts the reachable instructions into blocks at every target of a jump, call, skip or return. Anything else is only reached from the instruction before it.
+void CHIP_8_ANALYSIS::BuildBlocks()
+{
+	mBlocks.clear();
+	mComputedJumps.clear();
+	for (unsigned int Address = 0; Address < CHIP_8::MEMORY_SIZE; ++Address)
+	{
+		if (mFlags[Address] & mFLAG_COMPUTED_JUMP)
+			mComputedJumps.push_back(static_cast<uint16_t>(Address));
+	}
+
+	for (unsigned int Start = 0; Start < CHIP_8::MEMORY_SIZE; ++Start)
+	{
+		if (!(mFlags[Start] & mFLAG_BLOCK_START) || !(mFlags[Start] & mFLAG_INSTRUCTION))
+			continue;
+		CHIP_8_ANALYSIS_BLOCK Block;
+		Block.Start = static_cast<uint16_t>(Start);
+		Block.NumberOfInstructions = 0;
+		unsigned int Address = Start;
+		for (;;)
+		{
+			const INSTRUCTION& Entry = mInstructions[Address];
+			++Block.NumberOfInstructions;
+			unsigned int Next = Address + Entry.Length;
+			if ((Entry.Exit != CHIP_8_ANALYSIS_EXIT__FALL_THROUGH) || (Next >= CHIP_8::MEMORY_SIZE) || !(mFlags[Next] & mFLAG_INSTRUCTION) || (mFlags[Next] & mFLAG_BLOCK_START))
+			{
+				Block.End = static_cast<uint16_t>(Next);
+				Block.Exit = static_cast<CHIP_8_ANALYSIS_EXIT>(Entry.Exit);
+				for (unsigned int i = 0; i < Entry.NumberOfSuccessors; ++i)
+				{
+					if (mFlags[Entry.Successors[i]] & mFLAG_INSTRUCTION)
+						Block.Successors.push_back(Entry.Successors[i]);
+				}
+				break;
+			}
+			Address = Next;
+		}
+		mBlocks.push_back(Block);
+	}
+}
+
+CHIP_8_QUIRKS CHIP_8_ANALYSIS::GetQuirks()
+{
+	return mQuirks;
+}
+
+uint8_t CHIP_8_ANALYSIS::GetFlags(unsigned int Address)
+{
+	if (Address < CHIP_8::MEMORY_SIZE)
+		return mFlags[Address];
+	return 0;
+}
+
+bool CHIP_8_ANALYSIS::IsCode(unsigned int Address)
+{
+	return (GetFlags(Address) & mFLAG_CODE) != 0;
+}
+
+//Ordered by start address.
+const std::vector<CHIP_8_ANALYSIS_BLOCK>& CHIP_8_ANALYSIS::GetBlocks()
+{
+	return mBlocks;
+}
+
+const std::vector<CHIP_8_ANALYSIS_WRITE>& CHIP_8_ANALYSIS::GetWrites()
+{
+	return mWrites;
+}
+
+const std::vector<uint16_t>& CHIP_8_ANALYSIS::GetComputedJumps()
+{
+	return mComputedJumps;
+}
+
+unsigned int CHIP_8_ANALYSIS::GetNumberOfInstructions()
+{
+	return mNumberOfInstructions;
+}
+
+unsigned int CHIP_8_ANALYSIS::GetNumberOfCodeBytes()
+{
+	return mNumberOfCodeBytes;
+}
+
+unsigned int CHIP_8_ANALYSIS::GetNumberOfOverwritableCodeBytes()
+{
+	return mNumberOfOverwritableCodeBytes;
+}
+
+unsigned int CHIP_8_ANALYSIS::GetNumberOfUnrecognizedInstructions()
+{
+	return mNumberOfUnrecognizedInstructions;
+}
+
+//Whether every instruction the program can run was found, which a computed jump rules out.
+bool CHIP_8_ANALYSIS::IsComplete()
+{
+	return mComputedJumps.empty();
+}
+
+bool CHIP_8_ANALYSIS::CanOverwriteCode()
+{
+	return mNumberOfOverwritableCodeBytes != 0;
+}
+
+//Every engine runs every program correctly; this picks the fastest that is safe to bet on. The JIT throws all its code away whenever code it compiled is written, which
+//the threaded engine pays for one instruction at a time, so the JIT is only chosen for programs known entirely, none of whose code can be written.
+CHIP_8_ENGINE CHIP_8_ANALYSIS::SuggestEngine()
+{
+	if (IsComplete() && !CanOverwriteCode())
+		return CHIP_8_ENGINE__JIT;
+	return CHIP_8_ENGINE__THREADED;
+}
+
+//The name of the operation with its operands filled in, as in "LD V3, #1F" for 631F.
+static std::string FormatInstruction(CHIP_8_OPERATION Operation, uint16_t Instruction, uint16_t Long)
+{
+	if ((Operation == CHIP_8_OPERATION__NOT_RECOGNIZED) || (Operation == CHIP_8_OPERATION__NOT_DECODED))
+		return CHIP_8::GetOperationName(Operation);
+	//Names start with the pattern of the instruction, as in "6xnn ".
+	const char* Name = CHIP_8::GetOperationName(Operation) + 5;
+	std::string Text;
+	char Operand[8];
+	while (*Name)
+	{
+		size_t Length = 0;
+		while (((Name[Length] >= 'A') && (Name[Length] <= 'Z')) || ((Name[Length] >= 'a') && (Name[Length] <= 'z')))
+		{
+			++Length;
+		}
+		if (Length == 0)
+		{
+			Text += *Name++;
+			continue;
+		}
+		std::string Word(Name, Length);
+		Name += Length;
+		if (Word == "Vx")
+			snprintf(Operand, sizeof(Operand), "V%X", (Instruction >> 8) & 0xF);
+		else if (Word == "Vy")
+			snprintf(Operand, sizeof(Operand), "V%X", (Instruction >> 4) & 0xF);
+		else if (Word == "byte")
+			snprintf(Operand, sizeof(Operand), "#%02X", Instruction & 0xFF);
+		else if (Word == "addr")
+			snprintf(Operand, sizeof(Operand), "%03X", Instruction & 0xFFF);
+		else if (Word == "nibble")
+			snprintf(Operand, sizeof(Operand), "%X", Instruction & 0xF);
+		else if (Word == "n")
+			snprintf(Operand, sizeof(Operand), "%X", (Instruction >> 8) & 0xF);
+		else if (Word == "long")
+			snprintf(Operand, sizeof(Operand), "%04X", Long);
+		else
+		{
+			Text += Word;
+			continue;
+		}
+		Text += Operand;
+	}
+	return Text;
+}
+
+//Disassembles the program: every reachable instruction with its operands, a label before every block, what the analysis found about it, and the bytes of the program
+//that are not code as data.
+void CHIP_8_ANALYSIS::WriteListing(std::ostream& Output)
+{
+	char Text[96];
+	unsigned int End = mProgramEnd;
+	for (unsigned int Address = CHIP_8::PROGRAM_AREA_START_ADDRESS; Address < CHIP_8::MEMORY_SIZE; ++Address)
+	{
+		if (mFlags[Address] & mFLAG_CODE)
+			End = (Address + 1 > End) ? (Address + 1) : End;
+	}
+
+	unsigned int Address = 0;
+	while (Address < End)
+	{
+		if (mFlags[Address] & mFLAG_INSTRUCTION)
+		{
+			const INSTRUCTION& Entry = mInstructions[Address];
+			if (mFlags[Address] & mFLAG_BLOCK_START)
+			{
+				snprintf(Text, sizeof(Text), "\nL%03X:%s\n", Address, (mFlags[Address] & mFLAG_CALL_TARGET) ? "  ; subroutine" : "");
+				Output << Text;
+			}
+			uint16_t Long = (Entry.Length == 4) ? static_cast<uint16_t>((mMemory[(Address + 2) % CHIP_8::MEMORY_SIZE] << 8) | mMemory[(Address + 3) % CHIP_8::MEMORY_SIZE]) : 0;
+			if (Entry.Length == 4)
+				snprintf(Text, sizeof(Text), "  %03X  %04X %04X  ", Address, Entry.Instruction, Long);
+			else
+				snprintf(Text, sizeof(Text), "  %03X  %04X       ", Address, Entry.Instruction);
+			std::string Line = Text + FormatInstruction(static_cast<CHIP_8_OPERATION>(Entry.Operation), Entry.Instruction, Long);
+
+			std::string Notes;
+			if (mFlags[Address] & mFLAG_COMPUTED_JUMP)
+				Notes += "; computed jump";
+			for (const CHIP_8_ANALYSIS_WRITE& Write : mWrites)
+			{
+				if (Write.Address != Address)
+					continue;
+				snprintf(Text, sizeof(Text), "; writes %03X-%03X%s", Write.Bytes.Lowest, Write.Bytes.Highest, Write.OverwritesCode ? ", code included" : "");
+				Notes += Text;
+			}
+			if (mFlags[Address] & mFLAG_OVERWRITABLE)
+				Notes += Notes.empty() ? "; may be overwritten" : ", may be overwritten";
+			if (!Notes.empty())
+				Line.append((Line.size() < 40) ? (40 - Line.size()) : 1, ' ') += Notes;
+			Output << Line << "\n";
+			Address += Entry.Length;
+		}
+		else if ((Address >= CHIP_8::PROGRAM_AREA_START_ADDRESS) && !(mFlags[Address] & mFLAG_CODE))
+		{
+			snprintf(Text, sizeof(Text), "  %03X  db", Address);
+			Output << Text;
+			for (unsigned int i = 0; (i < 8) && (Address < End) && !(mFlags[Address] & mFLAG_CODE); ++i, ++Address)
+			{
+				snprintf(Text, sizeof(Text), " %02X", mMemory[Address]);
+				Output << Text;
+			}
+			Output << "\n";
+		}
+		else
+			++Address;
+	}
+}
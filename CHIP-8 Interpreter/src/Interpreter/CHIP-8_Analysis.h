@@ -0,0 +1,103 @@
+#pragma once
+#include "Interpreter/CHIP-8.h"
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+//How control leaves an instruction, or the block it ends. CALL continues after the call once the subroutine returns; RETURN, COMPUTED_JUMP and STOP have no known successor.
+enum CHIP_8_ANALYSIS_EXIT { CHIP_8_ANALYSIS_EXIT__FALL_THROUGH, CHIP_8_ANALYSIS_EXIT__JUMP, CHIP_8_ANALYSIS_EXIT__CALL, CHIP_8_ANALYSIS_EXIT__SKIP, CHIP_8_ANALYSIS_EXIT__RETURN, CHIP_8_ANALYSIS_EXIT__COMPUTED_JUMP, CHIP_8_ANALYSIS_EXIT__STOP };
+
+//Addresses from Lowest to Highest, both included.
+struct CHIP_8_ANALYSIS_RANGE
+{
+	uint32_t Lowest;
+	uint32_t Highest;
+};
+
+//A run of instructions only entered at its first and only left after its last. End is the address after the last instruction.
+struct CHIP_8_ANALYSIS_BLOCK
+{
+	uint16_t Start;
+	uint16_t End;
+	uint16_t NumberOfInstructions;
+	CHIP_8_ANALYSIS_EXIT Exit;
+	std::vector<uint16_t> Successors;
+};
+
+//An Fx33, Fx55 or 5xy2 that can be reached, and every byte it may write.
+struct CHIP_8_ANALYSIS_WRITE
+{
+	uint16_t Address;
+	CHIP_8_ANALYSIS_RANGE Bytes;
+	bool OverwritesCode;
+};
+
+//Finds, without running it, the code a program can run from PROGRAM_AREA_START_ADDRESS on: every instruction reachable through fall-through, 1nnn, 2nnn and its return,
+//00EE and skips, decoded as the switch engine decodes it for the chosen quirk profile. Bnnn jumps to a register plus nnn, so its targets are left unknown and only flagged.
+//The range I can hold is followed along every path, from Annn, F000 NNNN, Fx1E and the memory instructions, so the bytes Fx33, Fx55 and 5xy2 may write are known;
+//where that range covers code, the program may modify itself. Returns are followed to every call's return address, as if any subroutine could return to any call.
+class CHIP_8_ANALYSIS
+{
+	private:
+		struct INSTRUCTION
+		{
+			uint16_t Instruction;
+			uint8_t Operation;
+			uint8_t Length;
+			uint8_t Exit;
+			uint8_t NumberOfSuccessors;
+			uint16_t Successors[2];
+			//Range of I before the instruction runs, over all the paths reaching it.
+			CHIP_8_ANALYSIS_RANGE I;
+			uint8_t Refinements;
+		};
+
+		//Times the range of I at an instruction may grow before it is widened to all it could become, which ends the analysis of loops moving I.
+		static const unsigned int mMAXIMUM_REFINEMENTS = 8;
+
+		CHIP_8_QUIRKS mQuirks;
+		uint8_t mMemory[CHIP_8::MEMORY_SIZE];
+		uint8_t mFlags[CHIP_8::MEMORY_SIZE];
+		std::vector<INSTRUCTION> mInstructions;
+		unsigned int mProgramEnd;
+		std::vector<CHIP_8_ANALYSIS_BLOCK> mBlocks;
+		std::vector<CHIP_8_ANALYSIS_WRITE> mWrites;
+		std::vector<uint16_t> mComputedJumps;
+		unsigned int mNumberOfInstructions;
+		unsigned int mNumberOfCodeBytes;
+		unsigned int mNumberOfOverwritableCodeBytes;
+		unsigned int mNumberOfUnrecognizedInstructions;
+
+		void Analyze();
+		template<CHIP_8_QUIRKS Profile> void Explore();
+		template<CHIP_8_QUIRKS Profile> void Decode(unsigned int);
+		template<CHIP_8_QUIRKS Profile> void FindWrites();
+		void BuildBlocks();
+
+	public:
+		static const uint8_t mFLAG_INSTRUCTION = 0x01;	//An instruction starts here.
+		static const uint8_t mFLAG_CODE = 0x02;			//Part of an instruction.
+		static const uint8_t mFLAG_BLOCK_START = 0x04;
+		static const uint8_t mFLAG_CALL_TARGET = 0x08;
+		static const uint8_t mFLAG_COMPUTED_JUMP = 0x10;	//A Bnnn starts here.
+		static const uint8_t mFLAG_WRITTEN = 0x20;		//Fx33, Fx55 or 5xy2 may write here.
+		static const uint8_t mFLAG_OVERWRITABLE = 0x40;	//Code that may be written.
+
+		CHIP_8_ANALYSIS(const uint8_t*, unsigned int, CHIP_8_QUIRKS);
+		CHIP_8_ANALYSIS(const CHIP_8&);
+		CHIP_8_QUIRKS GetQuirks();
+		uint8_t GetFlags(unsigned int);
+		bool IsCode(unsigned int);
+		const std::vector<CHIP_8_ANALYSIS_BLOCK>& GetBlocks();
+		const std::vector<CHIP_8_ANALYSIS_WRITE>& GetWrites();
+		const std::vector<uint16_t>& GetComputedJumps();
+		unsigned int GetNumberOfInstructions();
+		unsigned int GetNumberOfCodeBytes();
+		unsigned int GetNumberOfOverwritableCodeBytes();
+		unsigned int GetNumberOfUnrecognizedInstructions();
+		bool IsComplete();
+		bool CanOverwriteCode();
+		CHIP_8_ENGINE SuggestEngine();
+		void WriteListing(std::ostream&);
+};
@@ -0,0 +1,626 @@
+#include "Interpreter/CHIP-8_Batch.h"
+#include <chrono>
+#include <cstring>
+
+//Lanes are processed VECTOR_WIDTH at a time by the kernels. Without SSE2 every instruction takes the lane's own handler, which gives the same results more slowly.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CHIP_8_BATCH_VECTOR_WIDTH 32
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define CHIP_8_BATCH_VECTOR_WIDTH 16
+#else
+#define CHIP_8_BATCH_VECTOR_WIDTH 0
+#endif
+
+static const unsigned int LANE_PADDING = 32;
+
+//Runs between tries of the way of running measured slower, which programs changing what they do can make the faster one, and runs in a try. The interval doubles
+//with every try that does not switch, so a program for which one way is clearly better hardly pays for the tries. The first run after switching brings the other
+//way's data back into the caches and is not timed, so a try needs a few.
+static const unsigned int MINIMUM_PROBE_INTERVAL = 32;
+static const unsigned int MAXIMUM_PROBE_INTERVAL = 1024;
+static const unsigned int PROBE_RUNS = 3;
+
+#if CHIP_8_BATCH_VECTOR_WIDTH == 32
+typedef __m256i BATCH_VECTOR;
+static inline BATCH_VECTOR VectorLoad(const void* Source) { return _mm256_loadu_si256(static_cast<const __m256i*>(Source)); }
+static inline void VectorStore(void* Destination, BATCH_VECTOR Value) { _mm256_storeu_si256(static_cast<__m256i*>(Destination), Value); }
+static inline BATCH_VECTOR VectorBroadcast8(uint8_t Value) { return _mm256_set1_epi8(static_cast<char>(Value)); }
+static inline BATCH_VECTOR VectorBroadcast16(uint16_t Value) { return _mm256_set1_epi16(static_cast<short>(Value)); }
+static inline BATCH_VECTOR VectorAnd(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm256_and_si256(A, B); }
+static inline BATCH_VECTOR VectorAndNot(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm256_andnot_si256(A, B); }
+static inline BATCH_VECTOR VectorOr(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm256_or_si256(A, B); }
+static inline BATCH_VECTOR VectorXor(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm256_xor_si256(A, B); }
+static inline BATCH_VECTOR VectorAdd8(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm256_add_epi8(A, B); }
+static inline BATCH_VECTOR VectorSubtract8(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm256_sub_epi8(A, B); }
+static inline BATCH_VECTOR VectorAddSaturated8(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm256_adds_epu8(A, B); }
+static inline BATCH_VECTOR VectorMaximum8(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm256_max_epu8(A, B); }
+static inline BATCH_VECTOR VectorEqual8(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm256_cmpeq_epi8(A, B); }
+static inline BATCH_VECTOR VectorAdd16(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm256_add_epi16(A, B); }
+static inline BATCH_VECTOR VectorShiftRight16(BATCH_VECTOR A, int Count) { return _mm256_srl_epi16(A, _mm_cvtsi32_si128(Count)); }
+static inline bool VectorIsZero(BATCH_VECTOR A) { return _mm256_movemask_epi8(A) == 0; }
+//Bytes of one half of the lanes widened to words, zero extended for values and sign extended for masks.
+static inline BATCH_VECTOR VectorWiden(BATCH_VECTOR A, unsigned int Half) { return _mm256_cvtepu8_epi16(Half ? _mm256_extracti128_si256(A, 1) : _mm256_castsi256_si128(A)); }
+static inline BATCH_VECTOR VectorWidenMask(BATCH_VECTOR A, unsigned int Half) { return _mm256_cvtepi8_epi16(Half ? _mm256_extracti128_si256(A, 1) : _mm256_castsi256_si128(A)); }
+#elif CHIP_8_BATCH_VECTOR_WIDTH == 16
+typedef __m128i BATCH_VECTOR;
+static inline BATCH_VECTOR VectorLoad(const void* Source) { return _mm_loadu_si128(static_cast<const __m128i*>(Source)); }
+static inline void VectorStore(void* Destination, BATCH_VECTOR Value) { _mm_storeu_si128(static_cast<__m128i*>(Destination), Value); }
+static inline BATCH_VECTOR VectorBroadcast8(uint8_t Value) { return _mm_set1_epi8(static_cast<char>(Value)); }
+static inline BATCH_VECTOR VectorBroadcast16(uint16_t Value) { return _mm_set1_epi16(static_cast<short>(Value)); }
+static inline BATCH_VECTOR VectorAnd(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm_and_si128(A, B); }
+static inline BATCH_VECTOR VectorAndNot(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm_andnot_si128(A, B); }
+static inline BATCH_VECTOR VectorOr(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm_or_si128(A, B); }
+static inline BATCH_VECTOR VectorXor(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm_xor_si128(A, B); }
+static inline BATCH_VECTOR VectorAdd8(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm_add_epi8(A, B); }
+static inline BATCH_VECTOR VectorSubtract8(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm_sub_epi8(A, B); }
+static inline BATCH_VECTOR VectorAddSaturated8(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm_adds_epu8(A, B); }
+static inline BATCH_VECTOR VectorMaximum8(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm_max_epu8(A, B); }
+static inline BATCH_VECTOR VectorEqual8(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm_cmpeq_epi8(A, B); }
+static inline BATCH_VECTOR VectorAdd16(BATCH_VECTOR A, BATCH_VECTOR B) { return _mm_add_epi16(A, B); }
+static inline BATCH_VECTOR VectorShiftRight16(BATCH_VECTOR A, int Count) { return _mm_srl_epi16(A, _mm_cvtsi32_si128(Count)); }
+static inline bool VectorIsZero(BATCH_VECTOR A) { return _mm_movemask_epi8(A) == 0; }
+//Bytes of one half of the lanes widened to words, zero extended for values and sign extended for masks.
+static inline BATCH_VECTOR VectorWiden(BATCH_VECTOR A, unsigned int Half) { return Half ? _mm_unpackhi_epi8(A, _mm_setzero_si128()) : _mm_unpacklo_epi8(A, _mm_setzero_si128()); }
+static inline BATCH_VECTOR VectorWidenMask(BATCH_VECTOR A, unsigned int Half) { return Half ? _mm_unpackhi_epi8(A, A) : _mm_unpacklo_epi8(A, A); }
+#endif
+
+#if CHIP_8_BATCH_VECTOR_WIDTH != 0
+static inline BATCH_VECTOR VectorBlend(BATCH_VECTOR Mask, BATCH_VECTOR New, BATCH_VECTOR Old) { return VectorOr(VectorAnd(Mask, New), VectorAndNot(Mask, Old)); }
+#endif
+
+CHIP_8_BATCH::CHIP_8_BATCH(unsigned int RequestedLanes) : NumberOfLanes{ RequestedLanes }, ExecutedInstructions{ 0 }, SecondsRunning{ 0 }, LockstepCost{ 0 }, LaneByLaneCost{ 0 }, ProbeInterval{ MINIMUM_PROBE_INTERVAL }, RunsSinceProbe{ 0 }, RunsTimed{ 1 }, InLockstep{ true }, Quirks{ CHIP_8_QUIRKS__DEFAULT }
+{
+	NumberOfPaddedLanes = (NumberOfLanes + LANE_PADDING - 1) / LANE_PADDING * LANE_PADDING;
+	Lanes = new CHIP_8[NumberOfLanes];
+	Registers = new uint8_t[CHIP_8::NUMBER_OF_GENERAL_REGISTERS * NumberOfPaddedLanes]();
+	ProgramCounters = new uint16_t[NumberOfPaddedLanes]();
+	IndexRegisters = new uint16_t[NumberOfPaddedLanes]();
+	Active = new uint8_t[NumberOfPaddedLanes]();
+	Pending = new uint8_t[NumberOfPaddedLanes]();
+	GroupMask = new uint8_t[NumberOfPaddedLanes]();
+	Instructions = new uint16_t[NumberOfPaddedLanes]();
+	Executed = new uint32_t[NumberOfPaddedLanes]();
+	Drawn = new bool[NumberOfPaddedLanes]();
+	StopReasons = new CHIP_8_STOP_REASON[NumberOfPaddedLanes]();
+}
+
+CHIP_8_BATCH::~CHIP_8_BATCH()
+{
+	delete[] Lanes;
+	delete[] Registers;
+	delete[] ProgramCounters;
+	delete[] IndexRegisters;
+	delete[] Active;
+	delete[] Pending;
+	delete[] GroupMask;
+	delete[] Instructions;
+	delete[] Executed;
+	delete[] Drawn;
+	delete[] StopReasons;
+}
+
+unsigned int CHIP_8_BATCH::GetNumberOfLanes()
+{
+	return NumberOfLanes;
+}
+
+CHIP_8& CHIP_8_BATCH::GetLane(unsigned int Lane)
+{
+	return Lanes[Lane];
+}
+
+void CHIP_8_BATCH::LoadProgram(char* DataPointer, unsigned int DataSize)
+{
+	for (unsigned int i = 0; i < NumberOfLanes; ++i)
+	{
+		Lanes[i].LoadProgram(DataPointer, DataSize);
+	}
+}
+
+void CHIP_8_BATCH::SetQuirks(CHIP_8_QUIRKS Profile)
+{
+	if (Profile >= CHIP_8_QUIRKS__NUMBER_OF_PROFILES)
+		return;
+	Quirks = Profile;
+	for (unsigned int i = 0; i < NumberOfLanes; ++i)
+	{
+		Lanes[i].SetQuirks(Quirks);
+	}
+}
+
+CHIP_8_QUIRKS CHIP_8_BATCH::GetQuirks()
+{
+	return Quirks;
+}
+
+uint64_t CHIP_8_BATCH::RunCycles(unsigned int NumberOfInstructions)
+{
+	return Run(NumberOfInstructions, true);
+}
+
+uint64_t CHIP_8_BATCH::RunFrame(unsigned int InstructionsPerFrame)
+{
+	return Run(InstructionsPerFrame, false);
+}
+
+//What the lane's own RunCycles or RunFrame would have returned for the last run.
+CHIP_8_STOP_REASON CHIP_8_BATCH::GetStopReason(unsigned int Lane)
+{
+	return StopReasons[Lane];
+}
+
+uint64_t CHIP_8_BATCH::GetExecutedInstructions()
+{
+	return ExecutedInstructions;
+}
+
+//Whether the last run went in lockstep rather than lane by lane.
+bool CHIP_8_BATCH::IsRunningInLockstep()
+{
+	return InLockstep;
+}
+
+//Instructions executed by all lanes together per second spent inside RunCycles and RunFrame.
+double CHIP_8_BATCH::GetInstructionsPerSecond()
+{
+	if (SecondsRunning <= 0)
+		return 0;
+	return static_cast<double>(ExecutedInstructions) / SecondsRunning;
+}
+
+//Profiles on which a skip can step over the four bytes of F000 NNNN, depending on the instruction after it; the kernels only skip two.
+static const bool LongSkips[CHIP_8_QUIRKS__NUMBER_OF_PROFILES] =
+{
+	CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__DEFAULT>::XO_CHIP_INSTRUCTIONS,
+	CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__COSMAC_VIP>::XO_CHIP_INSTRUCTIONS,
+	CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__SUPER_CHIP>::XO_CHIP_INSTRUCTIONS,
+	CHIP_8_QUIRK_POLICY<CHIP_8_QUIRKS__XO_CHIP>::XO_CHIP_INSTRUCTIONS
+};
+
+bool CHIP_8_BATCH::IsVectorOperation(uint8_t Operation, bool SkipsCanBeLong)
+{
+#if CHIP_8_BATCH_VECTOR_WIDTH != 0
+	switch (Operation)
+	{
+		case CHIP_8_OPERATION__3xnn__SE_Vx_byte:
+		case CHIP_8_OPERATION__4xnn__SNE_Vx_byte:
+		case CHIP_8_OPERATION__5xy0__SE_Vx_Vy:
+		case CHIP_8_OPERATION__9xy0__SNE_Vx_Vy:
+			return !SkipsCanBeLong;
+		case CHIP_8_OPERATION__1nnn__JP_addr:
+		case CHIP_8_OPERATION__6xnn__LD_Vx_byte:
+		case CHIP_8_OPERATION__7xnn__ADD_Vx_byte:
+		case CHIP_8_OPERATION__8xy0__LD_Vx_Vy:
+		case CHIP_8_OPERATION__8xy1__OR_Vx_Vy:
+		case CHIP_8_OPERATION__8xy2__AND_Vx_Vy:
+		case CHIP_8_OPERATION__8xy3__XOR_Vx_Vy:
+		case CHIP_8_OPERATION__8xy4__ADD_Vx_Vy:
+		case CHIP_8_OPERATION__8xy5__SUB_Vx_Vy:
+		case CHIP_8_OPERATION__8xy6__SHR_Vx_Vy:
+		case CHIP_8_OPERATION__8xy7__SUBN_Vx_Vy:
+		case CHIP_8_OPERATION__8xyE__SHL_Vx_Vy:
+		case CHIP_8_OPERATION__Annn__LD_I_addr:
+		case CHIP_8_OPERATION__Fx1E__ADD_I_Vx:
+			return true;
+	}
+#endif
+	return false;
+}
+
+void CHIP_8_BATCH::LoadLanes()
+{
+	for (unsigned int i = 0; i < NumberOfLanes; ++i)
+	{
+		CHIP_8& Lane = Lanes[i];
+		for (unsigned int j = 0; j < CHIP_8::NUMBER_OF_GENERAL_REGISTERS; ++j)
+		{
+			Registers[j * NumberOfPaddedLanes + i] = Lane.Register_Vx[j];
+		}
+		ProgramCounters[i] = Lane.Register_PC;
+		IndexRegisters[i] = Lane.Register_I;
+		Executed[i] = 0;
+		Drawn[i] = false;
+		if (Lane.CurrentStatus)
+		{
+			Active[i] = 0;
+			StopReasons[i] = CHIP_8_STOP_REASON__ERROR;
+		}
+		else
+		{
+			Active[i] = 0xFF;
+			StopReasons[i] = CHIP_8_STOP_REASON__BUDGET_EXHAUSTED;
+		}
+	}
+}
+
+void CHIP_8_BATCH::StoreLanes()
+{
+	for (unsigned int i = 0; i < NumberOfLanes; ++i)
+	{
+		CHIP_8& Lane = Lanes[i];
+		for (unsigned int j = 0; j < CHIP_8::NUMBER_OF_GENERAL_REGISTERS; ++j)
+		{
+			Lane.Register_Vx[j] = Registers[j * NumberOfPaddedLanes + i];
+		}
+		Lane.Register_PC = ProgramCounters[i];
+		Lane.Register_I = IndexRegisters[i];
+	}
+}
+
+//Executes the lane's next instruction with its own handler and retires the lane when the instruction failed, waits for a key, or drew during RunCycles.
+void CHIP_8_BATCH::ExecuteLane(unsigned int LaneIndex, bool StopOnDrawing)
+{
+	CHIP_8& Lane = Lanes[LaneIndex];
+	for (unsigned int j = 0; j < CHIP_8::NUMBER_OF_GENERAL_REGISTERS; ++j)
+	{
+		Lane.Register_Vx[j] = Registers[j * NumberOfPaddedLanes + LaneIndex];
+	}
+	Lane.Register_PC = ProgramCounters[LaneIndex];
+	Lane.Register_I = IndexRegisters[LaneIndex];
+
+	Lane.StopReason = CHIP_8_STOP_REASON__BUDGET_EXHAUSTED;
+	Lane.FetchInstruction();
+	//Lanes step in lockstep, so an idle loop is simply run.
+	if (Lane.StopReason == CHIP_8_STOP_REASON__IDLE_LOOP)
+		Lane.StopReason = CHIP_8_STOP_REASON__BUDGET_EXHAUSTED;
+
+	for (unsigned int j = 0; j < CHIP_8::NUMBER_OF_GENERAL_REGISTERS; ++j)
+	{
+		Registers[j * NumberOfPaddedLanes + LaneIndex] = Lane.Register_Vx[j];
+	}
+	ProgramCounters[LaneIndex] = Lane.Register_PC;
+	IndexRegisters[LaneIndex] = Lane.Register_I;
+
+	if (Lane.CurrentStatus)
+		Active[LaneIndex] = 0;
+	else if ((Lane.StopReason == CHIP_8_STOP_REASON__DRAWING_HAPPENED) && !StopOnDrawing)
+		Drawn[LaneIndex] = true;
+	else if (Lane.StopReason != CHIP_8_STOP_REASON__BUDGET_EXHAUSTED)
+		Active[LaneIndex] = 0;
+}
+
+//Executes one instruction for every lane selected in GroupMask. All of them hold the same instruction and have a PC at least two instructions below the end of memory,
+//so neither advancing nor skipping can fail. Flags are written after the result, as the handlers do, so VF wins when it is also the destination.
+template<CHIP_8_QUIRKS Profile>
+void CHIP_8_BATCH::ExecuteGroup(const CHIP_8_DECODED_INSTRUCTION& Decoded, unsigned int FirstLane)
+{
+#if CHIP_8_BATCH_VECTOR_WIDTH != 0
+	const unsigned int WIDTH = CHIP_8_BATCH_VECTOR_WIDTH;
+	uint8_t* Vx = Registers + Decoded.x * NumberOfPaddedLanes;
+	uint8_t* Vy = Registers + Decoded.y * NumberOfPaddedLanes;
+	uint8_t* VF = Registers + 0xF * NumberOfPaddedLanes;
+	const BATCH_VECTOR One = VectorBroadcast8(1);
+	const BATCH_VECTOR AllSet = VectorBroadcast8(0xFF);
+	const BATCH_VECTOR Two = VectorBroadcast16(2);
+
+	for (unsigned int i = FirstLane / WIDTH * WIDTH; i < NumberOfLanes; i += WIDTH)
+	{
+		BATCH_VECTOR Mask = VectorLoad(GroupMask + i);
+		if (VectorIsZero(Mask))
+			continue;
+		BATCH_VECTOR X = VectorLoad(Vx + i);
+		BATCH_VECTOR Y = VectorLoad(Vy + i);
+		BATCH_VECTOR Skip = VectorBroadcast8(0);
+		bool WritesVx = false;
+		bool WritesVF = false;
+		BATCH_VECTOR Result = X;
+		BATCH_VECTOR Flag = X;
+		switch (Decoded.Operation)
+		{
+			case CHIP_8_OPERATION__1nnn__JP_addr:
+			{
+				for (unsigned int Half = 0; Half < 2; ++Half)
+				{
+					uint16_t* ProgramCounter = ProgramCounters + i + Half * (WIDTH / 2);
+					VectorStore(ProgramCounter, VectorBlend(VectorWidenMask(Mask, Half), VectorBroadcast16(Decoded.nnn), VectorLoad(ProgramCounter)));
+				}
+				continue;
+			}
+			case CHIP_8_OPERATION__3xnn__SE_Vx_byte:
+				Skip = VectorEqual8(X, VectorBroadcast8(Decoded.nn));
+				break;
+			case CHIP_8_OPERATION__4xnn__SNE_Vx_byte:
+				Skip = VectorXor(VectorEqual8(X, VectorBroadcast8(Decoded.nn)), AllSet);
+				break;
+			case CHIP_8_OPERATION__5xy0__SE_Vx_Vy:
+				Skip = VectorEqual8(X, Y);
+				break;
+			case CHIP_8_OPERATION__9xy0__SNE_Vx_Vy:
+				Skip = VectorXor(VectorEqual8(X, Y), AllSet);
+				break;
+			case CHIP_8_OPERATION__6xnn__LD_Vx_byte:
+				Result = VectorBroadcast8(Decoded.nn);
+				WritesVx = true;
+				break;
+			case CHIP_8_OPERATION__7xnn__ADD_Vx_byte:
+				Result = VectorAdd8(X, VectorBroadcast8(Decoded.nn));
+				WritesVx = true;
+				break;
+			case CHIP_8_OPERATION__8xy0__LD_Vx_Vy:
+				Result = Y;
+				WritesVx = true;
+				break;
+			case CHIP_8_OPERATION__8xy1__OR_Vx_Vy:
+				Result = VectorOr(X, Y);
+				Flag = VectorBroadcast8(0);
+				WritesVx = true;
+				WritesVF = CHIP_8_QUIRK_POLICY<Profile>::LOGIC_RESETS_VF;
+				break;
+			case CHIP_8_OPERATION__8xy2__AND_Vx_Vy:
+				Result = VectorAnd(X, Y);
+				Flag = VectorBroadcast8(0);
+				WritesVx = true;
+				WritesVF = CHIP_8_QUIRK_POLICY<Profile>::LOGIC_RESETS_VF;
+				break;
+			case CHIP_8_OPERATION__8xy3__XOR_Vx_Vy:
+				Result = VectorXor(X, Y);
+				Flag = VectorBroadcast8(0);
+				WritesVx = true;
+				WritesVF = CHIP_8_QUIRK_POLICY<Profile>::LOGIC_RESETS_VF;
+				break;
+			case CHIP_8_OPERATION__8xy4__ADD_Vx_Vy:
+				Result = VectorAdd8(X, Y);
+				Flag = VectorAndNot(VectorEqual8(VectorAddSaturated8(X, Y), Result), One);
+				WritesVx = true;
+				WritesVF = true;
+				break;
+			case CHIP_8_OPERATION__8xy5__SUB_Vx_Vy:
+				Result = VectorSubtract8(X, Y);
+				Flag = VectorAnd(VectorEqual8(VectorMaximum8(X, Y), X), One);
+				WritesVx = true;
+				WritesVF = true;
+				break;
+			case CHIP_8_OPERATION__8xy7__SUBN_Vx_Vy:
+				Result = VectorSubtract8(Y, X);
+				Flag = VectorAnd(VectorEqual8(VectorMaximum8(X, Y), Y), One);
+				WritesVx = true;
+				WritesVF = true;
+				break;
+			case CHIP_8_OPERATION__8xy6__SHR_Vx_Vy:
+			{
+				BATCH_VECTOR Source = CHIP_8_QUIRK_POLICY<Profile>::SHIFT_READS_VX ? X : Y;
+				Result = VectorAnd(VectorShiftRight16(Source, 1), VectorBroadcast8(0x7F));
+				Flag = VectorAnd(Source, One);
+				WritesVx = true;
+				WritesVF = true;
+				break;
+			}
+			case CHIP_8_OPERATION__8xyE__SHL_Vx_Vy:
+			{
+				BATCH_VECTOR Source = CHIP_8_QUIRK_POLICY<Profile>::SHIFT_READS_VX ? X : Y;
+				Result = VectorAdd8(Source, Source);
+				Flag = VectorAnd(VectorShiftRight16(Source, 7), One);
+				WritesVx = true;
+				WritesVF = true;
+				break;
+			}
+			case CHIP_8_OPERATION__Annn__LD_I_addr:
+			{
+				for (unsigned int Half = 0; Half < 2; ++Half)
+				{
+					uint16_t* Index = IndexRegisters + i + Half * (WIDTH / 2);
+					VectorStore(Index, VectorBlend(VectorWidenMask(Mask, Half), VectorBroadcast16(Decoded.nnn), VectorLoad(Index)));
+				}
+				break;
+			}
+			case CHIP_8_OPERATION__Fx1E__ADD_I_Vx:
+			{
+				for (unsigned int Half = 0; Half < 2; ++Half)
+				{
+					uint16_t* Index = IndexRegisters + i + Half * (WIDTH / 2);
+					BATCH_VECTOR Old = VectorLoad(Index);
+					VectorStore(Index, VectorBlend(VectorWidenMask(Mask, Half), VectorAdd16(Old, VectorWiden(X, Half)), Old));
+				}
+				break;
+			}
+		}
+
+		if (WritesVx)
+			VectorStore(Vx + i, VectorBlend(Mask, Result, X));
+		if (WritesVF)
+			VectorStore(VF + i, VectorBlend(Mask, Flag, VectorLoad(VF + i)));
+
+		for (unsigned int Half = 0; Half < 2; ++Half)
+		{
+			uint16_t* ProgramCounter = ProgramCounters + i + Half * (WIDTH / 2);
+			BATCH_VECTOR Increment = VectorAdd16(Two, VectorAnd(VectorWidenMask(Skip, Half), Two));
+			VectorStore(ProgramCounter, VectorAdd16(VectorLoad(ProgramCounter), VectorAnd(VectorWidenMask(Mask, Half), Increment)));
+		}
+	}
+#endif
+}
+
+//Measures each way, then takes the cheaper one, and after every ProbeInterval runs tries the other for PROBE_RUNS, to notice when it has become the cheaper. Without
+//kernels every instruction goes through the lanes' own handlers anyway, so lockstep never pays.
+bool CHIP_8_BATCH::ChooseLockstep()
+{
+#if CHIP_8_BATCH_VECTOR_WIDTH == 0
+	return false;
+#else
+	if (LockstepCost == 0)
+		return true;
+	if (LaneByLaneCost == 0)
+		return false;
+	bool Cheaper = LockstepCost <= LaneByLaneCost;
+	if (RunsSinceProbe == ProbeInterval + PROBE_RUNS)
+	{
+		//The last run was the try's.
+		ProbeInterval = (Cheaper == InLockstep) ? MINIMUM_PROBE_INTERVAL : (ProbeInterval < MAXIMUM_PROBE_INTERVAL) ? (2 * ProbeInterval) : MAXIMUM_PROBE_INTERVAL;
+		RunsSinceProbe = 0;
+	}
+	if (RunsSinceProbe++ < ProbeInterval)
+		return Cheaper;
+	return (RunsSinceProbe == ProbeInterval + 1) ? !Cheaper : InLockstep;
+#endif
+}
+
+uint64_t CHIP_8_BATCH::Run(unsigned int NumberOfInstructions, bool StopOnDrawing)
+{
+	std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+	bool Lockstep = ChooseLockstep();
+	if (Lockstep != InLockstep)
+		RunsTimed = 0;
+	InLockstep = Lockstep;
+	uint64_t Total = InLockstep ? RunLockstep(NumberOfInstructions, StopOnDrawing) : RunLaneByLane(NumberOfInstructions, StopOnDrawing);
+	double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	ExecutedInstructions += Total;
+	SecondsRunning += Seconds;
+
+	//The cost is that of the second run after a switch, or of the very first run, then an average leaning on the runs before, so one run the host slowed down does not
+	//switch on its own.
+	if ((Total != 0) && (++RunsTimed >= 2))
+	{
+		double& Cost = InLockstep ? LockstepCost : LaneByLaneCost;
+		Cost = ((RunsTimed == 2) || (Cost == 0)) ? (Seconds / Total) : ((3 * Cost + Seconds / Total) / 4);
+	}
+	return Total;
+}
+
+//Runs every lane by itself, which is how lone machines would run them.
+uint64_t CHIP_8_BATCH::RunLaneByLane(unsigned int NumberOfInstructions, bool StopOnDrawing)
+{
+	uint64_t Total = 0;
+	for (unsigned int i = 0; i < NumberOfLanes; ++i)
+	{
+		CHIP_8& Lane = Lanes[i];
+		uint64_t Before = Lane.ExecutedInstructions;
+		StopReasons[i] = StopOnDrawing ? Lane.RunCycles(NumberOfInstructions) : Lane.RunFrame(NumberOfInstructions);
+		Lane.StopReason = StopReasons[i];
+		Total += Lane.ExecutedInstructions - Before;
+	}
+	return Total;
+}
+
+uint64_t CHIP_8_BATCH::RunLockstep(unsigned int NumberOfInstructions, bool StopOnDrawing)
+{
+	LoadLanes();
+	const GROUP_KERNEL Kernel = GroupKernels[Quirks];
+	const bool SkipsCanBeLong = LongSkips[Quirks];
+	unsigned int ActiveLanes = 0;
+	for (unsigned int i = 0; i < NumberOfLanes; ++i)
+	{
+		if (!Active[i])
+			continue;
+		//RunFrame only resets the stop reason when it executes something; an empty frame reports the previous one.
+		if (StopOnDrawing || (NumberOfInstructions != 0))
+			Lanes[i].StopReason = CHIP_8_STOP_REASON__BUDGET_EXHAUSTED;
+		if ((NumberOfInstructions != 0) && Lanes[i].ContinueWaitingForKey())
+		{
+			Active[i] = 0;
+			continue;
+		}
+		++ActiveLanes;
+	}
+
+	for (unsigned int Step = 0; (Step < NumberOfInstructions) && (ActiveLanes != 0); ++Step)
+	{
+		//Fetch for every lane; lanes on instructions without a kernel, too close to the end of memory for one, or on a profile of their own, are executed right away.
+		//Lanes on the same instruction as the first grouped lane form the first group directly, any others are left pending.
+		bool Grouped = false;
+		bool Divergent = false;
+		unsigned int FirstLane = 0;
+		uint16_t FirstInstruction = 0;
+		for (unsigned int i = 0; i < NumberOfLanes; ++i)
+		{
+			if (!Active[i])
+				continue;
+			++Executed[i];
+			unsigned int ProgramCounter = ProgramCounters[i];
+			CHIP_8& Lane = Lanes[i];
+			if ((ProgramCounter < (CHIP_8::MEMORY_SIZE - 4)) && (Lane.Quirks == Quirks))
+			{
+				const CHIP_8_DECODED_INSTRUCTION& Decoded = Lane.DecodedInstructions[ProgramCounter];
+				if (Decoded.Operation == CHIP_8_OPERATION__NOT_DECODED)
+					Lane.DecodeInstructionAt(ProgramCounter);
+				if (IsVectorOperation(Decoded.Operation, SkipsCanBeLong))
+				{
+					if (!Grouped)
+					{
+						Grouped = true;
+						FirstLane = i;
+						FirstInstruction = Decoded.Instruction;
+						GroupMask[i] = 0xFF;
+					}
+					else if (Decoded.Instruction == FirstInstruction)
+						GroupMask[i] = 0xFF;
+					else
+					{
+						Instructions[i] = Decoded.Instruction;
+						Pending[i] = 0xFF;
+						Divergent = true;
+					}
+					continue;
+				}
+			}
+			ExecuteLane(i, StopOnDrawing);
+			if (!Active[i])
+				--ActiveLanes;
+		}
+
+		if (!Grouped)
+			continue;
+		(this->*Kernel)(Lanes[FirstLane].DecodedInstructions[ProgramCounters[FirstLane]], FirstLane);
+		memset(GroupMask + FirstLane, 0, NumberOfLanes - FirstLane);
+
+		//Group the remaining lanes by instruction and run each group through the kernels.
+		unsigned int First = FirstLane;
+		while (Divergent)
+		{
+			while ((First < NumberOfLanes) && !Pending[First])
+				++First;
+			if (First == NumberOfLanes)
+				break;
+			uint16_t Instruction = Instructions[First];
+			for (unsigned int i = First; i < NumberOfLanes; ++i)
+			{
+				uint8_t Selected = (Pending[i] && (Instructions[i] == Instruction)) ? 0xFF : 0;
+				GroupMask[i] = Selected;
+				Pending[i] &= ~Selected;
+			}
+			(this->*Kernel)(Lanes[First].DecodedInstructions[ProgramCounters[First]], First);
+			memset(GroupMask + First, 0, NumberOfLanes - First);
+		}
+	}
+
+	StoreLanes();
+
+	uint64_t Total = 0;
+	for (unsigned int i = 0; i < NumberOfLanes; ++i)
+	{
+		if (StopReasons[i] == CHIP_8_STOP_REASON__ERROR)
+			continue;
+		CHIP_8& Lane = Lanes[i];
+		Lane.ExecutedInstructions += Executed[i];
+		Total += Executed[i];
+		if (StopOnDrawing)
+		{
+			StopReasons[i] = Lane.CurrentStatus ? CHIP_8_STOP_REASON__ERROR : Lane.StopReason;
+			continue;
+		}
+		Lane.UpdateTimers(1);
+		if (Lane.CurrentStatus)
+			StopReasons[i] = CHIP_8_STOP_REASON__ERROR;
+		else if (Lane.StopReason == CHIP_8_STOP_REASON__WAITING_FOR_KEY)
+			StopReasons[i] = CHIP_8_STOP_REASON__WAITING_FOR_KEY;
+		else if (Drawn[i])
+			StopReasons[i] = CHIP_8_STOP_REASON__DRAWING_HAPPENED;
+		else
+			StopReasons[i] = CHIP_8_STOP_REASON__BUDGET_EXHAUSTED;
+	}
+	//Every lane's machine reports the reason its run stopped, as the batch does, whether it ran to the end of the run or was retired early.
+	for (unsigned int i = 0; i < NumberOfLanes; ++i)
+	{
+		Lanes[i].StopReason = StopReasons[i];
+	}
+	return Total;
+}
+
+const CHIP_8_BATCH::GROUP_KERNEL CHIP_8_BATCH::GroupKernels[CHIP_8_QUIRKS__NUMBER_OF_PROFILES] =
+{
+	&CHIP_8_BATCH::ExecuteGroup<CHIP_8_QUIRKS__DEFAULT>,
+	&CHIP_8_BATCH::ExecuteGroup<CHIP_8_QUIRKS__COSMAC_VIP>,
+	&CHIP_8_BATCH::ExecuteGroup<CHIP_8_QUIRKS__SUPER_CHIP>,
+	&CHIP_8_BATCH::ExecuteGroup<CHIP_8_QUIRKS__XO_CHIP>
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include "Interpreter/CHIP-8.h"
+
+//Runs many independent CHIP-8 machines in lockstep, one instruction per machine per step. Registers, PC and I of every lane are kept in structure-of-arrays form while
+//running, lanes sitting on the same instruction are grouped and register-only instructions of a group are executed with SIMD kernels across all its lanes at once.
+//Everything else is executed by the lane's own CHIP_8 instruction handlers, so every lane ends in exactly the state a lone CHIP_8 would have reached.
+//Between runs the lanes are ordinary CHIP_8 objects and can be given input, inspected and displayed through GetLane. A lane waiting for a key sits out every run, its timers
+//aside, until a button of it changes.
+//The kernels are instantiated per quirk profile and run the batch's profile, which SetQuirks gives to every lane; a lane given another one is executed by its own handlers only.
+//Lockstep only pays off for programs that run almost nothing but register instructions: an instruction through a lane's own handlers costs far more than in a lone
+//machine, as every step visits every lane's memory, and with many lanes even a few of them lose more than the kernels win. So the batch times its runs per instruction,
+//and runs in lockstep only while that is cheaper than running the lanes one after another with their own RunFrame or RunCycles, which gives the same results.
+class CHIP_8_BATCH
+{
+	private:
+		CHIP_8* Lanes;
+		unsigned int NumberOfLanes;
+		unsigned int NumberOfPaddedLanes;
+
+		//Working copies of the lane registers, indexed [Register * NumberOfPaddedLanes + Lane].
+		uint8_t* Registers;
+		uint16_t* ProgramCounters;
+		uint16_t* IndexRegisters;
+
+		uint8_t* Active;
+		uint8_t* Pending;
+		uint8_t* GroupMask;
+		uint16_t* Instructions;
+		uint32_t* Executed;
+		bool* Drawn;
+		CHIP_8_STOP_REASON* StopReasons;
+
+		uint64_t ExecutedInstructions;
+		double SecondsRunning;
+
+		//Seconds per instruction of the recent runs in lockstep and of those lane by lane, or 0 before the first.
+		double LockstepCost;
+		double LaneByLaneCost;
+		unsigned int ProbeInterval;
+		unsigned int RunsSinceProbe;
+		//Runs that executed something since the last switch between the two ways; the first run of the batch counts as the second.
+		unsigned int RunsTimed;
+		bool InLockstep;
+
+		CHIP_8_QUIRKS Quirks;
+		typedef void (CHIP_8_BATCH::*GROUP_KERNEL)(const CHIP_8_DECODED_INSTRUCTION&, unsigned int);
+		static const GROUP_KERNEL GroupKernels[CHIP_8_QUIRKS__NUMBER_OF_PROFILES];
+
+		static bool IsVectorOperation(uint8_t, bool);
+		void LoadLanes();
+		void StoreLanes();
+		void ExecuteLane(unsigned int, bool);
+		template<CHIP_8_QUIRKS Profile> void ExecuteGroup(const CHIP_8_DECODED_INSTRUCTION&, unsigned int);
+		bool ChooseLockstep();
+		uint64_t RunLockstep(unsigned int, bool);
+		uint64_t RunLaneByLane(unsigned int, bool);
+		uint64_t Run(unsigned int, bool);
+	public:
+		CHIP_8_BATCH(unsigned int);
+		CHIP_8_BATCH(const CHIP_8_BATCH&) = delete;
+		CHIP_8_BATCH& operator=(const CHIP_8_BATCH&) = delete;
+		~CHIP_8_BATCH();
+		unsigned int GetNumberOfLanes();
+		CHIP_8& GetLane(unsigned int);
+		void LoadProgram(char*, unsigned int);
+		void SetQuirks(CHIP_8_QUIRKS);
+		CHIP_8_QUIRKS GetQuirks();
+		uint64_t RunCycles(unsigned int);
+		uint64_t RunFrame(unsigned int);
+		CHIP_8_STOP_REASON GetStopReason(unsigned int);
+		uint64_t GetExecutedInstructions();
+		bool IsRunningInLockstep();
+		double GetInstructionsPerSecond();
+};
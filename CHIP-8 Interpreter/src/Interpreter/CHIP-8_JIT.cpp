@@ -0,0 +1,338 @@
+#include "Interpreter/CHIP-8.h"
+
+//Basic-block compiler to x86-64. A block is the longest straight run of register-only instructions (loads, arithmetic, logic and I updates) starting at an address;
+//branches, calls, skips, drawing, timers, keys and memory transfers end it and are interpreted by the switch engine. Blocks address the general registers off a base register
+//and keep I in a host register for their whole length; PC is constant per block and is advanced by the caller. Any write to a byte a block was compiled from discards all blocks.
+//On other architectures, or where executable memory cannot be obtained, the engine behaves exactly like the switch engine. Like the threaded engine, it is instantiated once
+//per quirk profile; blocks are compiled for the profile selected at the time and discarded when it changes.
+#if defined(__x86_64__) || defined(_M_X64)
+#define CHIP_8_JIT_AVAILABLE true
+#else
+#define CHIP_8_JIT_AVAILABLE false
+#endif
+
+#if CHIP_8_JIT_AVAILABLE == true
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+typedef void (*JIT_FUNCTION)(uint8_t*);
+
+bool CHIP_8::StartJit()
+{
+#if CHIP_8_JIT_AVAILABLE == true
+	if (JitCode != nullptr)
+		return true;
+#if defined(_WIN32)
+	void* Code = VirtualAlloc(nullptr, JIT_CODE_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+	if (Code == nullptr)
+		return false;
+#else
+	void* Code = mmap(nullptr, JIT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (Code == MAP_FAILED)
+		return false;
+#endif
+	JitCode = static_cast<uint8_t*>(Code);
+	JitBlocks = new CHIP_8_JIT_BLOCK[MEMORY_SIZE];
+	JitCoverage = new uint8_t[MEMORY_SIZE];
+	FlushJit();
+	return true;
+#else
+	return false;
+#endif
+}
+
+void CHIP_8::StopJit()
+{
+#if CHIP_8_JIT_AVAILABLE == true
+	if (JitCode == nullptr)
+		return;
+#if defined(_WIN32)
+	VirtualFree(JitCode, 0, MEM_RELEASE);
+#else
+	munmap(JitCode, JIT_CODE_SIZE);
+#endif
+	delete[] JitBlocks;
+	delete[] JitCoverage;
+	JitCode = nullptr;
+	JitBlocks = nullptr;
+	JitCoverage = nullptr;
+#endif
+}
+
+void CHIP_8::FlushJit()
+{
+	if (JitCode == nullptr)
+		return;
+	for (unsigned int i = 0; i < MEMORY_SIZE; ++i)
+	{
+		JitBlocks[i].Code = nullptr;
+		JitBlocks[i].NumberOfInstructions = 0;
+		JitBlocks[i].Compiled = false;
+		JitCoverage[i] = 0;
+	}
+	JitCodeUsed = 0;
+}
+
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
+unsigned int CHIP_8::ExecuteJit(unsigned int NumberOfInstructions)
+{
+	if (!StartJit())
+		return ExecuteSwitch<Model>(NumberOfInstructions);
+
+	unsigned int Executed = 0;
+	while ((Executed < NumberOfInstructions) && (CurrentStatus == CHIP_8_ERROR_CODE__STATUS_OK) && (StopReason == CHIP_8_STOP_REASON__BUDGET_EXHAUSTED))
+	{
+		if ((Model == CHIP_8_MEMORY_MODEL__WRAPPED) || (Register_PC < (MEMORY_SIZE - 1)))
+		{
+			const CHIP_8_JIT_BLOCK& Block = JitBlocks[Register_PC];
+			if (!Block.Compiled)
+				CompileBlock<Profile>(Register_PC);
+			if ((Block.Code != nullptr) && (Block.NumberOfInstructions <= (NumberOfInstructions - Executed)))
+			{
+#if CHIP_8_PROFILING == true
+				//Blocks hold no jumps or skips, so they run every instruction they cover.
+				for (unsigned int i = 0; i < Block.NumberOfInstructions; ++i)
+				{
+					ProfileInstruction(Register_PC + 2 * i);
+				}
+#endif
+				reinterpret_cast<JIT_FUNCTION>(Block.Code)(Register_Vx);
+				Register_PC += 2 * Block.NumberOfInstructions;
+				Executed += Block.NumberOfInstructions;
+				continue;
+			}
+		}
+#if CHIP_8_PROFILING == true
+		ProfileInstruction(Register_PC);
+#endif
+		FetchInstruction<Model>();
+		++Executed;
+	}
+	return Executed;
+}
+
+#if CHIP_8_JIT_AVAILABLE == true
+//Longest sequence emitted for one instruction, plus the prologue and epilogue.
+static const unsigned int JIT_MAX_INSTRUCTION_BYTES = 24;
+static const unsigned int JIT_FRAME_BYTES = 32;
+
+static bool IsCompilable(CHIP_8_OPERATION Operation)
+{
+	switch (Operation)
+	{
+		case CHIP_8_OPERATION__6xnn__LD_Vx_byte:
+		case CHIP_8_OPERATION__7xnn__ADD_Vx_byte:
+		case CHIP_8_OPERATION__8xy0__LD_Vx_Vy:
+		case CHIP_8_OPERATION__8xy1__OR_Vx_Vy:
+		case CHIP_8_OPERATION__8xy2__AND_Vx_Vy:
+		case CHIP_8_OPERATION__8xy3__XOR_Vx_Vy:
+		case CHIP_8_OPERATION__8xy4__ADD_Vx_Vy:
+		case CHIP_8_OPERATION__8xy5__SUB_Vx_Vy:
+		case CHIP_8_OPERATION__8xy6__SHR_Vx_Vy:
+		case CHIP_8_OPERATION__8xy7__SUBN_Vx_Vy:
+		case CHIP_8_OPERATION__8xyE__SHL_Vx_Vy:
+		case CHIP_8_OPERATION__Annn__LD_I_addr:
+		case CHIP_8_OPERATION__Fx1E__ADD_I_Vx:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static void Emit(uint8_t*& Output, uint8_t Byte)
+{
+	*Output++ = Byte;
+}
+
+static void Emit32(uint8_t*& Output, uint32_t Value)
+{
+	for (unsigned int i = 0; i < 4; ++i)
+		Emit(Output, static_cast<uint8_t>(Value >> (8 * i)));
+}
+
+//rdi holds the address of Register_Vx, so Vx is [rdi+x].
+static void EmitLoadAl(uint8_t*& Output, unsigned int Register)		//mov al, [rdi+Register]
+{
+	Emit(Output, 0x8A); Emit(Output, 0x47); Emit(Output, Register);
+}
+
+static void EmitStoreAl(uint8_t*& Output, unsigned int Register)	//mov [rdi+Register], al
+{
+	Emit(Output, 0x88); Emit(Output, 0x47); Emit(Output, Register);
+}
+
+static void EmitStoreCl(uint8_t*& Output, unsigned int Register)	//mov [rdi+Register], cl
+{
+	Emit(Output, 0x88); Emit(Output, 0x4F); Emit(Output, Register);
+}
+
+static void EmitClearFlag(uint8_t*& Output)				//mov byte [rdi+0xF], 0
+{
+	Emit(Output, 0xC6); Emit(Output, 0x47); Emit(Output, 0xF); Emit(Output, 0);
+}
+#endif
+
+template<CHIP_8_QUIRKS Profile>
+void CHIP_8::CompileBlock(unsigned int Address)
+{
+	CHIP_8_JIT_BLOCK& Block = JitBlocks[Address];
+	Block.Compiled = true;
+	Block.Code = nullptr;
+	Block.NumberOfInstructions = 0;
+#if CHIP_8_JIT_AVAILABLE == true
+	unsigned int Length = 0;
+	unsigned int End = Address;
+	//An instruction is only compiled if advancing past it cannot fail, so blocks never raise errors.
+	while ((Length < JIT_MAX_BLOCK_LENGTH) && (End < (MEMORY_SIZE - 2)))
+	{
+		uint16_t FetchedInstruction = (Memory[End] << 8) | Memory[End + 1];
+		if (!IsCompilable(DecodeInstruction(FetchedInstruction)))
+			break;
+		++Length;
+		End += 2;
+	}
+	if (Length == 0)
+		return;
+
+	if ((JIT_CODE_SIZE - JitCodeUsed) < (Length * JIT_MAX_INSTRUCTION_BYTES + JIT_FRAME_BYTES))
+	{
+		FlushJit();
+		JitBlocks[Address].Compiled = true;
+	}
+
+	uint8_t* Start = JitCode + JitCodeUsed;
+	uint8_t* Output = Start;
+	const uint32_t OffsetOfI = static_cast<uint32_t>(reinterpret_cast<uint8_t*>(&Register_I) - Register_Vx);
+
+#if defined(_WIN32)
+	Emit(Output, 0x57);								//push rdi
+	Emit(Output, 0x48); Emit(Output, 0x89); Emit(Output, 0xCF);		//mov rdi, rcx
+#endif
+	Emit(Output, 0x0F); Emit(Output, 0xB7); Emit(Output, 0x97); Emit32(Output, OffsetOfI);	//movzx edx, word [rdi+I]
+
+	for (unsigned int i = Address; i < End; i += 2)
+	{
+		uint16_t FetchedInstruction = (Memory[i] << 8) | Memory[i + 1];
+		unsigned int Vx = (FetchedInstruction & 0x0F00) >> 8;
+		unsigned int Vy = (FetchedInstruction & 0x00F0) >> 4;
+		uint8_t Byte = FetchedInstruction & 0x00FF;
+		uint16_t Address_nnn = FetchedInstruction & 0x0FFF;
+		unsigned int ShiftSource = CHIP_8_QUIRK_POLICY<Profile>::SHIFT_READS_VX ? Vx : Vy;
+		switch (DecodeInstruction(FetchedInstruction))
+		{
+			case CHIP_8_OPERATION__6xnn__LD_Vx_byte:
+				Emit(Output, 0xC6); Emit(Output, 0x47); Emit(Output, Vx); Emit(Output, Byte);		//mov byte [rdi+x], nn
+				break;
+			case CHIP_8_OPERATION__7xnn__ADD_Vx_byte:
+				Emit(Output, 0x80); Emit(Output, 0x47); Emit(Output, Vx); Emit(Output, Byte);		//add byte [rdi+x], nn
+				break;
+			case CHIP_8_OPERATION__8xy0__LD_Vx_Vy:
+				EmitLoadAl(Output, Vy);
+				EmitStoreAl(Output, Vx);
+				break;
+			case CHIP_8_OPERATION__8xy1__OR_Vx_Vy:
+				EmitLoadAl(Output, Vy);
+				Emit(Output, 0x08); Emit(Output, 0x47); Emit(Output, Vx);		//or [rdi+x], al
+				if (CHIP_8_QUIRK_POLICY<Profile>::LOGIC_RESETS_VF)
+					EmitClearFlag(Output);
+				break;
+			case CHIP_8_OPERATION__8xy2__AND_Vx_Vy:
+				EmitLoadAl(Output, Vy);
+				Emit(Output, 0x20); Emit(Output, 0x47); Emit(Output, Vx);		//and [rdi+x], al
+				if (CHIP_8_QUIRK_POLICY<Profile>::LOGIC_RESETS_VF)
+					EmitClearFlag(Output);
+				break;
+			case CHIP_8_OPERATION__8xy3__XOR_Vx_Vy:
+				EmitLoadAl(Output, Vy);
+				Emit(Output, 0x30); Emit(Output, 0x47); Emit(Output, Vx);		//xor [rdi+x], al
+				if (CHIP_8_QUIRK_POLICY<Profile>::LOGIC_RESETS_VF)
+					EmitClearFlag(Output);
+				break;
+			case CHIP_8_OPERATION__8xy4__ADD_Vx_Vy:
+				EmitLoadAl(Output, Vx);
+				Emit(Output, 0x02); Emit(Output, 0x47); Emit(Output, Vy);		//add al, [rdi+y]
+				Emit(Output, 0x0F); Emit(Output, 0x92); Emit(Output, 0xC1);		//setc cl
+				EmitStoreAl(Output, Vx);
+				EmitStoreCl(Output, 0xF);
+				break;
+			case CHIP_8_OPERATION__8xy5__SUB_Vx_Vy:
+				EmitLoadAl(Output, Vx);
+				Emit(Output, 0x2A); Emit(Output, 0x47); Emit(Output, Vy);		//sub al, [rdi+y]
+				Emit(Output, 0x0F); Emit(Output, 0x93); Emit(Output, 0xC1);		//setnc cl
+				EmitStoreAl(Output, Vx);
+				EmitStoreCl(Output, 0xF);
+				break;
+			case CHIP_8_OPERATION__8xy7__SUBN_Vx_Vy:
+				EmitLoadAl(Output, Vy);
+				Emit(Output, 0x2A); Emit(Output, 0x47); Emit(Output, Vx);		//sub al, [rdi+x]
+				Emit(Output, 0x0F); Emit(Output, 0x93); Emit(Output, 0xC1);		//setnc cl
+				EmitStoreAl(Output, Vx);
+				EmitStoreCl(Output, 0xF);
+				break;
+			case CHIP_8_OPERATION__8xy6__SHR_Vx_Vy:
+				EmitLoadAl(Output, ShiftSource);
+				Emit(Output, 0x88); Emit(Output, 0xC1);					//mov cl, al
+				Emit(Output, 0x80); Emit(Output, 0xE1); Emit(Output, 0x01);		//and cl, 1
+				Emit(Output, 0xD0); Emit(Output, 0xE8);					//shr al, 1
+				EmitStoreAl(Output, Vx);
+				EmitStoreCl(Output, 0xF);
+				break;
+			case CHIP_8_OPERATION__8xyE__SHL_Vx_Vy:
+				EmitLoadAl(Output, ShiftSource);
+				Emit(Output, 0x88); Emit(Output, 0xC1);					//mov cl, al
+				Emit(Output, 0xC0); Emit(Output, 0xE9); Emit(Output, 0x07);		//shr cl, 7
+				Emit(Output, 0xD0); Emit(Output, 0xE0);					//shl al, 1
+				EmitStoreAl(Output, Vx);
+				EmitStoreCl(Output, 0xF);
+				break;
+			case CHIP_8_OPERATION__Annn__LD_I_addr:
+				Emit(Output, 0x66); Emit(Output, 0xBA); Emit(Output, Address_nnn & 0xFF); Emit(Output, Address_nnn >> 8);	//mov dx, nnn
+				break;
+			case CHIP_8_OPERATION__Fx1E__ADD_I_Vx:
+				Emit(Output, 0x0F); Emit(Output, 0xB6); Emit(Output, 0x47); Emit(Output, Vx);		//movzx eax, byte [rdi+x]
+				Emit(Output, 0x66); Emit(Output, 0x01); Emit(Output, 0xC2);				//add dx, ax
+				break;
+			default:
+				break;
+		}
+	}
+
+	Emit(Output, 0x66); Emit(Output, 0x89); Emit(Output, 0x97); Emit32(Output, OffsetOfI);	//mov [rdi+I], dx
+#if defined(_WIN32)
+	Emit(Output, 0x5F);								//pop rdi
+#endif
+	Emit(Output, 0xC3);								//ret
+
+	JitCodeUsed += static_cast<unsigned int>(Output - Start);
+	JitCodeUsed = (JitCodeUsed + 15) & ~15u;
+	for (unsigned int i = Address; i < End; ++i)
+		JitCoverage[i] = 1;
+
+	CHIP_8_JIT_BLOCK& CompiledBlock = JitBlocks[Address];
+	CompiledBlock.Code = Start;
+	CompiledBlock.NumberOfInstructions = static_cast<uint16_t>(Length);
+#endif
+}
+
+const CHIP_8::ENGINE_FUNCTION CHIP_8::JitEngines[CHIP_8_MEMORY_MODEL__NUMBER_OF_MODELS][CHIP_8_QUIRKS__NUMBER_OF_PROFILES] =
+{
+	{
+		&CHIP_8::ExecuteJit<CHIP_8_QUIRKS__DEFAULT, CHIP_8_MEMORY_MODEL__STRICT>,
+		&CHIP_8::ExecuteJit<CHIP_8_QUIRKS__COSMAC_VIP, CHIP_8_MEMORY_MODEL__STRICT>,
+		&CHIP_8::ExecuteJit<CHIP_8_QUIRKS__SUPER_CHIP, CHIP_8_MEMORY_MODEL__STRICT>,
+		&CHIP_8::ExecuteJit<CHIP_8_QUIRKS__XO_CHIP, CHIP_8_MEMORY_MODEL__STRICT>
+	},
+	{
+		&CHIP_8::ExecuteJit<CHIP_8_QUIRKS__DEFAULT, CHIP_8_MEMORY_MODEL__WRAPPED>,
+		&CHIP_8::ExecuteJit<CHIP_8_QUIRKS__COSMAC_VIP, CHIP_8_MEMORY_MODEL__WRAPPED>,
+		&CHIP_8::ExecuteJit<CHIP_8_QUIRKS__SUPER_CHIP, CHIP_8_MEMORY_MODEL__WRAPPED>,
+		&CHIP_8::ExecuteJit<CHIP_8_QUIRKS__XO_CHIP, CHIP_8_MEMORY_MODEL__WRAPPED>
+	}
+};
@@ -0,0 +1,289 @@
+#include "Interpreter/CHIP-8_ROM_Store.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//A file opened for reading, whose size and modification time are known at once and whose content is only mapped into memory when asked for.
+class MAPPED_FILE
+{
+	private:
+#if defined(_WIN32)
+		HANDLE mFile;
+		HANDLE mMapping;
+#else
+		int mFile;
+#endif
+		const uint8_t* mView;
+		uint64_t mSize;
+		uint64_t mModificationTime;
+
+	public:
+		MAPPED_FILE(const std::string&);
+		MAPPED_FILE(const MAPPED_FILE&) = delete;
+		MAPPED_FILE& operator=(const MAPPED_FILE&) = delete;
+		~MAPPED_FILE();
+		uint64_t GetSize();
+		uint64_t GetModificationTime();
+		const uint8_t* Map();
+};
+
+#if defined(_WIN32)
+//Names are UTF-8, as everywhere else; Windows wants them in UTF-16.
+MAPPED_FILE::MAPPED_FILE(const std::string& Filename) : mFile{ INVALID_HANDLE_VALUE }, mMapping{ nullptr }, mView{ nullptr }, mSize{ 0 }, mModificationTime{ 0 }
+{
+	int Length = MultiByteToWideChar(CP_UTF8, 0, Filename.c_str(), -1, nullptr, 0);
+	std::wstring WideFilename(Length, L'\0');
+	if (Length > 0)
+		MultiByteToWideChar(CP_UTF8, 0, Filename.c_str(), -1, &WideFilename[0], Length);
+	mFile = CreateFileW(WideFilename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	BY_HANDLE_FILE_INFORMATION Information;
+	if ((mFile == INVALID_HANDLE_VALUE) || !GetFileInformationByHandle(mFile, &Information))
+	{
+		if (mFile != INVALID_HANDLE_VALUE)
+			CloseHandle(mFile);
+		throw(std::runtime_error("Could not open program file \"" + Filename + "\"."));
+	}
+	mSize = (static_cast<uint64_t>(Information.nFileSizeHigh) << 32) | Information.nFileSizeLow;
+	mModificationTime = (static_cast<uint64_t>(Information.ftLastWriteTime.dwHighDateTime) << 32) | Information.ftLastWriteTime.dwLowDateTime;
+}
+
+MAPPED_FILE::~MAPPED_FILE()
+{
+	if (mView != nullptr)
+		UnmapViewOfFile(mView);
+	if (mMapping != nullptr)
+		CloseHandle(mMapping);
+	CloseHandle(mFile);
+}
+
+//Null for an empty file, which cannot be mapped and has nothing to read.
+const uint8_t* MAPPED_FILE::Map()
+{
+	if ((mView != nullptr) || (mSize == 0))
+		return mView;
+	mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mMapping != nullptr)
+		mView = static_cast<const uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+	if (mView == nullptr)
+		throw(std::runtime_error("Could not map program file into memory."));
+	return mView;
+}
+#else
+MAPPED_FILE::MAPPED_FILE(const std::string& Filename) : mFile{ -1 }, mView{ nullptr }, mSize{ 0 }, mModificationTime{ 0 }
+{
+	mFile = open(Filename.c_str(), O_RDONLY);
+	struct stat Information;
+	if ((mFile < 0) || (fstat(mFile, &Information) != 0))
+	{
+		if (mFile >= 0)
+			close(mFile);
+		throw(std::runtime_error("Could not open program file \"" + Filename + "\"."));
+	}
+	mSize = static_cast<uint64_t>(Information.st_size);
+#if defined(__APPLE__)
+	mModificationTime = (static_cast<uint64_t>(Information.st_mtimespec.tv_sec) * 1000000000) + Information.st_mtimespec.tv_nsec;
+#else
+	mModificationTime = (static_cast<uint64_t>(Information.st_mtim.tv_sec) * 1000000000) + Information.st_mtim.tv_nsec;
+#endif
+}
+
+MAPPED_FILE::~MAPPED_FILE()
+{
+	if (mView != nullptr)
+		munmap(const_cast<uint8_t*>(mView), mSize);
+	close(mFile);
+}
+
+//Null for an empty file, which cannot be mapped and has nothing to read.
+const uint8_t* MAPPED_FILE::Map()
+{
+	if ((mView != nullptr) || (mSize == 0))
+		return mView;
+	void* View = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+	if (View == MAP_FAILED)
+		throw(std::runtime_error("Could not map program file into memory."));
+	mView = static_cast<const uint8_t*>(View);
+	return mView;
+}
+#endif
+
+uint64_t MAPPED_FILE::GetSize()
+{
+	return mSize;
+}
+
+uint64_t MAPPED_FILE::GetModificationTime()
+{
+	return mModificationTime;
+}
+
+CHIP_8_ROM::CHIP_8_ROM(CHIP_8_ROM_STORE* Store, const uint8_t* Data, size_t Size, uint64_t Hash) : mStore{ Store }, mData(Data, Data + Size), mHash{ Hash }, mQuirks{ CHIP_8_QUIRKS__DEFAULT }
+{
+	unsigned int Length = CHIP_8::GetPredecodedLength(GetSize());
+	mDecodedInstructions.reset(new CHIP_8_DECODED_INSTRUCTION[(Length != 0) ? Length : 1]);
+	CHIP_8::PredecodeProgram(mData.data(), GetSize(), mDecodedInstructions.get());
+}
+
+const uint8_t* CHIP_8_ROM::GetData()
+{
+	return mData.data();
+}
+
+unsigned int CHIP_8_ROM::GetSize()
+{
+	return static_cast<unsigned int>(mData.size());
+}
+
+uint64_t CHIP_8_ROM::GetHash()
+{
+	return mHash;
+}
+
+//The entries CHIP_8::PredecodeProgram makes for the program, to hand to CHIP_8::LoadProgram.
+const CHIP_8_DECODED_INSTRUCTION* CHIP_8_ROM::GetDecodedInstructions()
+{
+	return mDecodedInstructions.get();
+}
+
+CHIP_8_ANALYSIS& CHIP_8_ROM::GetAnalysis(CHIP_8_QUIRKS Quirks)
+{
+	if (Quirks >= CHIP_8_QUIRKS__NUMBER_OF_PROFILES)
+		Quirks = CHIP_8_QUIRKS__DEFAULT;
+	bool Made = false;
+	std::call_once(mAnalysisMade[Quirks], [this, Quirks, &Made]
+	{
+		mAnalyses[Quirks].reset(new CHIP_8_ANALYSIS(mData.data(), GetSize(), Quirks));
+		Made = true;
+	});
+	++(Made ? mStore->mAnalysisMisses : mStore->mAnalysisHits);
+	return *mAnalyses[Quirks];
+}
+
+//The profile the program was most likely written for: the first of the default, SUPER-CHIP and XO-CHIP profiles under which the fewest of the instructions it can
+//reach are not recognized, which is none for most programs.
+CHIP_8_QUIRKS CHIP_8_ROM::GetQuirks()
+{
+	std::call_once(mQuirksFound, [this]
+	{
+		static const CHIP_8_QUIRKS Candidates[] = { CHIP_8_QUIRKS__DEFAULT, CHIP_8_QUIRKS__SUPER_CHIP, CHIP_8_QUIRKS__XO_CHIP };
+		unsigned int Fewest = 0;
+		for (CHIP_8_QUIRKS Candidate : Candidates)
+		{
+			unsigned int Unrecognized = GetAnalysis(Candidate).GetNumberOfUnrecognizedInstructions();
+			if ((Candidate == CHIP_8_QUIRKS__DEFAULT) || (Unrecognized < Fewest))
+			{
+				mQuirks = Candidate;
+				Fewest = Unrecognized;
+			}
+		}
+	});
+	return mQuirks;
+}
+
+//Loads the program into the machine, with its decoded instructions, under the machine's own quirk profile.
+CHIP_8_ERROR_CODE CHIP_8_ROM::LoadInto(CHIP_8& Machine)
+{
+	return Machine.LoadProgram(mData.data(), GetSize(), mDecodedInstructions.get());
+}
+
+CHIP_8_ROM_STORE::CHIP_8_ROM_STORE() : mOpens{ 0 }, mFileHits{ 0 }, mContentHits{ 0 }, mMisses{ 0 }, mBytes{ 0 }, mAnalysisHits{ 0 }, mAnalysisMisses{ 0 }
+{
+}
+
+//64-bit FNV-1a. Only finds the candidates; content is compared in full before a ROM is shared.
+uint64_t CHIP_8_ROM_STORE::Hash(const uint8_t* Data, size_t Size)
+{
+	uint64_t Hash = 0xCBF29CE484222325ull;
+	for (size_t i = 0; i < Size; ++i)
+	{
+		Hash ^= Data[i];
+		Hash *= 0x100000001B3ull;
+	}
+	return Hash;
+}
+
+//The ROM holding exactly this content, made if there is none yet. Called with mLock held.
+std::shared_ptr<CHIP_8_ROM> CHIP_8_ROM_STORE::Find(const uint8_t* Data, size_t Size)
+{
+	uint64_t ContentHash = Hash(Data, Size);
+	auto Candidates = mROMs.equal_range(ContentHash);
+	for (auto Candidate = Candidates.first; Candidate != Candidates.second; ++Candidate)
+	{
+		const std::vector<uint8_t>& Stored = Candidate->second->mData;
+		if ((Stored.size() == Size) && ((Size == 0) || !memcmp(Stored.data(), Data, Size)))
+		{
+			++mContentHits;
+			return Candidate->second;
+		}
+	}
+	++mMisses;
+	mBytes += Size;
+	std::shared_ptr<CHIP_8_ROM> ROM(new CHIP_8_ROM(this, Data, Size, ContentHash));
+	mROMs.emplace(ContentHash, ROM);
+	return ROM;
+}
+
+//The ROM of a program file. A file opened before is only read again when its size or modification time changed since.
+std::shared_ptr<CHIP_8_ROM> CHIP_8_ROM_STORE::Open(const std::string& Filename)
+{
+	MAPPED_FILE File(Filename);
+	std::lock_guard<std::mutex> Guard(mLock);
+	++mOpens;
+	auto Known = mFiles.find(Filename);
+	if ((Known != mFiles.end()) && (Known->second.Size == File.GetSize()) && (Known->second.ModificationTime == File.GetModificationTime()))
+	{
+		++mFileHits;
+		return Known->second.ROM;
+	}
+
+	FILE_ENTRY Entry;
+	Entry.Size = File.GetSize();
+	Entry.ModificationTime = File.GetModificationTime();
+	Entry.ROM = Find(File.Map(), static_cast<size_t>(File.GetSize()));
+	mFiles[Filename] = Entry;
+	return Entry.ROM;
+}
+
+//The ROM of a program already in memory.
+std::shared_ptr<CHIP_8_ROM> CHIP_8_ROM_STORE::Add(const uint8_t* Data, size_t Size)
+{
+	std::lock_guard<std::mutex> Guard(mLock);
+	++mOpens;
+	return Find(Data, Size);
+}
+
+CHIP_8_ROM_STORE_STATISTICS CHIP_8_ROM_STORE::GetStatistics()
+{
+	std::lock_guard<std::mutex> Guard(mLock);
+	CHIP_8_ROM_STORE_STATISTICS Statistics;
+	Statistics.Opens = mOpens;
+	Statistics.FileHits = mFileHits;
+	Statistics.ContentHits = mContentHits;
+	Statistics.Misses = mMisses;
+	Statistics.AnalysisHits = mAnalysisHits;
+	Statistics.AnalysisMisses = mAnalysisMisses;
+	Statistics.NumberOfROMs = mROMs.size();
+	Statistics.Bytes = mBytes;
+	return Statistics;
+}
+
+//Forgets every file and ROM. ROMs still held elsewhere stay valid for as long as the store itself.
+void CHIP_8_ROM_STORE::Clear()
+{
+	std::lock_guard<std::mutex> Guard(mLock);
+	mFiles.clear();
+	mROMs.clear();
+	mBytes = 0;
+}
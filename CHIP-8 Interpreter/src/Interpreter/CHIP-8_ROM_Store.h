@@ -0,0 +1,95 @@
+#pragma once
+#include "Interpreter/CHIP-8.h"
+#include "Interpreter/CHIP-8_Analysis.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CHIP_8_ROM_STORE;
+
+//A program as the store keeps it: its bytes, their hash, and what is derived from them, made once however many times and into however many machines it is loaded.
+//The decoded instructions are made with the ROM; the analyses, one per quirk profile, when first asked for.
+class CHIP_8_ROM
+{
+	friend class CHIP_8_ROM_STORE;
+	private:
+		CHIP_8_ROM_STORE* mStore;
+		std::vector<uint8_t> mData;
+		uint64_t mHash;
+		std::unique_ptr<CHIP_8_DECODED_INSTRUCTION[]> mDecodedInstructions;
+		std::once_flag mAnalysisMade[CHIP_8_QUIRKS__NUMBER_OF_PROFILES];
+		std::unique_ptr<CHIP_8_ANALYSIS> mAnalyses[CHIP_8_QUIRKS__NUMBER_OF_PROFILES];
+		std::once_flag mQuirksFound;
+		CHIP_8_QUIRKS mQuirks;
+
+		CHIP_8_ROM(CHIP_8_ROM_STORE*, const uint8_t*, size_t, uint64_t);
+
+	public:
+		CHIP_8_ROM(const CHIP_8_ROM&) = delete;
+		CHIP_8_ROM& operator=(const CHIP_8_ROM&) = delete;
+		const uint8_t* GetData();
+		unsigned int GetSize();
+		uint64_t GetHash();
+		const CHIP_8_DECODED_INSTRUCTION* GetDecodedInstructions();
+		CHIP_8_ANALYSIS& GetAnalysis(CHIP_8_QUIRKS);
+		CHIP_8_QUIRKS GetQuirks();
+		CHIP_8_ERROR_CODE LoadInto(CHIP_8&);
+};
+
+struct CHIP_8_ROM_STORE_STATISTICS
+{
+	uint64_t Opens;
+	//Opens of a file opened before and unchanged since, which is not read again.
+	uint64_t FileHits;
+	//Opens of a file read anew whose content was already stored, under its name or another.
+	uint64_t ContentHits;
+	uint64_t Misses;
+	uint64_t AnalysisHits;
+	uint64_t AnalysisMisses;
+	uint64_t NumberOfROMs;
+	uint64_t Bytes;
+};
+
+//Keeps every program it has opened, addressed by the hash of its content, so programs loaded over and over are read, hashed and decoded once. Files are memory-mapped
+//rather than read into a buffer, and remembered by name with their size and modification time: opening one unchanged since costs a lookup, and loading it one copy
+//of its bytes and one of its decoded instructions. Identical files under different names share one ROM. Safe to use from several threads at once;
+//the ROMs it hands out must not outlive it.
+class CHIP_8_ROM_STORE
+{
+	friend class CHIP_8_ROM;
+	private:
+		struct FILE_ENTRY
+		{
+			uint64_t Size;
+			uint64_t ModificationTime;
+			std::shared_ptr<CHIP_8_ROM> ROM;
+		};
+
+		std::mutex mLock;
+		std::unordered_map<std::string, FILE_ENTRY> mFiles;
+		std::unordered_multimap<uint64_t, std::shared_ptr<CHIP_8_ROM>> mROMs;
+		uint64_t mOpens;
+		uint64_t mFileHits;
+		uint64_t mContentHits;
+		uint64_t mMisses;
+		uint64_t mBytes;
+		std::atomic<uint64_t> mAnalysisHits;
+		std::atomic<uint64_t> mAnalysisMisses;
+
+		std::shared_ptr<CHIP_8_ROM> Find(const uint8_t*, size_t);
+
+	public:
+		CHIP_8_ROM_STORE();
+		CHIP_8_ROM_STORE(const CHIP_8_ROM_STORE&) = delete;
+		CHIP_8_ROM_STORE& operator=(const CHIP_8_ROM_STORE&) = delete;
+		std::shared_ptr<CHIP_8_ROM> Open(const std::string&);
+		std::shared_ptr<CHIP_8_ROM> Add(const uint8_t*, size_t);
+		CHIP_8_ROM_STORE_STATISTICS GetStatistics();
+		void Clear();
+		static uint64_t Hash(const uint8_t*, size_t);
+};
@@ -0,0 +1,277 @@
+#include "Interpreter/CHIP-8_Rewind.h"
+
+#include <cstring>
+
+//Below this a keyframe and the deltas of a few frames after it would not fit, and every push would evict the whole history.
+static const size_t MINIMUM_BUDGET = 4 * sizeof(CHIP_8_SNAPSHOT);
+
+//Record offsets are 32 bits wide.
+static const size_t MAXIMUM_BUDGET = 0xFFFFFFFF;
+
+//Zero runs shorter than this cost more as their own run than as part of the literals around them.
+static const size_t MINIMUM_ZERO_RUN = 3;
+
+static void WriteVarint(std::vector<uint8_t>& Output, size_t Value)
+{
+	while (Value >= 0x80)
+	{
+		Output.push_back(static_cast<uint8_t>(Value | 0x80));
+		Value >>= 7;
+	}
+	Output.push_back(static_cast<uint8_t>(Value));
+}
+
+static bool ReadVarint(const std::vector<uint8_t>& Input, size_t& Position, size_t& Value)
+{
+	Value = 0;
+	for (unsigned int Shift = 0; Position < Input.size(); Shift += 7)
+	{
+		uint8_t Byte = Input[Position++];
+		Value |= static_cast<size_t>(Byte & 0x7F) << Shift;
+		if (!(Byte & 0x80))
+			return true;
+		if (Shift >= 28)
+			return false;
+	}
+	return false;
+}
+
+CHIP_8_REWIND::CHIP_8_REWIND(size_t MemoryBudget, unsigned int KeyframeInterval) : mBuffer((MemoryBudget < MINIMUM_BUDGET) ? MINIMUM_BUDGET : (MemoryBudget > MAXIMUM_BUDGET) ? MAXIMUM_BUDGET : MemoryBudget), mKeyframeInterval{ KeyframeInterval ? KeyframeInterval : 1 }, mLastSize{ 0 }
+{
+	mEncoded.reserve(2 * sizeof(CHIP_8_SNAPSHOT));
+	mDecoded.resize(sizeof(CHIP_8_SNAPSHOT));
+	Clear();
+}
+
+void CHIP_8_REWIND::Clear()
+{
+	mHead = 0;
+	mUsed = 0;
+	mRecords.clear();
+	mFramesSinceKeyframe = 0;
+}
+
+//Encodes Data XOR Reference, or Data alone when there is no reference, as alternating runs: the number of zero bytes, the number of literal bytes, then the literals.
+void CHIP_8_REWIND::Encode(const uint8_t* Data, const uint8_t* Reference, size_t Size, std::vector<uint8_t>& Output)
+{
+	Output.clear();
+	size_t Position = 0;
+	while (Position < Size)
+	{
+		size_t ZeroStart = Position;
+		while (Position + 8 <= Size)
+		{
+			uint64_t A, B = 0;
+			memcpy(&A, Data + Position, 8);
+			if (Reference)
+				memcpy(&B, Reference + Position, 8);
+			if (A != B)
+				break;
+			Position += 8;
+		}
+		while ((Position < Size) && (Data[Position] == (Reference ? Reference[Position] : 0)))
+		{
+			++Position;
+		}
+		WriteVarint(Output, Position - ZeroStart);
+		if (Position == Size)
+			break;
+
+		size_t LiteralStart = Position;
+		size_t Zeros = 0;
+		while ((Position < Size) && (Zeros < MINIMUM_ZERO_RUN))
+		{
+			if (Data[Position] == (Reference ? Reference[Position] : 0))
+				++Zeros;
+			else
+				Zeros = 0;
+			++Position;
+		}
+		Position -= Zeros;
+		WriteVarint(Output, Position - LiteralStart);
+		for (size_t i = LiteralStart; i < Position; ++i)
+		{
+			Output.push_back(Reference ? static_cast<uint8_t>(Data[i] ^ Reference[i]) : Data[i]);
+		}
+	}
+}
+
+//XORs the decoded bytes into Target, which holds Capacity bytes, and gives how many of them the input covered; a keyframe is decoded into zeros. Fails on input
+//that runs past Capacity.
+bool CHIP_8_REWIND::Decode(const std::vector<uint8_t>& Input, uint8_t* Target, size_t Capacity, size_t& Size)
+{
+	size_t Position = 0;
+	size_t Offset = 0;
+	while (Position < Input.size())
+	{
+		size_t Zeros, Literals;
+		if (!ReadVarint(Input, Position, Zeros) || (Zeros > Capacity - Offset))
+			return false;
+		Offset += Zeros;
+		if (Position == Input.size())
+			break;
+		if (!ReadVarint(Input, Position, Literals) || (Literals > Capacity - Offset) || (Literals > Input.size() - Position))
+			return false;
+		for (size_t i = 0; i < Literals; ++i)
+		{
+			Target[Offset++] ^= Input[Position++];
+		}
+	}
+	Size = Offset;
+	return true;
+}
+
+//Whether one more record of the given size, and its index entry, stay within the budget.
+bool CHIP_8_REWIND::Fits(size_t Size)
+{
+	return mUsed + Size + (mRecords.size() + 1) * sizeof(RECORD) <= mBuffer.size();
+}
+
+//Copies mEncoded to the head of the circular buffer as the newest record, evicting the oldest keyframes and their deltas until it fits.
+void CHIP_8_REWIND::Store(bool Keyframe)
+{
+	size_t Size = mEncoded.size();
+	while (!Fits(Size) && !mRecords.empty())
+	{
+		DropOldestKeyframe();
+	}
+
+	RECORD Record{ static_cast<uint32_t>(mHead), static_cast<uint32_t>(Size), Keyframe };
+	size_t First = mBuffer.size() - mHead;
+	if (First >= Size)
+	{
+		memcpy(&mBuffer[mHead], mEncoded.data(), Size);
+	}
+	else
+	{
+		memcpy(&mBuffer[mHead], mEncoded.data(), First);
+		memcpy(&mBuffer[0], mEncoded.data() + First, Size - First);
+	}
+	mHead = (mHead + Size) % mBuffer.size();
+	mUsed += Size;
+	mRecords.push_back(Record);
+}
+
+void CHIP_8_REWIND::Read(const RECORD& Record, std::vector<uint8_t>& Output)
+{
+	Output.resize(Record.Size);
+	size_t First = mBuffer.size() - Record.Offset;
+	if (First >= Record.Size)
+	{
+		memcpy(Output.data(), &mBuffer[Record.Offset], Record.Size);
+	}
+	else
+	{
+		memcpy(Output.data(), &mBuffer[Record.Offset], First);
+		memcpy(Output.data() + First, &mBuffer[0], Record.Size - First);
+	}
+}
+
+//Drops the oldest keyframe and the deltas that need it, so that the history always starts with a keyframe.
+void CHIP_8_REWIND::DropOldestKeyframe()
+{
+	do
+	{
+		mUsed -= mRecords.front().Size;
+		mRecords.pop_front();
+	} while (!mRecords.empty() && !mRecords.front().Keyframe);
+}
+
+//Decodes the nearest keyframe at or before the record and applies the deltas after it up to the record, which all cover as many bytes as the keyframe.
+bool CHIP_8_REWIND::Reconstruct(size_t Index, CHIP_8_SNAPSHOT& Snapshot)
+{
+	size_t Keyframe = Index;
+	while (!mRecords[Keyframe].Keyframe)
+	{
+		--Keyframe;
+	}
+
+	uint8_t* Target = reinterpret_cast<uint8_t*>(&Snapshot);
+	memset(Target, 0, sizeof(Snapshot));
+	size_t KeyframeSize = 0;
+	for (size_t i = Keyframe; i <= Index; ++i)
+	{
+		size_t Size;
+		Read(mRecords[i], mDecoded);
+		if (!Decode(mDecoded, Target, sizeof(Snapshot), Size) || ((i != Keyframe) && (Size != KeyframeSize)))
+			return false;
+		KeyframeSize = Size;
+	}
+	return KeyframeSize == Snapshot.GetSize();
+}
+
+//Records the current state of the machine; meant to be called once per frame.
+void CHIP_8_REWIND::Push(CHIP_8& Interpreter)
+{
+	CHIP_8_SNAPSHOT Current;
+	Interpreter.SaveSnapshot(Current);
+	size_t Size = Current.GetSize();
+
+	bool Keyframe = mRecords.empty() || (mFramesSinceKeyframe >= mKeyframeInterval) || (Size != mLastSize);
+	if (!Keyframe)
+	{
+		Encode(reinterpret_cast<const uint8_t*>(&Current), reinterpret_cast<const uint8_t*>(&mLast), Size, mEncoded);
+		while (!Fits(mEncoded.size()) && !mRecords.empty())
+		{
+			DropOldestKeyframe();
+		}
+		//The delta's keyframe itself was evicted.
+		Keyframe = mRecords.empty();
+	}
+	if (Keyframe)
+	{
+		Encode(reinterpret_cast<const uint8_t*>(&Current), nullptr, Size, mEncoded);
+		mFramesSinceKeyframe = 0;
+	}
+	Store(Keyframe);
+	++mFramesSinceKeyframe;
+	memcpy(&mLast, &Current, Size);
+	mLastSize = Size;
+}
+
+//Puts the machine back into the state recorded the given number of frames before the newest one, and forgets the frames after it. Fails when the history is not that long.
+bool CHIP_8_REWIND::Rewind(CHIP_8& Interpreter, unsigned int Frames)
+{
+	if (Frames >= mRecords.size())
+		return false;
+	size_t Index = mRecords.size() - 1 - Frames;
+	CHIP_8_SNAPSHOT Snapshot;
+	if (!Reconstruct(Index, Snapshot) || !Interpreter.RestoreSnapshot(Snapshot))
+		return false;
+
+	while (mRecords.size() > Index + 1)
+	{
+		mHead = mRecords.back().Offset;
+		mUsed -= mRecords.back().Size;
+		mRecords.pop_back();
+	}
+	mFramesSinceKeyframe = 0;
+	for (size_t i = Index + 1; i-- > 0;)
+	{
+		++mFramesSinceKeyframe;
+		if (mRecords[i].Keyframe)
+			break;
+	}
+	mLastSize = Snapshot.GetSize();
+	memcpy(&mLast, &Snapshot, mLastSize);
+	return true;
+}
+
+unsigned int CHIP_8_REWIND::GetNumberOfFrames()
+{
+	return static_cast<unsigned int>(mRecords.size());
+}
+
+//Bytes held by the records and their index, which is what the budget limits; the circular buffer itself is allocated at its full budget up front.
+size_t CHIP_8_REWIND::GetMemoryUsed()
+{
+	return mUsed + mRecords.size() * sizeof(RECORD);
+}
+
+//Memory needed per second of history at 60 frames per second, averaged over the frames held.
+double CHIP_8_REWIND::GetBytesPerSecond()
+{
+	if (mRecords.empty())
+		return 0;
+	return static_cast<double>(GetMemoryUsed()) * 60 / mRecords.size();
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Interpreter/CHIP-8.h"
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+//History of snapshots for stepping a machine back in time. Every pushed frame is stored as the XOR of its snapshot with the previous one, which is zero almost everywhere,
+//run-length compressed; every KeyframeInterval frames, whenever the history restarts and whenever the snapshot's size changes with the profile, the snapshot itself is
+//stored instead, compressed the same way. Only the GetSize bytes of a snapshot are encoded, so classic programs do not pay for the XO-CHIP's memory. Records live in
+//one circular byte buffer of fixed size, and their index counts against the same budget; when a push does not fit, the oldest keyframe and the deltas depending on it are
+//dropped, so pushing is O(1) amortized.
+class CHIP_8_REWIND
+{
+	private:
+		struct RECORD
+		{
+			//An XO-CHIP snapshot holds the whole 64 KB memory, so a record can be larger than 16 bits can count; the size shares a word with the flag to keep the index small.
+			uint32_t Offset;
+			uint32_t Size : 31;
+			uint32_t Keyframe : 1;
+		};
+
+		std::vector<uint8_t> mBuffer;
+		size_t mHead;
+		size_t mUsed;
+		std::deque<RECORD> mRecords;
+		unsigned int mKeyframeInterval;
+		unsigned int mFramesSinceKeyframe;
+		CHIP_8_SNAPSHOT mLast;
+		size_t mLastSize;
+		std::vector<uint8_t> mEncoded;
+		std::vector<uint8_t> mDecoded;
+
+		static void Encode(const uint8_t*, const uint8_t*, size_t, std::vector<uint8_t>&);
+		static bool Decode(const std::vector<uint8_t>&, uint8_t*, size_t, size_t&);
+		bool Fits(size_t);
+		void Store(bool);
+		void Read(const RECORD&, std::vector<uint8_t>&);
+		void DropOldestKeyframe();
+		bool Reconstruct(size_t, CHIP_8_SNAPSHOT&);
+
+	public:
+		static const unsigned int mDEFAULT_KEYFRAME_INTERVAL = 60;
+
+		CHIP_8_REWIND(size_t, unsigned int = mDEFAULT_KEYFRAME_INTERVAL);
+		void Clear();
+		void Push(CHIP_8&);
+		bool Rewind(CHIP_8&, unsigned int);
+		unsigned int GetNumberOfFrames();
+		size_t GetMemoryUsed();
+		double GetBytesPerSecond();
+};
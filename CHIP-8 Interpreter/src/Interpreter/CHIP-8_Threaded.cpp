@@ -0,0 +1,401 @@
+#include "Interpreter/CHIP-8.h"
+
+//Direct-threaded execution engine. The general registers, I and PC are kept in locals for the whole run and every instruction jumps straight to the next one's label.
+//Instructions with side effects outside of the registers are handed to the same Instruction_* handlers the switch engine uses, with the locals written back around the call.
+//GCC and Clang use computed goto; other compilers dispatch through a switch on the predecoded operation instead.
+//The engine is instantiated once per quirk profile and memory model, so the quirk-dependent labels are as lean as the rest and the wrapped model checks no address.
+#if defined(__GNUC__)
+#define CHIP_8_COMPUTED_GOTO true
+#else
+#define CHIP_8_COMPUTED_GOTO false
+#endif
+
+#define ADVANCE_PROGRAM_COUNTER() \
+	do \
+	{ \
+		if (Model == CHIP_8_MEMORY_MODEL__WRAPPED) \
+			PC = (PC + 2) & (MEMORY_SIZE - 1); \
+		else if (PC < (MEMORY_SIZE - 2)) \
+			PC += 2; \
+		else \
+		{ \
+			CurrentStatus = CHIP_8_ERROR_CODE__OUT_OF_BOUNDS_MEMORY_ACCESS; \
+			goto Finish; \
+		} \
+	} while (false)
+
+//Skips the next instruction, all four bytes of it when it is the XO-CHIP's F000 NNNN.
+#define SKIP_INSTRUCTION() \
+	do \
+	{ \
+		ADVANCE_PROGRAM_COUNTER(); \
+		if (CHIP_8_QUIRK_POLICY<Profile>::XO_CHIP_INSTRUCTIONS && (Memory[PC] == 0xF0) && (Memory[PC + 1] == 0x00)) \
+			ADVANCE_PROGRAM_COUNTER(); \
+	} while (false)
+
+#define SPILL_REGISTERS() \
+	for (unsigned int i = 0; i < NUMBER_OF_GENERAL_REGISTERS; ++i) \
+		Register_Vx[i] = V[i]; \
+	Register_PC = PC; \
+	Register_I = I;
+
+#define RELOAD_REGISTERS() \
+	for (unsigned int i = 0; i < NUMBER_OF_GENERAL_REGISTERS; ++i) \
+		V[i] = Register_Vx[i]; \
+	PC = Register_PC; \
+	I = Register_I;
+
+#if CHIP_8_COMPUTED_GOTO == true
+#define DISPATCH_OPERATION() goto *Labels[Decoded->Operation]
+#else
+#define DISPATCH_OPERATION() goto Dispatch
+#endif
+
+#if CHIP_8_PROFILING == true
+#define PROFILE_INSTRUCTION() ProfileInstruction(PC)
+#else
+#define PROFILE_INSTRUCTION()
+#endif
+
+#define NEXT() \
+	if (Executed == NumberOfInstructions) \
+		goto Finish; \
+	++Executed; \
+	if ((Model != CHIP_8_MEMORY_MODEL__WRAPPED) && (PC >= (MEMORY_SIZE - 1))) \
+	{ \
+		CurrentStatus = CHIP_8_ERROR_CODE__OUT_OF_BOUNDS_MEMORY_ACCESS; \
+		goto Finish; \
+	} \
+	Decoded = &DecodedInstructions[PC]; \
+	if (Decoded->Operation == CHIP_8_OPERATION__NOT_DECODED) \
+		DecodeInstructionAt(PC); \
+	PROFILE_INSTRUCTION(); \
+	DISPATCH_OPERATION()
+
+template<CHIP_8_QUIRKS Profile, CHIP_8_MEMORY_MODEL Model>
+unsigned int CHIP_8::ExecuteThreaded(unsigned int NumberOfInstructions)
+{
+	unsigned int Executed = 0;
+	if (CurrentStatus != CHIP_8_ERROR_CODE__STATUS_OK)
+		return Executed;
+
+#if CHIP_8_COMPUTED_GOTO == true
+	static const void* const Labels[CHIP_8_OPERATION__NUMBER_OF_OPERATIONS] =
+	{
+		&&Label_Handler,     /* NOT_DECODED, never dispatched*/
+		&&Label_Handler,     /* NOT_RECOGNIZED*/
+		&&Label_Handler,     /* 0nnn*/
+		&&Label_Handler,     /* 00Cn*/
+		&&Label_Handler,     /* 00Dn*/
+		&&Label_Handler,     /* 00E0*/
+		&&Label_00EE,
+		&&Label_Handler,     /* 00FB*/
+		&&Label_Handler,     /* 00FC*/
+		&&Label_Handler,     /* 00FD*/
+		&&Label_Handler,     /* 00FE*/
+		&&Label_Handler,     /* 00FF*/
+		&&Label_1nnn,
+		&&Label_2nnn,
+		&&Label_3xnn,
+		&&Label_4xnn,
+		&&Label_5xy0,
+		&&Label_Handler,     /* 5xy2*/
+		&&Label_Handler,     /* 5xy3*/
+		&&Label_6xnn,
+		&&Label_7xnn,
+		&&Label_8xy0,
+		&&Label_8xy1,
+		&&Label_8xy2,
+		&&Label_8xy3,
+		&&Label_8xy4,
+		&&Label_8xy5,
+		&&Label_8xy6,
+		&&Label_8xy7,
+		&&Label_8xyE,
+		&&Label_9xy0,
+		&&Label_Annn,
+		&&Label_Bnnn,
+		&&Label_Handler,     /* Cxnn*/
+		&&Label_Handler,     /* Dxyn*/
+		&&Label_Ex9E,
+		&&Label_ExA1,
+		&&Label_Handler,     /* F000*/
+		&&Label_Handler,     /* Fn01*/
+		&&Label_Handler,     /* F002*/
+		&&Label_Fx07,
+		&&Label_Handler,     /* Fx0A*/
+		&&Label_Fx15,
+		&&Label_Handler,     /* Fx18*/
+		&&Label_Fx1E,
+		&&Label_Fx29,
+		&&Label_Handler,     /* Fx30*/
+		&&Label_Handler,     /* Fx33*/
+		&&Label_Handler,     /* Fx3A*/
+		&&Label_Handler,     /* Fx55*/
+		&&Label_Handler,     /* Fx65*/
+		&&Label_Handler,     /* Fx75*/
+		&&Label_Handler      /* Fx85*/
+	};
+#endif
+
+	uint8_t V[NUMBER_OF_GENERAL_REGISTERS];
+	uint16_t PC;
+	uint16_t I;
+	const CHIP_8_DECODED_INSTRUCTION* Decoded;
+	RELOAD_REGISTERS();
+
+	NEXT();
+
+#if CHIP_8_COMPUTED_GOTO == false
+Dispatch:
+	switch (Decoded->Operation)
+	{
+		case CHIP_8_OPERATION__00EE__RET: goto Label_00EE;
+		case CHIP_8_OPERATION__1nnn__JP_addr: goto Label_1nnn;
+		case CHIP_8_OPERATION__2nnn__CALL_addr: goto Label_2nnn;
+		case CHIP_8_OPERATION__3xnn__SE_Vx_byte: goto Label_3xnn;
+		case CHIP_8_OPERATION__4xnn__SNE_Vx_byte: goto Label_4xnn;
+		case CHIP_8_OPERATION__5xy0__SE_Vx_Vy: goto Label_5xy0;
+		case CHIP_8_OPERATION__6xnn__LD_Vx_byte: goto Label_6xnn;
+		case CHIP_8_OPERATION__7xnn__ADD_Vx_byte: goto Label_7xnn;
+		case CHIP_8_OPERATION__8xy0__LD_Vx_Vy: goto Label_8xy0;
+		case CHIP_8_OPERATION__8xy1__OR_Vx_Vy: goto Label_8xy1;
+		case CHIP_8_OPERATION__8xy2__AND_Vx_Vy: goto Label_8xy2;
+		case CHIP_8_OPERATION__8xy3__XOR_Vx_Vy: goto Label_8xy3;
+		case CHIP_8_OPERATION__8xy4__ADD_Vx_Vy: goto Label_8xy4;
+		case CHIP_8_OPERATION__8xy5__SUB_Vx_Vy: goto Label_8xy5;
+		case CHIP_8_OPERATION__8xy6__SHR_Vx_Vy: goto Label_8xy6;
+		case CHIP_8_OPERATION__8xy7__SUBN_Vx_Vy: goto Label_8xy7;
+		case CHIP_8_OPERATION__8xyE__SHL_Vx_Vy: goto Label_8xyE;
+		case CHIP_8_OPERATION__9xy0__SNE_Vx_Vy: goto Label_9xy0;
+		case CHIP_8_OPERATION__Annn__LD_I_addr: goto Label_Annn;
+		case CHIP_8_OPERATION__Bnnn__JP_V0_addr: goto Label_Bnnn;
+		case CHIP_8_OPERATION__Ex9E__SKP_Vx: goto Label_Ex9E;
+		case CHIP_8_OPERATION__ExA1__SKNP_Vx: goto Label_ExA1;
+		case CHIP_8_OPERATION__Fx07__LD_Vx_DT: goto Label_Fx07;
+		case CHIP_8_OPERATION__Fx15__LD_DT_Vx: goto Label_Fx15;
+		case CHIP_8_OPERATION__Fx1E__ADD_I_Vx: goto Label_Fx1E;
+		case CHIP_8_OPERATION__Fx29__LD_F_Vx: goto Label_Fx29;
+		default: goto Label_Handler;
+	}
+#endif
+
+Label_Handler:
+	SPILL_REGISTERS();
+	(this->*Handlers[Decoded->Operation])(Decoded->Instruction);
+	RELOAD_REGISTERS();
+	if ((CurrentStatus != CHIP_8_ERROR_CODE__STATUS_OK) || (StopReason != CHIP_8_STOP_REASON__BUDGET_EXHAUSTED))
+		goto Finish;
+	NEXT();
+
+Label_00EE:
+	if (Register_SP > 0)
+	{
+		--Register_SP;
+		PC = Stack[Register_SP];
+	}
+	else
+		CurrentStatus = CHIP_8_ERROR_CODE__STACK_UNDERFLOW;
+	ADVANCE_PROGRAM_COUNTER();
+	if (CurrentStatus != CHIP_8_ERROR_CODE__STATUS_OK)
+		goto Finish;
+	NEXT();
+
+Label_1nnn:
+	if ((Decoded->nnn <= PC) && (static_cast<unsigned int>(PC - Decoded->nnn) < (2 * MAX_IDLE_LOOP_LENGTH)))
+	{
+		CheckIdleLoop(V, Decoded->nnn, PC);
+		PC = Decoded->nnn;
+		if (StopReason != CHIP_8_STOP_REASON__BUDGET_EXHAUSTED)
+			goto Finish;
+		NEXT();
+	}
+	PC = Decoded->nnn;
+	NEXT();
+
+Label_2nnn:
+	if (Register_SP < STACK_SIZE)
+	{
+		Stack[Register_SP] = PC;
+		++Register_SP;
+		PC = Decoded->nnn;
+	}
+	else
+	{
+		CurrentStatus = CHIP_8_ERROR_CODE__STACK_OVERFLOW;
+		PC = Decoded->nnn;
+		goto Finish;
+	}
+	NEXT();
+
+Label_3xnn:
+	if (V[Decoded->x] == Decoded->nn)
+		SKIP_INSTRUCTION();
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_4xnn:
+	if (V[Decoded->x] != Decoded->nn)
+		SKIP_INSTRUCTION();
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_5xy0:
+	if (V[Decoded->x] == V[Decoded->y])
+		SKIP_INSTRUCTION();
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_6xnn:
+	V[Decoded->x] = Decoded->nn;
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_7xnn:
+	V[Decoded->x] += Decoded->nn;
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_8xy0:
+	V[Decoded->x] = V[Decoded->y];
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_8xy1:
+	V[Decoded->x] |= V[Decoded->y];
+	if (CHIP_8_QUIRK_POLICY<Profile>::LOGIC_RESETS_VF)
+		V[0xF] = 0;
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_8xy2:
+	V[Decoded->x] &= V[Decoded->y];
+	if (CHIP_8_QUIRK_POLICY<Profile>::LOGIC_RESETS_VF)
+		V[0xF] = 0;
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_8xy3:
+	V[Decoded->x] ^= V[Decoded->y];
+	if (CHIP_8_QUIRK_POLICY<Profile>::LOGIC_RESETS_VF)
+		V[0xF] = 0;
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_8xy4:
+	{
+		unsigned int Result = V[Decoded->x] + V[Decoded->y];
+		V[Decoded->x] = Result;
+		V[0xF] = (Result > 0xFF) ? 1 : 0;
+	}
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_8xy5:
+	{
+		unsigned int Flag = (V[Decoded->y] > V[Decoded->x]) ? 0 : 1;
+		V[Decoded->x] -= V[Decoded->y];
+		V[0xF] = Flag;
+	}
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_8xy6:
+	{
+		uint8_t Source = V[CHIP_8_QUIRK_POLICY<Profile>::SHIFT_READS_VX ? Decoded->x : Decoded->y];
+		unsigned int Flag = Source & 0b00000001;
+		V[Decoded->x] = Source >> 1;
+		V[0xF] = Flag;
+	}
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_8xy7:
+	{
+		unsigned int Flag = (V[Decoded->x] > V[Decoded->y]) ? 0 : 1;
+		V[Decoded->x] = V[Decoded->y] - V[Decoded->x];
+		V[0xF] = Flag;
+	}
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_8xyE:
+	{
+		uint8_t Source = V[CHIP_8_QUIRK_POLICY<Profile>::SHIFT_READS_VX ? Decoded->x : Decoded->y];
+		unsigned int Flag = (Source & 0b10000000) ? 1 : 0;
+		V[Decoded->x] = Source << 1;
+		V[0xF] = Flag;
+	}
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_9xy0:
+	if (V[Decoded->x] != V[Decoded->y])
+		SKIP_INSTRUCTION();
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_Annn:
+	I = Decoded->nnn;
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_Bnnn:
+	PC = Decoded->nnn + V[CHIP_8_QUIRK_POLICY<Profile>::JUMP_ADDS_VX ? Decoded->x : 0x0];
+	if (Model == CHIP_8_MEMORY_MODEL__WRAPPED)
+		PC &= MEMORY_SIZE - 1;
+	NEXT();
+
+Label_Ex9E:
+	if (Keypad[V[Decoded->x] & 0xF])
+		SKIP_INSTRUCTION();
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_ExA1:
+	if (!Keypad[V[Decoded->x] & 0xF])
+		SKIP_INSTRUCTION();
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_Fx07:
+	V[Decoded->x] = Timer_DT;
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_Fx15:
+	Timer_DT = V[Decoded->x];
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_Fx1E:
+	I += V[Decoded->x];
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Label_Fx29:
+	if (V[Decoded->x] < NUMBER_OF_FONT_SPRITES)
+		I = FONT_AREA_START_ADDRESS + (SIZE_OF_FONT_SPRITES * V[Decoded->x]);
+	ADVANCE_PROGRAM_COUNTER();
+	NEXT();
+
+Finish:
+	SPILL_REGISTERS();
+	return Executed;
+}
+
+const CHIP_8::ENGINE_FUNCTION CHIP_8::ThreadedEngines[CHIP_8_MEMORY_MODEL__NUMBER_OF_MODELS][CHIP_8_QUIRKS__NUMBER_OF_PROFILES] =
+{
+	{
+		&CHIP_8::ExecuteThreaded<CHIP_8_QUIRKS__DEFAULT, CHIP_8_MEMORY_MODEL__STRICT>,
+		&CHIP_8::ExecuteThreaded<CHIP_8_QUIRKS__COSMAC_VIP, CHIP_8_MEMORY_MODEL__STRICT>,
+		&CHIP_8::ExecuteThreaded<CHIP_8_QUIRKS__SUPER_CHIP, CHIP_8_MEMORY_MODEL__STRICT>,
+		&CHIP_8::ExecuteThreaded<CHIP_8_QUIRKS__XO_CHIP, CHIP_8_MEMORY_MODEL__STRICT>
+	},
+	{
+		&CHIP_8::ExecuteThreaded<CHIP_8_QUIRKS__DEFAULT, CHIP_8_MEMORY_MODEL__WRAPPED>,
+		&CHIP_8::ExecuteThreaded<CHIP_8_QUIRKS__COSMAC_VIP, CHIP_8_MEMORY_MODEL__WRAPPED>,
+		&CHIP_8::ExecuteThreaded<CHIP_8_QUIRKS__SUPER_CHIP, CHIP_8_MEMORY_MODEL__WRAPPED>,
+		&CHIP_8::ExecuteThreaded<CHIP_8_QUIRKS__XO_CHIP, CHIP_8_MEMORY_MODEL__WRAPPED>
+	}
+};
@@ -0,0 +1,283 @@
+#include "Interpreter/CHIP-8_Trace.h"
+
+#include <stdexcept>
+
+//Multi-byte fields are little-endian, the instruction included.
+static inline uint8_t* PutWord(uint8_t* Position, uint16_t Value)
+{
+	Position[0] = static_cast<uint8_t>(Value);
+	Position[1] = static_cast<uint8_t>(Value >> 8);
+	return Position + 2;
+}
+
+static inline uint8_t* PutLong(uint8_t* Position, uint32_t Value)
+{
+	Position = PutWord(Position, static_cast<uint16_t>(Value));
+	return PutWord(Position, static_cast<uint16_t>(Value >> 16));
+}
+
+CHIP_8_TRACE::CHIP_8_TRACE(const std::string& Filename) : mFile(Filename, std::ios::binary), mNextAddress{ 0xFFFF }, mInstructions{ 0 }, mBytes{ 0 }, mNumberOfBlocks{ 1 }, mPendingBlocks{ 0 }, mStopping{ false }, mFailed{ false }
+{
+	if (!mFile)
+		throw(std::runtime_error("Could not open trace file \"" + Filename + "\"."));
+	uint8_t Header[8];
+	PutLong(PutLong(Header, mMAGIC), mVERSION);
+	mFile.write(reinterpret_cast<const char*>(Header), sizeof(Header));
+	mBytes = sizeof(Header);
+
+	mCurrent.Data.reset(new uint8_t[mBLOCK_SIZE]);
+	mCurrent.Size = 0;
+	mPosition = mCurrent.Data.get();
+	mEnd = mPosition + mBLOCK_SIZE;
+	mWriter = std::thread(&CHIP_8_TRACE::Write, this);
+}
+
+CHIP_8_TRACE::~CHIP_8_TRACE()
+{
+	Ship();
+	{
+		std::lock_guard<std::mutex> Guard(mLock);
+		mStopping = true;
+	}
+	mBlockReady.notify_one();
+	mWriter.join();
+}
+
+//Hands the current block to the writer and carries on in a free one.
+void CHIP_8_TRACE::Ship()
+{
+	mCurrent.Size = mPosition - mCurrent.Data.get();
+	if (mCurrent.Size == 0)
+		return;
+	std::unique_lock<std::mutex> Lock(mLock);
+	mFullBlocks.push_back(std::move(mCurrent));
+	++mPendingBlocks;
+	mBlockReady.notify_one();
+	if (mFreeBlocks.empty() && (mNumberOfBlocks < mMAXIMUM_BLOCKS))
+	{
+		mCurrent.Data.reset(new uint8_t[mBLOCK_SIZE]);
+		++mNumberOfBlocks;
+	}
+	else
+	{
+		mBlockWritten.wait(Lock, [this] { return !mFreeBlocks.empty(); });
+		mCurrent = std::move(mFreeBlocks.front());
+		mFreeBlocks.pop_front();
+	}
+	mCurrent.Size = 0;
+	mPosition = mCurrent.Data.get();
+	mEnd = mPosition + mBLOCK_SIZE;
+}
+
+//Body of the writer thread: writes full blocks in order until the trace is destroyed. After a failed write the blocks are only recycled.
+void CHIP_8_TRACE::Write()
+{
+	std::unique_lock<std::mutex> Lock(mLock);
+	for (;;)
+	{
+		mBlockReady.wait(Lock, [this] { return !mFullBlocks.empty() || mStopping; });
+		if (mFullBlocks.empty())
+			break;
+		BLOCK Block = std::move(mFullBlocks.front());
+		mFullBlocks.pop_front();
+		bool Failed = mFailed;
+		Lock.unlock();
+		if (!Failed)
+		{
+			mFile.write(reinterpret_cast<const char*>(Block.Data.get()), Block.Size);
+			Failed = !mFile;
+		}
+		Lock.lock();
+		mFailed = Failed;
+		mBytes += Block.Size;
+		mFreeBlocks.push_back(std::move(Block));
+		--mPendingBlocks;
+		mBlockWritten.notify_all();
+	}
+	mFile.flush();
+}
+
+//Records one executed instruction. ChangedRegisters has bit x set for every Vx that changed, whose new value is Registers[x]; WriteLength bytes from Written were
+//stored from WriteAddress on, going on at the start of memory past its end. The record is built through a local pointer, as stores through a byte pointer could otherwise change mPosition for all the compiler knows.
+void CHIP_8_TRACE::RecordInstruction(uint16_t Address, uint16_t Instruction, uint16_t ChangedRegisters, const uint8_t* Registers, bool IChanged, uint16_t Register_I, uint16_t WriteAddress, unsigned int WriteLength, const uint8_t* Written)
+{
+	if (static_cast<size_t>(mEnd - mPosition) < mMAXIMUM_RECORD_SIZE)
+		Ship();
+
+	uint8_t* Position = mPosition + 1;
+	uint8_t Flags = 0;
+	if (Address != mNextAddress)
+	{
+		Flags |= mFLAG_ADDRESS;
+		Position = PutWord(Position, Address);
+	}
+	Position = PutWord(Position, Instruction);
+	if (ChangedRegisters)
+	{
+		Flags |= mFLAG_REGISTERS;
+		Position = PutWord(Position, ChangedRegisters);
+		unsigned int i = 0;
+		for (unsigned int Mask = ChangedRegisters; Mask; Mask >>= 1, ++i)
+		{
+			if (Mask & 1)
+				*Position++ = Registers[i];
+		}
+	}
+	if (IChanged)
+	{
+		Flags |= mFLAG_I;
+		Position = PutWord(Position, Register_I);
+	}
+	if (WriteLength)
+	{
+		Flags |= mFLAG_MEMORY;
+		Position = PutWord(Position, WriteAddress);
+		*Position++ = static_cast<uint8_t>(WriteLength);
+		for (unsigned int i = 0; i < WriteLength; ++i)
+		{
+			*Position++ = Written[i];
+		}
+	}
+	*mPosition = Flags;
+	mPosition = Position;
+	mNextAddress = Address + 2;
+	++mInstructions;
+}
+
+void CHIP_8_TRACE::RecordTimers(unsigned int NumberOf60thOfSecond)
+{
+	if (static_cast<size_t>(mEnd - mPosition) < mMAXIMUM_RECORD_SIZE)
+		Ship();
+	*mPosition++ = mMARKER_TIMERS;
+	mPosition = PutLong(mPosition, NumberOf60thOfSecond);
+}
+
+void CHIP_8_TRACE::RecordIdleLoop(unsigned int SkippedInstructions)
+{
+	if (static_cast<size_t>(mEnd - mPosition) < mMAXIMUM_RECORD_SIZE)
+		Ship();
+	*mPosition++ = mMARKER_IDLE_LOOP;
+	mPosition = PutLong(mPosition, SkippedInstructions);
+}
+
+//Waits until everything recorded so far is in the file. Throws when the file could not be written.
+void CHIP_8_TRACE::Flush()
+{
+	Ship();
+	std::unique_lock<std::mutex> Lock(mLock);
+	mBlockWritten.wait(Lock, [this] { return mPendingBlocks == 0; });
+	if (!mFailed)
+		mFailed = !mFile.flush();
+	if (mFailed)
+		throw(std::runtime_error("Could not write the trace file."));
+}
+
+uint64_t CHIP_8_TRACE::GetNumberOfInstructions()
+{
+	return mInstructions;
+}
+
+//Bytes in the file, the header included; records still in memory are not counted until Flush.
+uint64_t CHIP_8_TRACE::GetBytesWritten()
+{
+	std::lock_guard<std::mutex> Guard(mLock);
+	return mBytes;
+}
+
+CHIP_8_TRACE_READER::CHIP_8_TRACE_READER(const std::string& Filename) : mFile(Filename, std::ios::binary), mNextAddress{ 0xFFFF }, mTruncated{ false }
+{
+	if (!mFile)
+		throw(std::runtime_error("Could not open trace file \"" + Filename + "\"."));
+	uint16_t Words[4];
+	for (uint16_t& Word : Words)
+	{
+		if (!ReadWord(Word))
+			throw(std::runtime_error("\"" + Filename + "\" is not a trace."));
+	}
+	if ((Words[0] | (static_cast<uint32_t>(Words[1]) << 16)) != CHIP_8_TRACE::mMAGIC)
+		throw(std::runtime_error("\"" + Filename + "\" is not a trace."));
+	if ((Words[2] | (static_cast<uint32_t>(Words[3]) << 16)) != CHIP_8_TRACE::mVERSION)
+		throw(std::runtime_error("\"" + Filename + "\" is a trace of another version."));
+}
+
+bool CHIP_8_TRACE_READER::ReadByte(uint8_t& Value)
+{
+	int Character = mFile.get();
+	if (Character == std::char_traits<char>::eof())
+		return false;
+	Value = static_cast<uint8_t>(Character);
+	return true;
+}
+
+bool CHIP_8_TRACE_READER::ReadWord(uint16_t& Value)
+{
+	uint8_t Low, High;
+	if (!ReadByte(Low) || !ReadByte(High))
+		return false;
+	Value = static_cast<uint16_t>(Low | (High << 8));
+	return true;
+}
+
+//Reads the next record; false at the end of the trace, or at a record that was cut short, which IsTruncated tells apart. Throws on a record no trace can hold.
+bool CHIP_8_TRACE_READER::Next(CHIP_8_TRACE_RECORD& Record)
+{
+	uint8_t Flags;
+	if (!ReadByte(Flags))
+		return false;
+	mTruncated = true;
+
+	if ((Flags == CHIP_8_TRACE::mMARKER_TIMERS) || (Flags == CHIP_8_TRACE::mMARKER_IDLE_LOOP))
+	{
+		uint16_t Low, High;
+		if (!ReadWord(Low) || !ReadWord(High))
+			return false;
+		Record.Kind = (Flags == CHIP_8_TRACE::mMARKER_TIMERS) ? CHIP_8_TRACE_RECORD_KIND__TIMERS : CHIP_8_TRACE_RECORD_KIND__IDLE_LOOP;
+		Record.Count = Low | (static_cast<uint32_t>(High) << 16);
+		mTruncated = false;
+		return true;
+	}
+	if (Flags & ~(CHIP_8_TRACE::mFLAG_ADDRESS | CHIP_8_TRACE::mFLAG_REGISTERS | CHIP_8_TRACE::mFLAG_I | CHIP_8_TRACE::mFLAG_MEMORY))
+		throw(std::runtime_error("The trace holds a record of unknown kind."));
+
+	Record.Kind = CHIP_8_TRACE_RECORD_KIND__INSTRUCTION;
+	Record.Address = mNextAddress;
+	if ((Flags & CHIP_8_TRACE::mFLAG_ADDRESS) && !ReadWord(Record.Address))
+		return false;
+	if (!ReadWord(Record.Instruction))
+		return false;
+	Record.ChangedRegisters = 0;
+	if (Flags & CHIP_8_TRACE::mFLAG_REGISTERS)
+	{
+		if (!ReadWord(Record.ChangedRegisters))
+			return false;
+		for (unsigned int i = 0; i < 16; ++i)
+		{
+			if ((Record.ChangedRegisters & (1 << i)) && !ReadByte(Record.Registers[i]))
+				return false;
+		}
+	}
+	Record.IChanged = (Flags & CHIP_8_TRACE::mFLAG_I) != 0;
+	if (Record.IChanged && !ReadWord(Record.Register_I))
+		return false;
+	Record.WriteLength = 0;
+	if (Flags & CHIP_8_TRACE::mFLAG_MEMORY)
+	{
+		if (!ReadWord(Record.WriteAddress) || !ReadByte(Record.WriteLength))
+			return false;
+		if (Record.WriteLength > sizeof(Record.Written))
+			throw(std::runtime_error("The trace holds a memory write longer than any instruction makes."));
+		for (unsigned int i = 0; i < Record.WriteLength; ++i)
+		{
+			if (!ReadByte(Record.Written[i]))
+				return false;
+		}
+	}
+	mNextAddress = Record.Address + 2;
+	mTruncated = false;
+	return true;
+}
+
+bool CHIP_8_TRACE_READER::IsTruncated()
+{
+	return mTruncated;
+}
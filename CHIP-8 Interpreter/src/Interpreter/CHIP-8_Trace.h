@@ -0,0 +1,107 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+enum CHIP_8_TRACE_RECORD_KIND { CHIP_8_TRACE_RECORD_KIND__INSTRUCTION, CHIP_8_TRACE_RECORD_KIND__TIMERS, CHIP_8_TRACE_RECORD_KIND__IDLE_LOOP };
+
+//One decoded record of a trace. An instruction carries the registers it changed, at their own index, I when it changed it, and the bytes it wrote to memory;
+//the other kinds only carry Count, the 60ths of a second the timers were counted down by or the instructions of idle loop passes that were skipped.
+struct CHIP_8_TRACE_RECORD
+{
+	CHIP_8_TRACE_RECORD_KIND Kind;
+	uint16_t Address;
+	uint16_t Instruction;
+	uint16_t ChangedRegisters;
+	uint8_t Registers[16];
+	bool IChanged;
+	uint16_t Register_I;
+	uint16_t WriteAddress;
+	uint8_t WriteLength;
+	uint8_t Written[16];
+	uint32_t Count;
+};
+
+//Writes every instruction a machine executes to a file, as compact variable-length records: a flags byte, the address only when it does not follow the previous
+//instruction, the instruction, and only what it changed. Records are appended to a large block in memory, and full blocks are written out by a thread of their own,
+//so recording costs the machine a few stores per instruction. Blocks are only allocated while the disk falls behind, up to mMAXIMUM_BLOCKS, after which recording waits.
+class CHIP_8_TRACE
+{
+	private:
+		struct BLOCK
+		{
+			std::unique_ptr<uint8_t[]> Data;
+			size_t Size;
+		};
+
+		static const size_t mBLOCK_SIZE = 1 << 20;
+		static const unsigned int mMAXIMUM_BLOCKS = 8;
+		//Flags, address, instruction, register mask and 16 registers, I, write address and length, and 16 written bytes.
+		static const size_t mMAXIMUM_RECORD_SIZE = 44;
+
+		std::ofstream mFile;
+		BLOCK mCurrent;
+		uint8_t* mPosition;
+		uint8_t* mEnd;
+		uint16_t mNextAddress;
+		uint64_t mInstructions;
+		uint64_t mBytes;
+
+		std::thread mWriter;
+		std::mutex mLock;
+		std::condition_variable mBlockReady;
+		std::condition_variable mBlockWritten;
+		std::deque<BLOCK> mFullBlocks;
+		std::deque<BLOCK> mFreeBlocks;
+		unsigned int mNumberOfBlocks;
+		unsigned int mPendingBlocks;
+		bool mStopping;
+		bool mFailed;
+
+		void Ship();
+		void Write();
+
+	public:
+		static const uint32_t mMAGIC = 0x52543843;	//"C8TR"
+		static const uint32_t mVERSION = 1;
+		static const uint8_t mFLAG_ADDRESS = 0x01;
+		static const uint8_t mFLAG_REGISTERS = 0x02;
+		static const uint8_t mFLAG_I = 0x04;
+		static const uint8_t mFLAG_MEMORY = 0x08;
+		static const uint8_t mMARKER_TIMERS = 0x80;
+		static const uint8_t mMARKER_IDLE_LOOP = 0x81;
+
+		CHIP_8_TRACE(const std::string&);
+		CHIP_8_TRACE(const CHIP_8_TRACE&) = delete;
+		CHIP_8_TRACE& operator=(const CHIP_8_TRACE&) = delete;
+		~CHIP_8_TRACE();
+		void RecordInstruction(uint16_t, uint16_t, uint16_t, const uint8_t*, bool, uint16_t, uint16_t, unsigned int, const uint8_t*);
+		void RecordTimers(unsigned int);
+		void RecordIdleLoop(unsigned int);
+		void Flush();
+		uint64_t GetNumberOfInstructions();
+		uint64_t GetBytesWritten();
+};
+
+//Reads back the records of a trace. A trace cut short, as when the process writing it died, reads up to its last whole record.
+class CHIP_8_TRACE_READER
+{
+	private:
+		std::ifstream mFile;
+		uint16_t mNextAddress;
+		bool mTruncated;
+
+		bool ReadByte(uint8_t&);
+		bool ReadWord(uint16_t&);
+
+	public:
+		CHIP_8_TRACE_READER(const std::string&);
+		bool Next(CHIP_8_TRACE_RECORD&);
+		bool IsTruncated();
+};
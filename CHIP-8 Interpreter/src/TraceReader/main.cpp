@@ -0,0 +1,200 @@
+#include "Interpreter/CHIP-8.h"
+#include "Interpreter/CHIP-8_Trace.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+const char* Usage =
+	"Usage: CHIP-8_Trace <trace> [options]\n"
+	"  --from ADDRESS      show only instructions at ADDRESS or above, in hexadecimal\n"
+	"  --to ADDRESS        show only instructions at ADDRESS or below, in hexadecimal\n"
+	"  --instruction TEXT  show only instructions matching TEXT, four characters of which hexadecimal digits must match and any other matches anything, as in Fx55\n"
+	"  --check-memory FILE instead of showing the trace, check that the last byte it wrote to every address is what the memory of FILE holds, a snapshot\n"
+	"                      saved with --save-state at the end of the traced run\n"
+	"Every instruction is shown with its number in the trace, the frame it ran in, its address, what it is and what it changed. Timer and idle loop records\n"
+	"are shown too when nothing is filtered out.\n";
+
+//Whether the instruction matches a pattern like "Fx55" or "D01F".
+static bool MatchesPattern(uint16_t Instruction, const std::string& Pattern)
+{
+	for (unsigned int i = 0; i < 4; ++i)
+	{
+		char Character = Pattern[i];
+		unsigned int Digit = (Instruction >> (12 - (4 * i))) & 0xF;
+		if ((Character >= '0') && (Character <= '9') && (Digit != static_cast<unsigned int>(Character - '0')))
+			return false;
+		if ((Character >= 'A') && (Character <= 'F') && (Digit != static_cast<unsigned int>(Character - 'A' + 10)))
+			return false;
+	}
+	return true;
+}
+
+//Compares the last byte the trace wrote to every address with the memory of the snapshot, and returns how many differ. Only Fx33, Fx55 and 5xy2 write memory and
+//the trace records all of them, so they all have to match when the snapshot was taken at the end of the traced run.
+static unsigned int CheckMemory(CHIP_8_TRACE_READER& Reader, const std::string& SnapshotFilename)
+{
+	std::ifstream File(SnapshotFilename, std::ios::binary);
+	if (!File)
+		throw(std::runtime_error("Could not open snapshot file \"" + SnapshotFilename + "\"."));
+	//Memory the snapshot's profile does not have is left out of the file, and reads as zero.
+	CHIP_8_SNAPSHOT Snapshot{};
+	CHIP_8 Machine;
+	File.read(reinterpret_cast<char*>(&Snapshot), sizeof(Snapshot));
+	size_t Size = static_cast<size_t>(File.gcount());
+	if ((Size < offsetof(CHIP_8_SNAPSHOT, Memory)) || (Size != Snapshot.GetSize()) || !Machine.RestoreSnapshot(Snapshot))
+		throw(std::runtime_error("\"" + SnapshotFilename + "\" is not a snapshot this version can restore."));
+	unsigned int MemoryMask = Machine.GetMemorySize() - 1;
+
+	//The last byte written to every address, or -1 for addresses never written.
+	std::vector<int> Written(sizeof(Snapshot.Memory), -1);
+	CHIP_8_TRACE_RECORD Record;
+	uint64_t Writes = 0;
+	while (Reader.Next(Record))
+	{
+		if (Record.Kind != CHIP_8_TRACE_RECORD_KIND__INSTRUCTION)
+			continue;
+		for (unsigned int i = 0; i < Record.WriteLength; ++i)
+		{
+			Written[(Record.WriteAddress + i) & MemoryMask] = Record.Written[i];
+		}
+		Writes += (Record.WriteLength != 0);
+	}
+
+	unsigned int Addresses = 0;
+	unsigned int Differing = 0;
+	char Text[64];
+	for (unsigned int Address = 0; Address <= MemoryMask; ++Address)
+	{
+		if (Written[Address] < 0)
+			continue;
+		++Addresses;
+		if (Written[Address] != Snapshot.Memory[Address])
+		{
+			++Differing;
+			snprintf(Text, sizeof(Text), "[%03X] traced %02X, memory holds %02X", Address, Written[Address], Snapshot.Memory[Address]);
+			std::cout << Text << "\n";
+		}
+	}
+	std::cout << Writes << " writes to " << Addresses << " addresses, " << Differing << " differing from memory\n";
+	return Differing;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string Filename;
+	std::string SnapshotFilename;
+	std::string Pattern;
+	unsigned long From = 0;
+	unsigned long To = 0xFFFF;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* Argument = argv[i];
+		bool HasValue = (i + 1) < argc;
+		if (!strcmp(Argument, "--from") && HasValue)
+			From = strtoul(argv[++i], nullptr, 16);
+		else if (!strcmp(Argument, "--to") && HasValue)
+			To = strtoul(argv[++i], nullptr, 16);
+		else if (!strcmp(Argument, "--instruction") && HasValue)
+		{
+			Pattern = argv[++i];
+			if (Pattern.size() != 4)
+			{
+				std::cerr << "An instruction pattern has four characters.\n" << Usage;
+				return 1;
+			}
+		}
+		else if (!strcmp(Argument, "--check-memory") && HasValue)
+			SnapshotFilename = argv[++i];
+		else if ((Argument[0] != '-') && Filename.empty())
+			Filename = Argument;
+		else
+		{
+			std::cerr << Usage;
+			return 1;
+		}
+	}
+	if (Filename.empty())
+	{
+		std::cerr << Usage;
+		return 1;
+	}
+	bool Filtered = (From != 0) || (To != 0xFFFF) || !Pattern.empty();
+
+	try
+	{
+		CHIP_8_TRACE_READER Reader(Filename);
+		if (!SnapshotFilename.empty())
+		{
+			unsigned int Differing = CheckMemory(Reader, SnapshotFilename);
+			if (Reader.IsTruncated())
+				std::cerr << "The trace ends in the middle of a record.\n";
+			return (Differing == 0) ? 0 : 2;
+		}
+		CHIP_8_TRACE_RECORD Record;
+		uint64_t Instructions = 0;
+		uint64_t Frame = 0;
+		char Text[64];
+		while (Reader.Next(Record))
+		{
+			if (Record.Kind == CHIP_8_TRACE_RECORD_KIND__TIMERS)
+			{
+				Frame += Record.Count;
+				if (!Filtered)
+					std::cout << "timers -" << Record.Count << "\n";
+				continue;
+			}
+			if (Record.Kind == CHIP_8_TRACE_RECORD_KIND__IDLE_LOOP)
+			{
+				if (!Filtered)
+					std::cout << "idle loop +" << Record.Count << " instructions\n";
+				continue;
+			}
+
+			++Instructions;
+			if ((Record.Address < From) || (Record.Address > To) || (!Pattern.empty() && !MatchesPattern(Record.Instruction, Pattern)))
+				continue;
+			snprintf(Text, sizeof(Text), "%llu %llu %03X %04X ", static_cast<unsigned long long>(Instructions), static_cast<unsigned long long>(Frame), Record.Address, Record.Instruction);
+			std::cout << Text << CHIP_8::GetOperationName(CHIP_8::DecodeInstruction(Record.Instruction));
+			for (unsigned int i = 0; i < 16; ++i)
+			{
+				if (Record.ChangedRegisters & (1 << i))
+				{
+					snprintf(Text, sizeof(Text), " V%X=%02X", i, Record.Registers[i]);
+					std::cout << Text;
+				}
+			}
+			if (Record.IChanged)
+			{
+				snprintf(Text, sizeof(Text), " I=%03X", Record.Register_I);
+				std::cout << Text;
+			}
+			if (Record.WriteLength)
+			{
+				snprintf(Text, sizeof(Text), " [%03X]=", Record.WriteAddress);
+				std::cout << Text;
+				for (unsigned int i = 0; i < Record.WriteLength; ++i)
+				{
+					snprintf(Text, sizeof(Text), "%02X", Record.Written[i]);
+					std::cout << Text;
+				}
+			}
+			std::cout << "\n";
+		}
+		if (Reader.IsTruncated())
+			std::cerr << "The trace ends in the middle of a record.\n";
+	}
+	catch (const std::exception& Error)
+	{
+		std::cerr << Error.what() << "\n";
+		return 1;
+	}
+	return 0;
+}